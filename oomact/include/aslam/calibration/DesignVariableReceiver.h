@@ -11,12 +11,18 @@ class DesignVariableReceiver {
  public:
   virtual ~DesignVariableReceiver(){}
   virtual void addDesignVariable(backend::DesignVariable * dv) = 0;
+  /// Add a design variable associated with a time (in the spline's time unit). The time may be used to order the design variables.
+  virtual void addTimedDesignVariable(backend::DesignVariable * dv, double /*time*/) { addDesignVariable(dv); }
 
   template <typename Spline> void addSplineDesignVariables(Spline & spline, bool active){
     const size_t numDV = spline.numDesignVariables();
+    const size_t order = spline.getSplineOrder();
+    const auto knots = spline.getKnotsVector();
     for (size_t i = 0; i < numDV; ++i) {
       spline.designVariable(i)->setActive(active);
-      addDesignVariable(spline.designVariable(i));
+      // The center of the i-th coefficient's support [knots[i], knots[i + order]]. This also holds for non-uniform knots.
+      const double time = i + order < knots.size() ? 0.5 * (static_cast<double>(knots[i]) + static_cast<double>(knots[i + order])) : static_cast<double>(spline.getMaxTime());
+      addTimedDesignVariable(spline.designVariable(i), time);
     }
   }
 };
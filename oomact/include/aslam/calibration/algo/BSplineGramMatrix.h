@@ -0,0 +1,47 @@
+#ifndef H2A6E8E57_B33F_4C6B_99A7_34B1AEDE3854
+#define H2A6E8E57_B33F_4C6B_99A7_34B1AEDE3854
+
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * The basis matrix M of the uniform B-spline of the given order on one segment:
+ * The i-th of the order basis functions being nonzero on the segment is b_i(u) = sum_p M(p, i) u^p, with the segment's normalized time u in [0, 1].
+ */
+Eigen::MatrixXd computeUniformBSplineBasisMatrix(int order);
+
+/**
+ * All derivatives of the B-spline basis functions being nonzero on the knot span [knots[span], knots[span + 1]), at t = knots[span].
+ * D(k, r) is the k-th derivative of the basis function span - order + 1 + r (k, r < order). The knots may be non-uniform.
+ * A spline is a polynomial on every span. Hence, sum_k D(k, r) / k! (t - knots[span])^k is the basis function r on the whole span.
+ */
+Eigen::MatrixXd computeBSplineBasisDerivativesAtSpanStart(const std::vector<double> & knots, int order, int span);
+
+/**
+ * The Gram matrix G(i, j) = integral_0^1 b_i^(derivative)(u) b_j^(derivative)(u) du of the basis functions of one segment.
+ * For a uniform spline f with segment duration h and the coefficients c_0, ..., c_{order - 1} affecting a segment, it holds:
+ * integral over the segment of |f^(derivative)(t)|^2 dt = h^(1 - 2 * derivative) * sum_ij G(i, j) c_i^T c_j.
+ */
+Eigen::MatrixXd computeUniformBSplineGramMatrix(int order, int derivative);
+
+/**
+ * A square root U of computeUniformBSplineGramMatrix(order, derivative), i.e. U^T U = G.
+ * G has rank order - derivative. Therefore U has only order - derivative rows.
+ */
+Eigen::MatrixXd computeUniformBSplineGramMatrixSqrt(int order, int derivative);
+
+/**
+ * Fit the control vertices of a spline with the given (possibly non-uniform) knots to points by least squares. Column i of points belongs to times[i].
+ * lambda weights the integral of the squared second derivative, which also determines the control vertices of spans without any points.
+ * knots has numControlVertices + order entries and the spline is valid on [knots[order - 1], knots[numControlVertices]]. Column i of the result is control vertex i.
+ */
+Eigen::MatrixXd fitBSplineControlVertices(const std::vector<double> & knots, int order, const std::vector<double> & times, const Eigen::MatrixXd & points, double lambda);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H2A6E8E57_B33F_4C6B_99A7_34B1AEDE3854 */
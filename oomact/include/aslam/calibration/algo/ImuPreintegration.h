@@ -0,0 +1,81 @@
+#ifndef H9962EC70_582F_4433_BE28_D931AA9FD8D0
+#define H9962EC70_582F_4433_BE28_D931AA9FD8D0
+
+#include <Eigen/Core>
+
+namespace aslam {
+namespace calibration {
+
+Eigen::Matrix3d expSO3(const Eigen::Vector3d & phi);
+Eigen::Vector3d logSO3(const Eigen::Matrix3d & R);
+/// The right Jacobian of SO(3): Exp(phi + d) ~= Exp(phi) * Exp(rightJacobianSO3(phi) * d).
+Eigen::Matrix3d rightJacobianSO3(const Eigen::Vector3d & phi);
+/// The inverse of rightJacobianSO3. The inverse left Jacobian is inverseRightJacobianSO3(-phi).
+Eigen::Matrix3d inverseRightJacobianSO3(const Eigen::Vector3d & phi);
+
+/**
+ * Preintegrated IMU measurements between two keyframes i and j (Forster et al., "On-Manifold Preintegration for Real-Time Visual-Inertial Odometry").
+ * With the specific force model f = R_i_m * (a_m + g_m) + b_a (as in ErrorTermAccelerometer) and the body angular velocity w = w_i + b_g it holds for the linearization biases:
+ *  - getDeltaR() ~= R_m_i(t_i)^T * R_m_i(t_j)
+ *  - getDeltaV() ~= R_m_i(t_i)^T * (v_j - v_i + g_m * dt)
+ *  - getDeltaP() ~= R_m_i(t_i)^T * (p_j - p_i - v_i * dt + g_m * dt^2 / 2)
+ * The bias Jacobians allow to correct these first order for other biases without integrating again.
+ * The covariance refers to the minimal (rotation, velocity, position) parametrization.
+ */
+class ImuPreintegration {
+ public:
+  typedef Eigen::Matrix<double, 9, 9> Covariance;
+
+  ImuPreintegration(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias);
+
+  /// Integrate one sample held constant over dt [s]. accCov and gyroCov are the covariances of the single measurements.
+  void integrate(const Eigen::Vector3d & acc, const Eigen::Vector3d & gyro, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov);
+  /**
+   * Integrate the dt [s] between two samples with the midpoint rule: the mean angular velocity and the mean of both specific forces, the second rotated into the step's start.
+   * Its error is second order in dt instead of first order for a sample held constant.
+   */
+  void integrate(const Eigen::Vector3d & acc0, const Eigen::Vector3d & gyro0, const Eigen::Vector3d & acc1, const Eigen::Vector3d & gyro1, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov);
+
+  double getDeltaT() const { return dt_; }
+  const Eigen::Matrix3d & getDeltaR() const { return dR_; }
+  const Eigen::Vector3d & getDeltaV() const { return dv_; }
+  const Eigen::Vector3d & getDeltaP() const { return dp_; }
+
+  /// The deltas first order corrected for the biases accBias and gyroBias.
+  Eigen::Matrix3d getDeltaR(const Eigen::Vector3d & gyroBias) const;
+  Eigen::Vector3d getDeltaV(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias) const;
+  Eigen::Vector3d getDeltaP(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias) const;
+
+  const Eigen::Vector3d & getAccBias() const { return accBias_; }
+  const Eigen::Vector3d & getGyroBias() const { return gyroBias_; }
+
+  const Eigen::Matrix3d & getDRdGyroBias() const { return dR_dbg_; }
+  const Eigen::Matrix3d & getDVdAccBias() const { return dv_dba_; }
+  const Eigen::Matrix3d & getDVdGyroBias() const { return dv_dbg_; }
+  const Eigen::Matrix3d & getDPdAccBias() const { return dp_dba_; }
+  const Eigen::Matrix3d & getDPdGyroBias() const { return dp_dbg_; }
+
+  const Covariance & getCovariance() const { return cov_; }
+
+  int getNumSamples() const { return numSamples_; }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+ private:
+  /// Integrate the bias corrected specific force a (in the frame at the step's start) and the rotation dRk = expSO3(phi) over dt.
+  void integrateStep(const Eigen::Vector3d & a, const Eigen::Vector3d & phi, const Eigen::Matrix3d & dRk, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov);
+
+  Eigen::Vector3d accBias_, gyroBias_;
+  double dt_ = 0;
+  Eigen::Matrix3d dR_ = Eigen::Matrix3d::Identity();
+  Eigen::Vector3d dv_ = Eigen::Vector3d::Zero(), dp_ = Eigen::Vector3d::Zero();
+  Eigen::Matrix3d dR_dbg_ = Eigen::Matrix3d::Zero();
+  Eigen::Matrix3d dv_dba_ = Eigen::Matrix3d::Zero(), dv_dbg_ = Eigen::Matrix3d::Zero();
+  Eigen::Matrix3d dp_dba_ = Eigen::Matrix3d::Zero(), dp_dbg_ = Eigen::Matrix3d::Zero();
+  Covariance cov_ = Covariance::Zero();
+  int numSamples_ = 0;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H9962EC70_582F_4433_BE28_D931AA9FD8D0 */
@@ -0,0 +1,52 @@
+#ifndef H88E6B539_39C3_414F_9B44_B1EB2A059577
+#define H88E6B539_39C3_414F_9B44_B1EB2A059577
+
+#include <vector>
+
+#include <Eigen/Core>
+#include <sm/timing/NsecTimeUtilities.hpp>
+
+namespace aslam {
+namespace calibration {
+
+struct AdaptiveKnotOptions {
+  /// The tolerated deviation of the spline from the motion [m].
+  double positionTolerance = 1e-3;
+  /// The tolerated deviation of the spline from the motion [rad].
+  double rotationTolerance = 1e-3;
+  /// The duration the local accelerations get averaged over [s]. A spline cannot follow details much shorter than its knot spacing anyway and the averaging makes the rates robust against single noisy samples.
+  double smoothingDuration = 0.1;
+  double minKnotsPerSecond = 1;
+};
+
+/**
+ * Estimate the knots per second a spline needs locally to follow the given poses within the tolerances.
+ * The local linear and angular accelerations are estimated by finite differences and averaged over options.smoothingDuration. With knot spacing h a spline deviates
+ * about h^2 * |acceleration| / 8 from a motion with that acceleration, which yields the knot rate required at every sample, but at least options.minKnotsPerSecond.
+ *
+ * \param timestamps ascending timestamps [ns]
+ * \param rotPoses unit quaternions (x, y, z, w)
+ * \return the required knot rate at every timestamp
+ */
+std::vector<double> computeLocalKnotsPerSecond(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, const AdaptiveKnotOptions & options);
+
+/**
+ * Place knots such that the number of segments between any two knots matches the integral of the local knot rate in between.
+ * Hence, the knots are dense during aggressive maneuvers and sparse during slow motion.
+ *
+ * \param localKnotsPerSecond the knot rate at every timestamp (see computeLocalKnotsPerSecond)
+ * \param maxSegments the budget of segments if > 0. If the rates require more, the knots get spread with the same relative density.
+ * \return ascending knot times from timestamps.front() to timestamps.back() (both included) [ns]
+ */
+std::vector<sm::timing::NsecTime> placeKnots(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<double> & localKnotsPerSecond, int maxSegments = 0);
+
+/**
+ * The knots per second a uniform spline needs to follow the given poses within the tolerances everywhere,
+ * i.e. the maximum of computeLocalKnotsPerSecond.
+ */
+double computeRequiredKnotsPerSecond(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, const AdaptiveKnotOptions & options);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H88E6B539_39C3_414F_9B44_B1EB2A059577 */
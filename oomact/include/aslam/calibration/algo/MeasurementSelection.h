@@ -0,0 +1,27 @@
+#ifndef HEB6316B6_FF19_44A1_8494_D1EA91237C4C
+#define HEB6316B6_FF19_44A1_8494_D1EA91237C4C
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * Greedy D-optimal selection of at most budget candidates.
+ * Candidate i contributes the information weights[i] * J_i^T J_i, with J_i = jacobians[i] being its whitened Jacobian w.r.t. the parameters of interest.
+ * Every step adds the candidate that increases log det(regularization * I + sum of the selected information) the most.
+ * The gains only shrink as information accumulates (submodularity). Therefore stale gains are upper bounds and only the best candidates need to be reevaluated (lazy greedy).
+ * Without any parameters (zero columns) the candidates are picked evenly spaced.
+ *
+ * \param preselected candidates that get selected in any case. They count against the budget and their information is there from the start. Only they get selected if they exceed the budget.
+ * \return the selected indices, ascending
+ */
+std::vector<size_t> selectMostInformative(const std::vector<Eigen::MatrixXd> & jacobians, const std::vector<double> & weights, size_t budget, const std::vector<size_t> & preselected = {}, double regularization = 1e-9);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* HEB6316B6_FF19_44A1_8494_D1EA91237C4C */
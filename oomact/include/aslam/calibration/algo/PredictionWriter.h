@@ -22,6 +22,7 @@ namespace calibration {
 template <int D, typename PredictionExpression> class MeasurementErrorTerm;
 class ErrorTermTangency;
 class ErrorTermPose;
+class ErrorTermWheelPair;
 
 namespace internal {
 template <int D, typename PredictionExpression>
@@ -33,6 +34,7 @@ void outMeasurementsAndPredictions(Timestamp timestamp, const MeasurementErrorTe
 void outMeasurementsAndPredictions(Timestamp timestamp, const MeasurementErrorTerm<1, aslam::backend::ScalarExpression> & e, std::ostream &outPred, std::ostream &outMeasure);
 void outMeasurementsAndPredictions(Timestamp timestamp, const ErrorTermTangency & e, std::ostream &outPred, std::ostream &outMeasure);
 void outMeasurementsAndPredictions(Timestamp timestamp, const ErrorTermPose & e, std::ostream &outPred, std::ostream &outMeasure);
+void outMeasurementsAndPredictions(Timestamp timestamp, const ErrorTermWheelPair & e, std::ostream &outPred, std::ostream &outMeasure);
 void outMeasurementsAndPredictions(Timestamp timestamp, const backend::ErrorTerm & e, std::ostream &outPred, std::ostream &outMeasure);
 }
 
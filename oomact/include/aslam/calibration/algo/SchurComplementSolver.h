@@ -0,0 +1,72 @@
+#ifndef H3A0E4F6C_94B1_4C7D_8E2A_5F1B7C9D0E13
+#define H3A0E4F6C_94B1_4C7D_8E2A_5F1B7C9D0E13
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * Solves the normal equations H dx = b of a least squares problem with arrow-head structure.
+ * The unknowns are ordered state first ([0, dimState)) and calibration last ([dimState, dimState + dimCalibration)).
+ * The state block H_ss is sparse and banded (spline knots only interact with their neighbors), while the calibration block H_cc is small and dense.
+ * H_ss is factorized with a sparse LDLT, which eliminates the state segment by segment at cost linear in the trajectory length.
+ * The calibration update is then obtained from the dense Schur complement S = H_cc - H_cs H_ss^-1 H_sc and the state update by back substitution.
+ */
+class SchurComplementSolver {
+ public:
+  typedef std::vector<std::pair<int, Eigen::MatrixXd>> JacobianBlocks;
+
+  SchurComplementSolver(int dimState, int dimCalibration);
+
+  /// Reset H and b to zero. Keeps the dimensions.
+  void clear();
+
+  /**
+   * Add one (weighted) error term: H += J^T J, b -= J^T e.
+   * \param jacobianBlocks the Jacobian's column blocks, each with the index of its first column.
+   * \param error the weighted error.
+   */
+  void addErrorTerm(const JacobianBlocks & jacobianBlocks, const Eigen::VectorXd & error);
+
+  /**
+   * Solve (H + lambda * I) dx = b.
+   * \return false iff a factorization failed.
+   */
+  bool solve(double lambda, Eigen::VectorXd & dx) const;
+
+  /**
+   * Compute the marginal covariance of the calibration variables, (H^-1)_cc = S^-1, assuming H is the information matrix.
+   * \return false iff a factorization failed or S is not positive definite.
+   */
+  bool computeCalibrationCovariance(Eigen::MatrixXd & covariance) const;
+
+  const Eigen::VectorXd & getRhs() const {
+    return b_;
+  }
+
+  int getDimState() const {
+    return dimState_;
+  }
+  int getDimCalibration() const {
+    return dimCalibration_;
+  }
+ private:
+  void addToHessian(int row, int col, const Eigen::MatrixXd & block);
+  /// Computes the Schur complement S of the damped H, X = H_ss^-1 H_sc and y = H_ss^-1 b_s.
+  bool eliminateState(double lambda, Eigen::MatrixXd & S, Eigen::MatrixXd & X, Eigen::VectorXd & y) const;
+
+  const int dimState_, dimCalibration_;
+  std::vector<Eigen::Triplet<double>> stateTriplets_, stateCalibrationTriplets_;
+  Eigen::MatrixXd H_cc_;
+  Eigen::VectorXd b_;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H3A0E4F6C_94B1_4C7D_8E2A_5F1B7C9D0E13 */
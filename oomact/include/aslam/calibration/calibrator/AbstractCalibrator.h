@@ -1,9 +1,15 @@
 #ifndef H2E153EC9_9902_41A1_A522_E4E0A04D6F76
 #define H2E153EC9_9902_41A1_A522_E4E0A04D6F76
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "CalibratorI.h"
+#include "ModelAtTimeCache.h"
 #include "../algo/PredictionWriter.h"
 #include "../SensorId.h"
+#include "../tools/ThreadPool.h"
 
 namespace aslam {
 namespace backend {
@@ -49,12 +55,21 @@ class AbstractCalibratorOptions : public CalibratorOptionsI {
   void setNumThreads(int numThreads) {
     this->numThreads = numThreads;
   }
+
+  /// Share one ModelAtTime per timestamp, derivative order and delay variable between all error terms built in the same addFactors.
+  bool getCacheModelAtTime() const {
+    return cacheModelAtTime;
+  }
+  void setCacheModelAtTime(bool cacheModelAtTime) {
+    this->cacheModelAtTime = cacheModelAtTime;
+  }
  private:
   bool predictResults;
   bool verbose;
   bool acceptConstantErrorTerms;
   double splineOutputSamplePeriod;
   int numThreads;
+  bool cacheModelAtTime;
 };
 
 class AbstractCalibrator : public virtual CalibratorI {
@@ -62,7 +77,7 @@ class AbstractCalibrator : public virtual CalibratorI {
   AbstractCalibrator(ValueStoreRef config, std::shared_ptr<Model> model,
                      bool timeBaseSensorRequired);
 
-  virtual ~AbstractCalibrator() {}
+  virtual ~AbstractCalibrator();
 
   void setUpdateHandler(StatusUpdateHandler statusUpdateHandler, CalibrationUpdateHandler calibrationUpdateHandler) override;
 
@@ -87,9 +102,20 @@ class AbstractCalibrator : public virtual CalibratorI {
 
   void addMeasurementTimestamp(Timestamp t, const Sensor & sensor) override;
 
+  ModelAtTimeCache * getModelAtTimeCache() const override;
+  ModelAtTimeCacheStatistics getModelAtTimeCacheStatistics() const override;
+
+  /// Created on first use.
+  ThreadPool & getThreadPool() const override;
+
 protected:
   bool initStates();
   void estimate(const CalibrationConfI & estimationConfig, CalibrationProblem & calibrationProblem, BatchStateReceiver & batchStateReceiver, std::function<void()> optimize);
+  /**
+   * Optimize the problem built by the last estimate again. Only the calibration variables' activity gets updated.
+   * Returns false without optimizing if the problem is outdated because the activity or the measurements changed since it was built.
+   */
+  bool reestimate(const CalibrationConfI & estimationConfig, CalibrationProblem & calibrationProblem, std::function<void()> optimize);
   void printBatchErrorTermStatistics(const CalibrationProblem& batch, bool updateError, std::ostream& out);
   void updateOptimizerInspector(const CalibrationProblem &  currentBatch, bool printRegessionErrorStatistics, std::function<void(std::ostream & o)> printOptimizationState, backend::callback::Registry & callbackRegistry);
   virtual void addFactors(const CalibrationConfI& estimationConfig, backend::ErrorTermReceiver & problem, std::function<void()> statusCallback);
@@ -103,6 +129,7 @@ protected:
   ModuleLink<Sensor> _timeBaseSensor;
 
   std::vector<std::shared_ptr<PredictionWriter>> _predictionData;
+  std::mutex _predictionDataMutex;
 
   StatusUpdateHandler _statusUpdateHandler;
   CalibrationUpdateHandler _calibrationUpdateHandler;
@@ -113,6 +140,33 @@ protected:
 
   ValueStoreRef _config;
  private:
+  /// Everything the error terms of a problem depend on besides the values of the design variables.
+  struct ProblemDependencies {
+    std::vector<bool> calibrationVariableActivity;
+    std::vector<bool> stateActivity;
+    std::vector<bool> observeOnly;
+    std::vector<size_t> numMeasurements;
+    /// The folded constant links are baked into the error terms.
+    Eigen::VectorXd constantLinkValues;
+
+    bool operator == (const ProblemDependencies & other) const {
+      return calibrationVariableActivity == other.calibrationVariableActivity && stateActivity == other.stateActivity && observeOnly == other.observeOnly && numMeasurements == other.numMeasurements
+          && constantLinkValues.size() == other.constantLinkValues.size() && constantLinkValues == other.constantLinkValues;
+    }
+  };
+  /// Requires the calibration variables' activity to be set already.
+  ProblemDependencies getProblemDependencies(const CalibrationConfI& ec) const;
+  /// The dependencies of the problem built by the last estimate.
+  ProblemDependencies _problemDependencies;
+
+  mutable std::unique_ptr<ThreadPool> _threadPool;
+  mutable std::once_flag _threadPoolCreated;
+  std::unique_ptr<ModelAtTimeCache> _modelAtTimeCache;
+  bool _modelAtTimeCacheActive = false;
+  ModelAtTimeCacheStatistics _modelAtTimeCacheStatistics;
+
+  void addModuleErrorTerms(const CalibrationConfI& estimationConfig, backend::ErrorTermReceiver & problem, std::function<void()> statusCallback);
+
   void addMeasurementTimestamp(Timestamp lowerBound, Timestamp upperBound = InvalidTimestamp());
 
   void setCalibrationVariablesActivity(const CalibrationConfI& ec);
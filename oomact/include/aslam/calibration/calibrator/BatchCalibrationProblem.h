@@ -0,0 +1,126 @@
+#ifndef H6D535509_E6B3_458F_A018_2CD2BC81F5B3
+#define H6D535509_E6B3_458F_A018_2CD2BC81F5B3
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <aslam/backend/OptimizationProblem.hpp>
+#include <sm/boost/null_deleter.hpp>
+
+#include <aslam/calibration/calibrator/CalibrationProblem.h>
+#include <aslam/calibration/calibrator/StateCarrier.h>
+#include <aslam/calibration/model/CalibrationVariable.h>
+
+namespace aslam {
+namespace calibration {
+
+class BatchCalibrationProblem : public CalibrationProblem, public BatchStateReceiver {
+ public:
+  /**
+   * \param timeSortedOrdering iff true the design variables are handed to the optimization problem only in arrangeDesignVariables():
+   * the timed state variables sorted by time, then the untimed state variables and finally the calibration variables (arrow-head form).
+   */
+  BatchCalibrationProblem(bool timeSortedOrdering = false) :
+    problemSp_(new backend::OptimizationProblem()),
+    problem_(*problemSp_),
+    timeSortedOrdering_(timeSortedOrdering)
+  {
+  }
+
+  virtual ~BatchCalibrationProblem() {}
+
+  void addCalibrationVariable(CalibrationVariable* c) override {
+    CHECK_NOTNULL(c);
+    dimCalibVariables_ += c->getDesignVariable().minimalDimensions();
+    calibrationDesignVariables_.push_back(&c->getDesignVariable());
+    if(!timeSortedOrdering_){
+      addToProblem(&c->getDesignVariable());
+    }
+  }
+
+  void addStateVariable(backend::DesignVariable* s) override {
+    addStateVariable(s, std::numeric_limits<double>::infinity());
+  }
+
+  void addStateVariable(backend::DesignVariable* s, double time) override {
+    CHECK_NOTNULL(s);
+    dimStateVariables_ += s->minimalDimensions();
+    stateDesignVariables_.push_back(s);
+    stateDesignVariableTimes_.push_back(time);
+    if(!timeSortedOrdering_){
+      addToProblem(s);
+    }
+  }
+
+  void arrangeDesignVariables() override;
+
+  /// The bandwidth (in scalar columns) of the state block given the insertion order and given the actual order.
+  std::pair<size_t, size_t> getStateBandwidths() const;
+
+  size_t getDimCalibrationVariables() const override {
+    return dimCalibVariables_;
+  }
+  size_t getDimStateVariables() const override {
+    return dimStateVariables_;
+  }
+  size_t getNumErrorTerms() const override {
+    return problem_.numErrorTerms();
+  }
+
+  void addErrorTerm(const boost::shared_ptr<aslam::backend::ErrorTerm> & et) override {
+    problem_.addErrorTerm(et);
+  }
+
+  void addBatchState(StateCarrier & /*stateCarrier*/, const BatchStateSP& /*batchState*/) override {
+
+  }
+
+  virtual const std::vector<boost::shared_ptr<backend::ErrorTerm>> & getErrorTerms() const override {
+    struct A : public backend::OptimizationProblem {
+      const std::vector<boost::shared_ptr<backend::ErrorTerm>> & getErrorTerms() const {
+        return _errorTerms;
+      }
+    };
+
+    return static_cast<A&>(problem_).getErrorTerms();
+  }
+
+  virtual void getErrors(const backend::DesignVariable* dv, std::set<backend::ErrorTerm*>& outErrorSet) const override {
+    problem_.getErrors(dv, outErrorSet);
+  }
+
+  const boost::shared_ptr<backend::OptimizationProblem>& getProblemSp() const {
+    return problemSp_;
+  }
+
+  const std::vector<backend::DesignVariable*>& getCalibrationDesignVariables() const {
+    return calibrationDesignVariables_;
+  }
+  /// The state design variables in the order they are given to the optimization problem.
+  const std::vector<backend::DesignVariable*>& getStateDesignVariables() const {
+    return timeSortedOrdering_ ? sortedStateDesignVariables_ : stateDesignVariables_;
+  }
+
+ private:
+  void addToProblem(backend::DesignVariable* dv) {
+    problem_.addDesignVariable(aslam::backend::DesignVariable::Ptr(dv, sm::null_deleter()));
+  }
+
+  boost::shared_ptr<backend::OptimizationProblem> problemSp_;
+  backend::OptimizationProblem & problem_;
+  const bool timeSortedOrdering_;
+
+  std::vector<backend::DesignVariable*> calibrationDesignVariables_, stateDesignVariables_, sortedStateDesignVariables_;
+  std::vector<double> stateDesignVariableTimes_;
+  size_t dimCalibVariables_ = 0, dimStateVariables_ = 0;
+};
+
+/// The maximal distance (in scalar columns) between two columns of one error term's Jacobian given the ordering. Design variables not in the ordering are ignored.
+size_t computeBandwidth(const std::vector<backend::DesignVariable*> & ordering, const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H6D535509_E6B3_458F_A018_2CD2BC81F5B3 */
@@ -13,6 +13,10 @@ class CalibrationProblem : public backend::ErrorTermReceiver {
   virtual ~CalibrationProblem() {}
   virtual void addCalibrationVariable(CalibrationVariable *) = 0;
   virtual void addStateVariable(backend::DesignVariable *) = 0;
+  /// Add a state variable associated with a time (in the units of its spline's time policy) allowing to order state variables by time.
+  virtual void addStateVariable(backend::DesignVariable * dv, double /*time*/) { addStateVariable(dv); }
+  /// Called after all design variables got added and before the first error term is added.
+  virtual void arrangeDesignVariables() {}
 
   virtual const std::vector<boost::shared_ptr<backend::ErrorTerm>> & getErrorTerms() const = 0;
   virtual void getErrors(const backend::DesignVariable* dv, std::set<backend::ErrorTerm*>& outErrorSet) const = 0;
@@ -3,7 +3,10 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <Eigen/Core>
 #include <sm/value_store/ValueStore.hpp>
 
 #include "../data/ObservationManagerI.h"
@@ -23,6 +26,9 @@ class Model;
 class CalibrationVariable;
 class ModuleList;
 class PredictionFunctorWriter;
+class ModelAtTimeCache;
+struct ModelAtTimeCacheStatistics;
+class ThreadPool;
 
 typedef std::function<void()> CalibrationUpdateHandler;
 typedef std::function<void(std::string)> StatusUpdateHandler;
@@ -63,11 +69,22 @@ class CalibratorI : public ObservationManagerI {
     return getModel().getAtTime(time, maximalDerivativeOrder, simplification);
   }
 
+  /// Served from the ModelAtTimeCache if there is one.
+  ModelAtTime getModelAt(Timestamp time, int maximalDerivativeOrder, const ModelSimplification & simplification) const;
+
   ModelAtTime getModelAt(const BoundedTimeExpression & time, int maximalDerivativeOrder, const ModelSimplification & simplification) const{
     return getModelAt<const BoundedTimeExpression &>(time, maximalDerivativeOrder, simplification);
   }
 
   ModelAtTime getModelAt(const Sensor& sensor, Timestamp time, int maximalDerivativeOrder, const ModelSimplification& simplification) const;
+
+  /// The cache used by getModelAt(Timestamp, ...) and getModelAt(const Sensor&, ...). nullptr if models shouldn't be cached.
+  virtual ModelAtTimeCache * getModelAtTimeCache() const { return nullptr; }
+  /// The statistics of the cache while the error terms of the last problem were built. All zero without cacheModelAtTime.
+  virtual ModelAtTimeCacheStatistics getModelAtTimeCacheStatistics() const = 0;
+
+  /// The thread pool shared by all parallel work of this calibrator (state initialization, factor building, statistics and output writing). It has getOptions().getNumThreads() threads.
+  virtual ThreadPool & getThreadPool() const = 0;
 };
 
 class BatchCalibratorI :public virtual CalibratorI {
@@ -75,6 +92,18 @@ class BatchCalibratorI :public virtual CalibratorI {
   virtual ~BatchCalibratorI(){}
 
   virtual void calibrate() = 0;
+
+  /**
+   * Get the marginal covariance of a calibration variable as estimated by the last calibrate().
+   * Requires estimator/computeCovariances=true. Returns an empty matrix if the covariance isn't available (e.g. for inactive variables).
+   */
+  virtual Eigen::MatrixXd getMarginalCovariance(const CalibrationVariable & cv) const = 0;
+
+  /// The bandwidth (in scalar columns) of the last optimized problem's state block in insertion order and in time sorted order. Only computed with estimator/timeSortedOrdering, (0, 0) otherwise.
+  virtual std::pair<size_t, size_t> getStateBandwidths() const = 0;
+
+  /// The number of error terms of the last optimized problem.
+  virtual size_t getNumErrorTerms() const = 0;
 };
 
 class IncrementalCalibratorI : public virtual CalibratorI {
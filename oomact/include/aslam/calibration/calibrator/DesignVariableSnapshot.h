@@ -0,0 +1,43 @@
+#ifndef H1F7A3C2E_5B8D_4E61_9A0C_7D2E4B6F8A15
+#define H1F7A3C2E_5B8D_4E61_9A0C_7D2E4B6F8A15
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace aslam {
+namespace backend {
+class DesignVariable;
+}
+namespace calibration {
+
+/**
+ * The parameters of a set of design variables at one point in time.
+ * Used to reset design variables shared with the model (e.g. calibration variables or trajectory splines) before reoptimizing a problem.
+ */
+class DesignVariableSnapshot {
+ public:
+  /// Store the current parameters of all given design variables in addition to the already stored ones.
+  void capture(const std::vector<backend::DesignVariable*> & designVariables);
+
+  /// Set all stored design variables back to their stored parameters.
+  void restore() const;
+
+  void clear() {
+    values_.clear();
+  }
+  bool empty() const {
+    return values_.empty();
+  }
+  size_t size() const {
+    return values_.size();
+  }
+ private:
+  std::vector<std::pair<backend::DesignVariable*, Eigen::MatrixXd>> values_;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H1F7A3C2E_5B8D_4E61_9A0C_7D2E4B6F8A15 */
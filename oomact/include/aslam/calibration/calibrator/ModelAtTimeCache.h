@@ -0,0 +1,84 @@
+#ifndef H0C8E6A3B_29F4_4D17_8B5E_E3A71F92C604
+#define H0C8E6A3B_29F4_4D17_8B5E_E3A71F92C604
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+#include <aslam/calibration/model/Model.h>
+#include <aslam/calibration/Timestamp.h>
+
+namespace aslam {
+namespace calibration {
+
+struct ModelAtTimeCacheStatistics {
+  size_t models = 0;
+  size_t hits = 0;
+  size_t misses = 0;
+
+  /// The fraction of requests served from the cache, 0 if there weren't any.
+  double getHitRate() const {
+    return hits + misses ? double(hits) / (hits + misses) : 0.0;
+  }
+};
+
+/**
+ * Hands out shared ModelAtTime objects such that all error terms at the same instant use the same trajectory expressions.
+ * A cached model is identified by its timestamp, simplification and bounded delay variable (nullptr for no delay).
+ * A request is served by a cached model of an equal or higher maximal derivative order. A request of a higher order replaces the cached model.
+ * The cache is thread safe. It must be cleared whenever the design variables behind the cached models change (e.g. after initStates) or the batch interval changes.
+ */
+class ModelAtTimeCache {
+ public:
+  struct Key {
+    Timestamp timestamp;
+    bool needGlobalPosition;
+    bool needGlobalOrientation;
+    const void * delayVariable;
+
+    Key(Timestamp timestamp, const ModelSimplification & simplification, const void * delayVariable = nullptr) :
+      timestamp(timestamp),
+      needGlobalPosition(simplification.needGlobalPosition), needGlobalOrientation(simplification.needGlobalOrientation),
+      delayVariable(delayVariable)
+    {
+    }
+
+    bool operator == (const Key & other) const {
+      return timestamp == other.timestamp
+          && needGlobalPosition == other.needGlobalPosition && needGlobalOrientation == other.needGlobalOrientation
+          && delayVariable == other.delayVariable;
+    }
+  };
+
+  /// Returns a cached model for key of at least maximalDerivativeOrder or the one created by create (of exactly that order), which is then cached.
+  ModelAtTime get(const Key & key, int maximalDerivativeOrder, const std::function<ModelAtTime()> & create);
+
+  void clear();
+
+  size_t size() const;
+  size_t getHits() const { return hits_; }
+  size_t getMisses() const { return misses_; }
+  /// The fraction of get calls served from the cache since the last resetStatistics, 0 if there weren't any.
+  double getHitRate() const;
+  ModelAtTimeCacheStatistics getStatistics() const;
+  void resetStatistics();
+
+ private:
+  struct KeyHash {
+    size_t operator()(const Key & k) const;
+  };
+  struct Entry {
+    int maximalDerivativeOrder;
+    ModelAtTime model;
+  };
+
+  mutable std::mutex m_;
+  std::unordered_map<Key, Entry, KeyHash> models_;
+  std::atomic<size_t> hits_{0}, misses_{0};
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H0C8E6A3B_29F4_4D17_8B5E_E3A71F92C604 */
@@ -0,0 +1,64 @@
+#ifndef H7C52B0A9_1E3D_4F86_A4C0_2B9D6E8F3A71
+#define H7C52B0A9_1E3D_4F86_A4C0_2B9D6E8F3A71
+
+#include <functional>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <boost/shared_ptr.hpp>
+#include <sm/value_store/ValueStore.hpp>
+
+namespace aslam {
+namespace backend {
+class DesignVariable;
+class ErrorTerm;
+}
+namespace calibration {
+
+struct SchurComplementOptimizerStatus {
+  int iterations = 0;
+  double initialCost = 0, finalCost = 0;
+  bool converged = false;
+};
+std::ostream & operator << (std::ostream & out, const SchurComplementOptimizerStatus & status);
+
+/**
+ * Levenberg-Marquardt optimizer using the SchurComplementSolver for its linear systems.
+ * It eliminates the state design variables and solves a dense system for the calibration variables only.
+ * Its configuration (maxIterations, convergenceDeltaX, convergenceDeltaJ, initialLambda) is read from the given value store.
+ */
+class SchurComplementOptimizer {
+ public:
+  SchurComplementOptimizer(sm::value_store::ValueStoreRef config);
+
+  SchurComplementOptimizerStatus optimize(
+      const std::vector<backend::DesignVariable*> & stateVariables,
+      const std::vector<backend::DesignVariable*> & calibrationVariables,
+      const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms,
+      std::function<void()> variablesUpdatedCallback = std::function<void()>()) const;
+
+ private:
+  int maxIterations_;
+  double convergenceDeltaX_;
+  double convergenceDeltaJ_;
+  double initialLambda_;
+};
+
+/**
+ * Compute the marginal covariances of the active calibration variables at the current values of all design variables.
+ * The state variables get eliminated using the SchurComplementSolver.
+ * \return false iff the covariance could not be computed (e.g. because the calibration variables are not observable).
+ */
+bool computeCalibrationVariableCovariances(
+    const std::vector<backend::DesignVariable*> & stateVariables,
+    const std::vector<backend::DesignVariable*> & calibrationVariables,
+    const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms,
+    std::unordered_map<const backend::DesignVariable*, Eigen::MatrixXd> & covariances);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H7C52B0A9_1E3D_4F86_A4C0_2B9D6E8F3A71 */
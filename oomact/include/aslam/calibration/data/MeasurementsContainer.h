@@ -65,6 +65,17 @@ template<typename C> struct MeasurementsContainer : public MeasurementContainerI
     }
   }
 
+  /// Remove all measurements before t.
+  inline void removeBefore(Timestamp t) {
+    auto it = std::lower_bound(begin(), end(), t, [](const value_type & m, Timestamp t){ return m.first < t; });
+    Super::erase(begin(), it);
+    if(empty()){
+      maximalGap = Timestamp::Zero();
+    } else {
+      updateMaximalGap();
+    }
+  }
+
   MeasurementsContainer & operator =(const Super & other) {
     Super::operator =(other);
     std::sort(begin(), end(), lessThan);
@@ -0,0 +1,97 @@
+#ifndef H5C0715CF_48AF_4F49_96E1_E1B011CD222E
+#define H5C0715CF_48AF_4F49_96E1_E1B011CD222E
+
+#include <map>
+#include <vector>
+
+#include <Eigen/StdVector>
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+
+#include "MeasurementErrorTerm.h"
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * One error term for a block of D-dimensional measurements of the same kind.
+ * It is equivalent to one MeasurementErrorTerm per sample, but it shares the error term overhead among all samples:
+ * For every design variable there is one dense Jacobian block covering all samples and one insertion into the problem's Jacobian.
+ * It pays off for samples depending on the same design variables, e.g. all IMU samples within one trajectory spline segment.
+ * An M-estimator applies to the block as a whole.
+ */
+template<int D, typename PredictionExpression = backend::VectorExpression<D>>
+class BlockedMeasurementErrorTerm : public aslam::backend::ErrorTermDs, public ErrorTermGroupMember {
+ public:
+  typedef MeasurementErrorTerm<D, PredictionExpression> Single;
+  typedef typename Single::Covariance Covariance;
+  typedef typename Single::Input Input;
+
+  struct Sample {
+    PredictionExpression prediction;
+    Input measurement;
+    Covariance cov;
+  };
+  typedef std::vector<Sample, Eigen::aligned_allocator<Sample>> Samples;
+
+  BlockedMeasurementErrorTerm(Samples samples, const ErrorTermGroupReference & etgr = ErrorTermGroupReference())
+      : aslam::backend::ErrorTermDs(D * samples.size()),
+        ErrorTermGroupMember(etgr),
+        _samples(std::move(samples)) {
+    Eigen::MatrixXd invR = Eigen::MatrixXd::Zero(dimension(), dimension());
+    backend::DesignVariable::set_t dv;
+    for (size_t i = 0; i < _samples.size(); i++) {
+      invR.template block<D, D>(D * i, D * i) = _samples[i].cov.inverse();
+      _samples[i].prediction.getDesignVariables(dv);
+    }
+    this->setInvR(invR);
+    this->setDesignVariablesIterator(dv.begin(), dv.end());
+  }
+
+  virtual ~BlockedMeasurementErrorTerm() = default;
+
+  size_t getNumSamples() const {
+    return _samples.size();
+  }
+  const Sample & getSample(size_t i) const {
+    return _samples[i];
+  }
+
+ protected:
+  double evaluateErrorImplementation() override {
+    Eigen::VectorXd error(dimension());
+    for (size_t i = 0; i < _samples.size(); i++) {
+      error.template segment<D>(D * i) = internal::toMatrix(_samples[i].prediction.toValue() - _samples[i].measurement);
+    }
+    this->setError(error);
+    return this->evaluateChiSquaredError();
+  }
+
+  void evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) override {
+    // Every sample only fills its own D rows of the dense (dimension x dim(dv)) block of each design variable it depends on.
+    std::map<aslam::backend::DesignVariable*, Eigen::MatrixXd> blocks;
+    aslam::backend::JacobianContainer sampleJacobians(D);
+    for (size_t i = 0; i < _samples.size(); i++) {
+      sampleJacobians.clear();
+      _samples[i].prediction.evaluateJacobians(sampleJacobians);
+      for (auto it = sampleJacobians.begin(); it != sampleJacobians.end(); ++it) {
+        Eigen::MatrixXd & block = blocks[it->first];
+        if (block.size() == 0) {
+          block.setZero(dimension(), it->second.cols());
+        }
+        block.template middleRows<D>(D * i) += it->second;
+      }
+    }
+    for (auto & b : blocks) {
+      jacobians.add(b.first, b.second);
+    }
+  }
+
+ private:
+  Samples _samples;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H5C0715CF_48AF_4F49_96E1_E1B011CD222E */
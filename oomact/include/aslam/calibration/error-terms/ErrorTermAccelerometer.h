@@ -38,6 +38,11 @@ namespace aslam {
 
       /// Copy constructor
       ErrorTermAccelerometer(const ErrorTermAccelerometer& other) = default;
+      /// The measurement prediction R_i_m * (a_m_mi + g_m) + bias, e.g. for a BlockedMeasurementErrorTerm.
+      static aslam::backend::EuclideanExpression createPrediction(const aslam::backend::EuclideanExpression& a_m_mi,
+                                                                  const aslam::backend::RotationExpression& R_i_m,
+                                                                  const aslam::backend::EuclideanExpression& g_m,
+                                                                  const aslam::backend::EuclideanExpression& bias);
 
       /// Destructor
       virtual ~ErrorTermAccelerometer(){}
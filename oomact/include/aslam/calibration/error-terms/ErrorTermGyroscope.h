@@ -37,6 +37,9 @@ namespace aslam {
 
       /// Copy constructor
       ErrorTermGyroscope(const ErrorTermGyroscope& other) = default;
+      /// The measurement prediction w_i_mi + bias, e.g. for a BlockedMeasurementErrorTerm.
+      static aslam::backend::EuclideanExpression createPrediction(const aslam::backend::EuclideanExpression& w_i_mi,
+                                                                  const aslam::backend::EuclideanExpression& bias);
 
       /// Destructor
       virtual ~ErrorTermGyroscope(){}
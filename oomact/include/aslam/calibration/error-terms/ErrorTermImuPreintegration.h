@@ -0,0 +1,57 @@
+#ifndef H6588A56E_C245_4449_B410_E8BA751CCDEE
+#define H6588A56E_C245_4449_B410_E8BA751CCDEE
+
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/EuclideanExpression.hpp>
+#include <aslam/backend/RotationExpression.hpp>
+#include <aslam/calibration/algo/ImuPreintegration.h>
+#include <aslam/calibration/error-terms/ErrorTermGroup.h>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * Error term for the IMU samples between two keyframes i and j, preintegrated into an ImuPreintegration.
+ * The error is (rotation, velocity, position) as in Forster et al. with the bias corrected deltas of the preintegration:
+ *  - Log(dR(b_g)^T * R_m_i(t_i)^T * R_m_i(t_j))
+ *  - R_m_i(t_i)^T * (v_j - v_i + g_m * dt) - dv(b_a, b_g)
+ *  - R_m_i(t_i)^T * (p_j - p_i - v_i * dt + g_m * dt^2 / 2) - dp(b_a, b_g)
+ * Its covariance is the preintegrated one.
+ */
+class ErrorTermImuPreintegration : public aslam::backend::ErrorTermFs<9>, public ErrorTermGroupMember {
+ public:
+  // Required by Eigen for fixed-size matrices members
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /// The IMU's state at a keyframe, all in the inertia frame m.
+  struct State {
+    aslam::backend::RotationExpression R_m_i;
+    aslam::backend::EuclideanExpression p_m_i;
+    aslam::backend::EuclideanExpression v_m_i;
+  };
+
+  ErrorTermImuPreintegration(const State & from, const State & till,
+                             const aslam::backend::EuclideanExpression & g_m,
+                             const aslam::backend::EuclideanExpression & accBias,
+                             const aslam::backend::EuclideanExpression & gyroBias,
+                             const ImuPreintegration & preintegration,
+                             const ErrorTermGroupReference & etgr = ErrorTermGroupReference());
+
+  virtual ~ErrorTermImuPreintegration() = default;
+
+  const ImuPreintegration & getPreintegration() const { return preintegration_; }
+
+ protected:
+  double evaluateErrorImplementation() override;
+  void evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) override;
+
+ private:
+  State from_, till_;
+  aslam::backend::EuclideanExpression g_m_, accBias_, gyroBias_;
+  ImuPreintegration preintegration_;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H6588A56E_C245_4449_B410_E8BA751CCDEE */
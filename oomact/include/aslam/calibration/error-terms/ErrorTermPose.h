@@ -8,6 +8,10 @@
 #include "aslam/calibration/data/PoseMeasurement.h"
 namespace aslam {
 namespace calibration {
+/**
+ * Error term of a pose measurement: The translation difference and the rotation vector of C * C_measured^T.
+ * An instance caches its linearization point. Hence, distinct instances may be evaluated concurrently, but one instance only from one thread at a time.
+ */
 class ErrorTermPose : public aslam::backend::ErrorTermFs<6>, public ErrorTermGroupMember {
  public:
   // Required by Eigen for fixed-size matrices members
@@ -35,6 +39,14 @@ class ErrorTermPose : public aslam::backend::ErrorTermFs<6>, public ErrorTermGro
   Eigen::Vector3d _t;
 
   aslam::backend::TransformationExpression _T;
+
+ private:
+  /// The transformation and rotation error at the last error evaluation. evaluateJacobians reuses them as linearization point.
+  Eigen::Matrix4d _linearizationT;
+  Eigen::Vector3d _linearizationRotationError;
+  bool _isLinearized = false;
+  /// The chain rule for _T's Jacobians. It is a member to avoid allocating it in every Jacobian evaluation.
+  Eigen::MatrixXd _chainRule = Eigen::MatrixXd::Identity(6, 6);
 };
 
 }
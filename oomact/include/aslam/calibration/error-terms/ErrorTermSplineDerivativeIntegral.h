@@ -0,0 +1,76 @@
+#ifndef H36CFBB85_B143_41B1_8931_CECDE6CB1353
+#define H36CFBB85_B143_41B1_8931_CECDE6CB1353
+
+#include <vector>
+
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/calibration/error-terms/ErrorTermGroup.h>
+#include <aslam/calibration/Timestamp.h>
+#include <boost/make_shared.hpp>
+#include <glog/logging.h>
+
+#include "aslam/calibration/algo/BSplineGramMatrix.h"
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * The exact integral of |sqrtInvR * f^(derivative)(t)|^2 over one segment of a uniform Euclidean B-spline f.
+ * The integral is a quadratic form in the segment's coefficients c. The error is the linear function W * c with W^T W being that quadratic form.
+ * Its squared error therefore equals the integral without any quadrature.
+ */
+class ErrorTermSplineDerivativeIntegral : public aslam::backend::ErrorTermDs, public ErrorTermGroupMember {
+ public:
+  /**
+   * @param coefficients the design variables of the order coefficients affecting the segment, in time order
+   * @param sqrtGram computeUniformBSplineGramMatrixSqrt(order, derivative)
+   * @param segmentDuration [s]
+   * @param derivative the derivative to integrate
+   * @param sqrtInvR the square root of the inverse covariance density of the derivative
+   */
+  ErrorTermSplineDerivativeIntegral(std::vector<aslam::backend::DesignVariable*> coefficients, const Eigen::MatrixXd & sqrtGram, double segmentDuration, int derivative, const Eigen::MatrixXd & sqrtInvR, const ErrorTermGroupReference & etgr = ErrorTermGroupReference());
+
+  virtual ~ErrorTermSplineDerivativeIntegral() = default;
+
+ protected:
+  double evaluateErrorImplementation() override;
+  void evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) override;
+
+ private:
+  std::vector<aslam::backend::DesignVariable*> _coefficients;
+  /// The coefficients' dimension
+  int _dim;
+  Eigen::MatrixXd _W;
+};
+
+/**
+ * Add one ErrorTermSplineDerivativeIntegral per segment of spline. Together they sum up to the integral of |sqrtInvR * f^(derivative)(t)|^2 over the whole spline.
+ * The spline must be a uniform Euclidean B-spline.
+ * \param errorTermReceiver an aslam::backend::ErrorTermReceiver or anything else with a compatible addErrorTerm, e.g. ErrorTermStatisticsWithProblemAndPredictor
+ * \return the initial total squared error
+ */
+template <typename ErrorTermReceiverT, typename SplineT>
+double addSplineDerivativeIntegralErrorTerms(ErrorTermReceiverT & errorTermReceiver, const SplineT & spline, int derivative, const Eigen::MatrixXd & sqrtInvR, const ErrorTermGroupReference & etgr = ErrorTermGroupReference()) {
+  const int order = spline.getSplineOrder();
+  const int numSegments = spline.getAbsoluteNumberOfSegments();
+  CHECK_EQ(int(spline.numDesignVariables()), numSegments + order - 1);
+  const double segmentDuration = double(Timestamp::fromNumerator(spline.getMaxTime()) - Timestamp::fromNumerator(spline.getMinTime())) / numSegments;
+  const Eigen::MatrixXd sqrtGram = computeUniformBSplineGramMatrixSqrt(order, derivative);
+
+  double squaredError = 0;
+  std::vector<aslam::backend::DesignVariable*> coefficients(order);
+  for(int s = 0; s < numSegments; s++){
+    for(int i = 0; i < order; i++){
+      coefficients[i] = spline.designVariable(s + i);
+    }
+    auto e = boost::make_shared<ErrorTermSplineDerivativeIntegral>(coefficients, sqrtGram, segmentDuration, derivative, sqrtInvR, etgr);
+    squaredError += e->evaluateError();
+    errorTermReceiver.addErrorTerm(e);
+  }
+  return squaredError;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H36CFBB85_B143_41B1_8931_CECDE6CB1353 */
@@ -0,0 +1,56 @@
+#ifndef H508C17E2_1293_4014_870B_A6A27D71081D
+#define H508C17E2_1293_4014_870B_A6A27D71081D
+
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/EuclideanExpression.hpp>
+#include <aslam/backend/ScalarExpression.hpp>
+#include <aslam/calibration/error-terms/ErrorTermGroup.h>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * Error term for the left and right wheel speed of a differential drive, sharing one evaluation of the body twist.
+ * The wheels are at (0, +-L/2, 0) in the odometry frame r. The predicted wheel speeds [rad/s] are
+ * ((v_r_mr)_x -+ (w_r_mr)_z * L / 2) / R_(l|r).
+ * It is equivalent to two ErrorTermWheel on the wheels' velocities v_r_mr + w_r_mr x (0, +-L/2, 0).
+ */
+class ErrorTermWheelPair : public aslam::backend::ErrorTermFs<2>, public ErrorTermGroupMember {
+ public:
+  // Required by Eigen for fixed-size matrices members
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * @param v_r_mr the odometry frame's velocity w.r.t. the mapping frame, expressed in the odometry frame
+   * @param w_r_mr the odometry frame's angular velocity w.r.t. the mapping frame, expressed in the odometry frame
+   * @param L wheel base
+   * @param R_l left wheel radius
+   * @param R_r right wheel radius
+   * @param measurement (left, right) measured wheel speeds [rad/s]
+   * @param variances (left, right) variance of the wheel speed measurements
+   */
+  ErrorTermWheelPair(const aslam::backend::EuclideanExpression & v_r_mr, const aslam::backend::EuclideanExpression & w_r_mr,
+                     const aslam::backend::ScalarExpression & L, const aslam::backend::ScalarExpression & R_l, const aslam::backend::ScalarExpression & R_r,
+                     const Eigen::Vector2d & measurement, const Eigen::Vector2d & variances,
+                     const ErrorTermGroupReference & etgr = ErrorTermGroupReference());
+
+  virtual ~ErrorTermWheelPair() = default;
+
+  /// The predicted (left, right) wheel speeds
+  Eigen::Vector2d getPrediction() const;
+  const Eigen::Vector2d & getMeasurement() const { return _measurement; }
+
+ protected:
+  double evaluateErrorImplementation() override;
+  void evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) override;
+
+ private:
+  aslam::backend::EuclideanExpression _v_r_mr, _w_r_mr;
+  aslam::backend::ScalarExpression _L, _R_l, _R_r;
+  Eigen::Vector2d _measurement;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H508C17E2_1293_4014_870B_A6A27D71081D */
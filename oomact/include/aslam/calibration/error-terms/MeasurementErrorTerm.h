@@ -68,6 +68,10 @@ class MeasurementErrorTerm : public aslam::backend::ErrorTermFs<D>, public Error
   Output getPrediction() const {
     return _measurementPredictionExpression.toValue();
   }
+  /// Returns the expression predicting the measurement
+  const PredictionExpression & getPredictionExpression() const {
+    return _measurementPredictionExpression;
+  }
 
  protected:
   /// Evaluate the error term and return the weighted squared error
@@ -18,6 +18,9 @@ class FrameGraphModel : public Model {
 
   void init() override;
 
+  void updateConstantLinks() override;
+  Eigen::VectorXd getConstantLinkValues() const override;
+
  protected:
   void registerModule(Module & m) override;
  private:
@@ -1,6 +1,7 @@
 #ifndef H9DEA9F60_8E57_4BD5_979F_FDAFFC66C3AD
 #define H9DEA9F60_8E57_4BD5_979F_FDAFFC66C3AD
 #include <map>
+#include <memory>
 #include <vector>
 #include <functional>
 
@@ -75,7 +76,8 @@ class ModelAtTime {
 
   ModelAtTime(std::unique_ptr<ModelAtTimeImpl> && impl) : impl_(std::move(impl)) {}
  private:
-  std::unique_ptr<ModelAtTimeImpl> impl_;
+  /// Shared between copies, e.g. handed out by a ModelAtTimeCache to many error terms.
+  std::shared_ptr<ModelAtTimeImpl> impl_;
 };
 
 class Model : public ModuleRegistry, public Printable, public IsA<Model> {
@@ -133,6 +135,14 @@ class Model : public ModuleRegistry, public Printable, public IsA<Model> {
 
   void updateCVIndices();
 
+  /**
+   * Called by the calibrator after the calibration variables' activity has been set.
+   * Models may replace parts that are constant given the current activity by precomputed values.
+   */
+  virtual void updateConstantLinks() {}
+  /// The current values of all links replaced by updateConstantLinks. Error terms built while they had other values are outdated.
+  virtual Eigen::VectorXd getConstantLinkValues() const { return Eigen::VectorXd(); }
+
   const std::string resolveConfigPath(const std::string & path) const;
 
   /// Adds the odometry design variables to the batch
@@ -10,6 +10,7 @@
 #include <aslam/calibration/calibrator/CalibratorRef.h>
 #include <aslam/calibration/data/StorageI.h>
 #include <aslam/calibration/tools/Named.h>
+#include <aslam/calibration/Timestamp.h>
 
 namespace boost {
   template<typename T> class shared_ptr;
@@ -111,6 +112,12 @@ class Module : public virtual ModuleBase, public virtual Named, public virtual U
 
   virtual void clearMeasurements(ModuleStorage & storage);
   virtual void clearMeasurements(); //TODO Deprecate in favor of clearMeasurements(ModuleStorage & storage); and make that one const. AND remove all the non storage compat functions.
+  /**
+   * Prepare the measurements for a next window starting at nextWindowStart, which overlaps with the current one.
+   * Measurements at or after nextWindowStart move from storage to nextStorage (or stay in the module if it keeps them itself), all others get dropped.
+   * storage gets discarded afterwards. By default no measurements are carried over.
+   */
+  virtual void carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart);
   virtual void addErrorTerms(CalibratorI & calib, const ModuleStorage & storage, const CalibrationConfI & ec, ErrorTermReceiver & errorTermReceiver) const;
   virtual void preProcessNewWindow(CalibratorI & calib);
   virtual void writeSnapshot(const CalibrationConfI & ec, bool stateWasUpdatedSinceLastTime) const;
@@ -119,6 +126,9 @@ class Module : public virtual ModuleBase, public virtual Named, public virtual U
 
   virtual bool hasTooFewMeasurements() const;
 
+  /// The number of measurements this module holds in storage or itself. Used to detect new measurements.
+  virtual size_t getNumMeasurements(const ModuleStorage & storage) const;
+
   void writeInfo(std::ostream & out) const;
 
   virtual ~Module() = default;
@@ -23,9 +23,18 @@ class PoseTrajectory : public Module, public StateCarrier, public Activatable, p
   void addToBatch(const Activator & stateActivator, BatchStateReceiver & batchStateReceiver, DesignVariableReceiver & problem) override;
   void addErrorTerms(CalibratorI & calib, const CalibrationConfI & ec, ErrorTermReceiver & problem) const override;
 
+  /**
+   * Add the soft constraint that the frame's x-axis is tangent to its velocity.
+   * Either sampled uniformly over the batch with one ErrorTermTangency per sample or,
+   * with tangentialConstraint/perSegment, one error term per spline segment covering all its samples.
+   */
+  void addTangentialConstraintErrorTerms(CalibratorI & calib, ErrorTermReceiver & problem, bool observeOnly) const;
 
   const So3R3Trajectory & getCurrentTrajectory() const;
   So3R3Trajectory & getCurrentTrajectory();
+  bool hasCurrentTrajectory() const {
+    return bool(state_);
+  }
 
   virtual ~PoseTrajectory();
 
@@ -55,6 +64,8 @@ class PoseTrajectory : public Module, public StateCarrier, public Activatable, p
   bool estimate = true;
   bool useTanConstraint;
   double tanConstraintVariance;
+  bool tanConstraintPerSegment;
+  int tanConstraintPointsPerSegment;
   bool initWithPoseMeasurements;
   ModuleLink<PoseSensorI> poseSensor;
   ModuleLink<WheelOdometry> odometrySensor;
@@ -10,6 +10,7 @@
 #include <aslam/calibration/model/fragments/DelayCv.h>
 #include <aslam/calibration/SensorId.h>
 #include <aslam/calibration/tools/Interval.h>
+#include <aslam/calibration/tools/MeasurementSelector.h>
 
 namespace aslam {
 namespace calibration {
@@ -49,6 +50,11 @@ class Sensor : public Module, public PoseCv, public DelayCv, public ObserverMini
 
   virtual Interval getCurrentMeasurementTimestampRange(const CalibratorI & calib) const;
 
+  /// Selection of the measurements to build error terms for (config: measurementSelection)
+  const MeasurementSelector & getMeasurementSelector() const {
+    return measurementSelector;
+  }
+
   const SensorId& getId() const {
     return id;
   }
@@ -69,6 +75,7 @@ class Sensor : public Module, public PoseCv, public DelayCv, public ObserverMini
  private:
   double maximalExpectedGap;
   boost::shared_ptr<aslam::backend::MEstimator> mEstimator;
+  MeasurementSelector measurementSelector;
 };
 
 }
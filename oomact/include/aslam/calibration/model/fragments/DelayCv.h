@@ -32,6 +32,8 @@ class DelayCv {
   Timestamp getDelay() const { return hasDelay() ? dt_r_s->toScalar() : Timestamp::Zero(); }
   Timestamp getDelayLowerBound() const { return hasDelay() ? dt_r_s->getLowerBound() : Timestamp::Zero(); }
   Timestamp getDelayUpperBound() const { return hasDelay() ? dt_r_s->getUpperBound() : Timestamp::Zero(); }
+  /// Whether the delay may change during the current estimation. If not, the delayed time is a constant.
+  bool isDelayActive() const { return hasDelay() && dt_r_s->isActivated(); }
 
   const TimeExpression & getDelayExpression() const { return delayExp; }
   const TimeDesignVariableCv& getDelayVariable() const {
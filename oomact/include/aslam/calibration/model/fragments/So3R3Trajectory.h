@@ -1,6 +1,10 @@
 #ifndef H8E4AC88D_C8F7_417C_8732_BFF3DB9C79DE
 #define H8E4AC88D_C8F7_417C_8732_BFF3DB9C79DE
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <aslam/splines/OPTBSpline.hpp>
 #include <aslam/splines/OPTUnitQuaternionBSpline.hpp>
 #include <bsplines/EuclideanBSpline.hpp>
@@ -10,6 +14,7 @@
 
 #include "../../SensorId.h"
 #include "../../tools/Interval.h"
+#include "../../tools/SplineSegmentBracket.h"
 
 namespace aslam {
 namespace backend {
@@ -18,10 +23,9 @@ class ErrorTermReceiver;
 namespace calibration {
 class CalibratorI;
 class DesignVariableReceiver;
+class RelativeKinematicExpression;
 class So3R3TrajectoryCarrier;
-
-typedef aslam::splines::OPTBSpline<typename bsplines::UnitQuaternionBSpline<Eigen::Dynamic, bsplines::NsecTimePolicy>::CONF>::BSpline RotationSpline;
-typedef aslam::splines::OPTBSpline<typename bsplines::EuclideanBSpline<Eigen::Dynamic, 3, bsplines::NsecTimePolicy>::CONF>::BSpline TranslationSpline;
+class ThreadPool;
 
 template <typename RotationFactory, typename TranslationFactory>
 struct ExpressionFactoryPair {
@@ -38,9 +42,65 @@ auto getEF(Spline & s, Timestamp t) -> decltype(s.template getExpressionFactoryA
   return s.template getExpressionFactoryAt<MaxDerivative>(t);
 }
 
+/// Dense samples of a So3R3Trajectory. Column i belongs to times[i].
+struct So3R3TrajectorySamples {
+  std::vector<sm::timing::NsecTime> times;
+  Eigen::Matrix3Xd positions, velocities, accelerations;
+  Eigen::Matrix4Xd orientations;
+  /// In the same (local to global) convention as the trajectory's RelativeKinematicExpression.
+  Eigen::Matrix3Xd angularVelocities, angularAccelerations;
+};
+
+/**
+ * A trajectory in SO(3) x R^3 given by a rotation and a translation spline.
+ * The spline types depend on the orders (see createSo3R3Trajectory). Code depending on the concrete spline types can access them through visitSplines.
+ */
 class So3R3Trajectory {
  public:
-  So3R3Trajectory(const So3R3TrajectoryCarrier & carrier);
+  So3R3Trajectory(const So3R3TrajectoryCarrier & carrier) : carrier(carrier) {}
+  virtual ~So3R3Trajectory();
+
+  const So3R3TrajectoryCarrier& getCarrier() const {
+    return carrier;
+  }
+
+  virtual sm::timing::NsecTime getMinTime() const = 0;
+  virtual sm::timing::NsecTime getMaxTime() const = 0;
+  /// The number of design variables of both splines.
+  virtual size_t numDesignVariables() const = 0;
+
+  virtual void writeToFile(const CalibratorI & calib, const std::string & pathPrefix) const = 0;
+  /// Evaluate poses and their first two derivatives at all times (ascending) without building any expressions.
+  virtual void sample(const std::vector<sm::timing::NsecTime> & times, So3R3TrajectorySamples & samples) const = 0;
+  virtual void addToProblem(const bool stateActive, DesignVariableReceiver & designVariableReceiver) = 0;
+  virtual void addWhiteNoiseModelErrorTerms(backend::ErrorTermReceiver & errorTermReceiver, std::string name, const double invSigma) const = 0;
+
+  /// Fit both splines to the poses. The two fits (and their chunks, see SplineFittingOptions) run concurrently on pool.
+  virtual void fitSplines(const Interval& effectiveBatchInterval, const size_t numMeasurements, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, ThreadPool & pool) = 0;
+
+  virtual void initSplinesConstant(const Interval& effectiveBatchInterval, const size_t numMeasurements, const Eigen::Vector3d & transPose = Eigen::Vector3d::Zero(), const Eigen::Vector4d & rotPose = sm::kinematics::quatIdentity()) = 0;
+
+  /// The kinematics of the trajectory's frame w.r.t. its reference frame at time at.
+  virtual RelativeKinematicExpression calcRelativeKinematics(Timestamp at, bool needGlobalPosition, int maximalDerivativeOrder) const = 0;
+  virtual RelativeKinematicExpression calcRelativeKinematics(const BoundedTimeExpression & at, bool needGlobalPosition, int maximalDerivativeOrder) const = 0;
+
+  /// Call f(rotationSpline, translationSpline) with the concretely typed splines.
+  template <typename F>
+  void visitSplines(F f) const;
+  template <typename F>
+  void visitSplines(F f);
+
+ private:
+  const So3R3TrajectoryCarrier & carrier;
+};
+
+template <typename RotationSplineT, typename TranslationSplineT>
+class So3R3TrajectoryT : public So3R3Trajectory {
+ public:
+  typedef RotationSplineT RotationSpline;
+  typedef TranslationSplineT TranslationSpline;
+
+  So3R3TrajectoryT(const So3R3TrajectoryCarrier & carrier);
 
   RotationSpline & getRotationSpline() {
     return rotationSpline;
@@ -58,17 +118,21 @@ class So3R3Trajectory {
     return translationSpline;
   }
 
-  void writeToFile(const CalibratorI & calib, const std::string & pathPrefix) const;
-  void addToProblem(const bool stateActive, DesignVariableReceiver & designVariableReceiver);
-  void addWhiteNoiseModelErrorTerms(backend::ErrorTermReceiver & errorTermReceiver, std::string name, const double invSigma) const;
+  sm::timing::NsecTime getMinTime() const override;
+  sm::timing::NsecTime getMaxTime() const override;
+  size_t numDesignVariables() const override;
 
-  void fitSplines(const Interval& effectiveBatchInterval, const size_t numMeasurements, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses);
+  void writeToFile(const CalibratorI & calib, const std::string & pathPrefix) const override;
+  void sample(const std::vector<sm::timing::NsecTime> & times, So3R3TrajectorySamples & samples) const override;
+  void addToProblem(const bool stateActive, DesignVariableReceiver & designVariableReceiver) override;
+  void addWhiteNoiseModelErrorTerms(backend::ErrorTermReceiver & errorTermReceiver, std::string name, const double invSigma) const override;
 
-  void initSplinesConstant(const Interval& effectiveBatchInterval, const size_t numMeasurements, const Eigen::Vector3d & transPose = Eigen::Vector3d::Zero(), const Eigen::Vector4d & rotPose = sm::kinematics::quatIdentity());
+  void fitSplines(const Interval& effectiveBatchInterval, const size_t numMeasurements, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, ThreadPool & pool) override;
 
-  const So3R3TrajectoryCarrier& getCarrier() const {
-    return carrier;
-  }
+  void initSplinesConstant(const Interval& effectiveBatchInterval, const size_t numMeasurements, const Eigen::Vector3d & transPose, const Eigen::Vector4d & rotPose) override;
+
+  RelativeKinematicExpression calcRelativeKinematics(Timestamp at, bool needGlobalPosition, int maximalDerivativeOrder) const override;
+  RelativeKinematicExpression calcRelativeKinematics(const BoundedTimeExpression & at, bool needGlobalPosition, int maximalDerivativeOrder) const override;
 
   template <int RotationMaxDerivative, int TranslationMaxDerivative = RotationMaxDerivative, typename Time>
   auto getExpressionFactoryPair(Time t) const -> ExpressionFactoryPair<decltype(getEF<RotationMaxDerivative>(getRotationSpline(), t)), decltype(getEF<TranslationMaxDerivative>(getTranslationSpline(), t))> {
@@ -76,11 +140,58 @@ class So3R3Trajectory {
   }
 
  private:
+  /// Refresh translationKnots after the splines got (re)initialized.
+  void updateKnotTable();
+
   RotationSpline rotationSpline;
   TranslationSpline translationSpline;
-  const So3R3TrajectoryCarrier & carrier;
+  /// The translation spline's knots and control vertices. The segment brackets of the bounded time expressions get built from it without copying them for every measurement.
+  SplineKnotTable translationKnots;
 };
 
+/// The spline types of order SplineOrder (Eigen::Dynamic for orders chosen at runtime).
+template <int SplineOrder>
+struct So3R3Splines {
+  typedef typename aslam::splines::OPTBSpline<typename bsplines::UnitQuaternionBSpline<SplineOrder, bsplines::NsecTimePolicy>::CONF>::BSpline RotationSpline;
+  typedef typename aslam::splines::OPTBSpline<typename bsplines::EuclideanBSpline<SplineOrder, 3, bsplines::NsecTimePolicy>::CONF>::BSpline TranslationSpline;
+  typedef So3R3TrajectoryT<RotationSpline, TranslationSpline> Trajectory;
+};
+
+typedef So3R3Splines<Eigen::Dynamic>::Trajectory DynamicOrderSo3R3Trajectory;
+typedef So3R3Splines<4>::Trajectory Order4So3R3Trajectory;
+typedef So3R3Splines<6>::Trajectory Order6So3R3Trajectory;
+
+/**
+ * Create the trajectory for carrier's spline orders.
+ * Orders 4 and 6 (for both splines) get splines of fixed order, which evaluate with fixed size matrices.
+ * All other orders use the dynamic order splines.
+ */
+std::unique_ptr<So3R3Trajectory> createSo3R3Trajectory(const So3R3TrajectoryCarrier & carrier);
+
+template <typename F>
+void So3R3Trajectory::visitSplines(F f) const {
+  if(auto t = dynamic_cast<const Order4So3R3Trajectory*>(this)){
+    f(t->getRotationSpline(), t->getTranslationSpline());
+  } else if(auto t = dynamic_cast<const Order6So3R3Trajectory*>(this)){
+    f(t->getRotationSpline(), t->getTranslationSpline());
+  } else {
+    auto & d = dynamic_cast<const DynamicOrderSo3R3Trajectory&>(*this);
+    f(d.getRotationSpline(), d.getTranslationSpline());
+  }
+}
+
+template <typename F>
+void So3R3Trajectory::visitSplines(F f) {
+  if(auto t = dynamic_cast<Order4So3R3Trajectory*>(this)){
+    f(t->getRotationSpline(), t->getTranslationSpline());
+  } else if(auto t = dynamic_cast<Order6So3R3Trajectory*>(this)){
+    f(t->getRotationSpline(), t->getTranslationSpline());
+  } else {
+    auto & d = dynamic_cast<DynamicOrderSo3R3Trajectory&>(*this);
+    f(d.getRotationSpline(), d.getTranslationSpline());
+  }
+}
+
 } /* namespace calibration */
 } /* namespace aslam */
 
@@ -1,5 +1,6 @@
 #ifndef H8E4AC88D_C8F7_417C_8732_BFF3DB9C79DF
 #define H8E4AC88D_C8F7_417C_8732_BFF3DB9C79DF
+#include <aslam/calibration/algo/KnotPlacement.h>
 #include <aslam/calibration/model/Module.h>
 
 
@@ -8,6 +9,13 @@ namespace calibration {
 
 class Frame;
 
+struct SplineFittingOptions {
+  /// Fit chunks of this many segments instead of the whole spline at once if > 0. Only used with uniform knots.
+  int chunkSegments = 0;
+  /// The number of segments each chunk is extended by on both sides. At least the spline order is used.
+  int overlapSegments = 20;
+};
+
 class So3R3TrajectoryCarrier : public virtual Named {
  public:
   So3R3TrajectoryCarrier(sm::value_store::ValueStoreRef config);
@@ -36,12 +44,34 @@ class So3R3TrajectoryCarrier : public virtual Named {
     return transFittingLambda;
   }
 
+  /// Whether the rotation expressions are built directly from the quaternion spline instead of through Vector2RotationQuaternionExpressionAdapter.
+  bool isUsingDirectRotationExpression() const {
+    return directRotationExpression;
+  }
+
+  /// Whether fitSplines places non-uniform knots by the motion dynamics. getKnotsPerSecond() times the batch duration is the budget of segments then.
+  bool isUsingAdaptiveKnots() const {
+    return adaptiveKnots;
+  }
+
+  const AdaptiveKnotOptions & getAdaptiveKnotOptions() const {
+    return adaptiveKnotOptions;
+  }
+
+  const SplineFittingOptions & getFittingOptions() const {
+    return fittingOptions;
+  }
+
  protected:
   void writeConfig(std::ostream & out) const;
 
   double knotsPerSecond;
   int rotSplineOrder, transSplineOrder;
   double rotFittingLambda, transFittingLambda;
+  bool directRotationExpression;
+  bool adaptiveKnots;
+  AdaptiveKnotOptions adaptiveKnotOptions;
+  SplineFittingOptions fittingOptions;
 };
 
 } /* namespace calibration */
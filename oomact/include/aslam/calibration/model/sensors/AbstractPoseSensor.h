@@ -23,6 +23,9 @@ class AbstractPoseSensor : public PoseSensorI, public Sensor {
   virtual bool hasMeasurements(const ModuleStorage & storage) const override;
   virtual const PoseMeasurements & getAllMeasurements(const ModuleStorage & storage) const override;
 
+  void carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart) override;
+  size_t getNumMeasurements(const ModuleStorage & storage) const override;
+
   bool isInvertInput() const {
     return invertInput_;
   }
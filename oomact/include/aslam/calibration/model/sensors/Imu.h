@@ -15,6 +15,7 @@ namespace calibration {
 struct AccelerometerMeasurement;
 struct GyroscopeMeasurement;
 class TrajectoryCarrier;
+class SplineSegmentBracket;
 
 class Imu;
 
@@ -28,6 +29,11 @@ class Bias : public StateCarrier, public NamedMinimal {
   bool isUsingSpline() const { return mode_ == Mode::Spline; }
 
   aslam::backend::EuclideanExpression getBiasExpression(Timestamp t) const;
+  /**
+   * As getBiasExpression(t) but a spline bias gets evaluated within segment, the bias spline's segment containing t.
+   * segment gets replaced if it does not contain t. Consecutive times sharing segment share its basis functions.
+   */
+  aslam::backend::EuclideanExpression getBiasExpression(Timestamp t, std::shared_ptr<const SplineSegmentBracket> & segment) const;
 
   void setActive(bool active){
     if(biasVector){
@@ -79,6 +85,8 @@ class Imu : public Sensor, public StateCarrier, public InputReceiverIT<Accelerom
   Imu(Model & model, const std::string & name, sm::value_store::ValueStoreRef config = sm::value_store::ValueStoreRef());
 
   void clearMeasurements() override;
+  void carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart) override;
+  size_t getNumMeasurements(const ModuleStorage & storage) const override;
   void addAccelerometerMeasurement(CalibratorI & calib, const AccelerometerMeasurement& data, Timestamp timestamp) const;
 
   void addGyroscopeMeasurement(CalibratorI & calib, const GyroscopeMeasurement& data, Timestamp timestamp) const;
@@ -100,9 +108,17 @@ class Imu : public Sensor, public StateCarrier, public InputReceiverIT<Accelerom
 
  private:
   void addMeasurementErrorTerms(CalibratorI & calib, const CalibrationConfI & ec, backend::ErrorTermReceiver & errorTermReceiver, bool observeOnly) const override;
+  void addPreintegratedErrorTerms(CalibratorI & calib, backend::ErrorTermReceiver & errorTermReceiver, bool observeOnly) const;
   std::shared_ptr<Measurements> measurements_;
   const bool useAcc_, useGyro_;
 
+  /// Use one preintegrated error term per keyframe interval instead of one error term per accelerometer and gyroscope sample
+  const bool usePreintegration_;
+  /// Minimal time between two keyframes [s]
+  const double keyframeInterval_;
+  /// The maximal number of samples per error term block. 0 for one error term per sample.
+  const size_t maxSamplesPerBlock_;
+
   /// Covariance for Accelerometer measurements
   Covariance covAcc_;
   /// Statistical random walk value for the accelerometer
@@ -31,6 +31,8 @@ class PositionSensor : public Sensor, public InputReceiverIT<PositionMeasurement
   void addInputTo(Timestamp t, const PositionMeasurement & position, ModuleStorage & s) const override;
 
   virtual void clearMeasurements() override;
+  void carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart) override;
+  size_t getNumMeasurements(const ModuleStorage & storage) const override;
   void addMeasurementErrorTerms(CalibratorI & calib, const CalibrationConfI & ec, ErrorTermReceiver & problem, bool observeOnly) const override;
  private:
   std::shared_ptr<PositionMeasurements> measurements;
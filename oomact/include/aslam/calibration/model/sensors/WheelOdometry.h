@@ -16,6 +16,8 @@ class WheelOdometry : public Sensor {
 
   void addMeasurementErrorTerms(CalibratorI & calib, const CalibrationConfI & ec, ErrorTermReceiver & problem, bool observeOnly) const override;
   void clearMeasurements() override;
+  void carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart) override;
+  size_t getNumMeasurements(const ModuleStorage & storage) const override;
 
   void addMeasurement(CalibratorI & calib, Timestamp t, const WheelSpeedsMeasurement & m) const;
 
@@ -24,6 +24,7 @@ class MockCalibrator: public AbstractCalibrator
   using AbstractCalibrator::initStates;
 
   SimpleModuleStorage storage_;
+  AbstractCalibratorOptions options_;
 };
 
 } /* namespace calibration */
@@ -0,0 +1,66 @@
+#ifndef HC5559EFE_AD02_4159_91C0_5C9A02F03A81
+#define HC5559EFE_AD02_4159_91C0_5C9A02F03A81
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <aslam/backend/ErrorTerm.hpp>
+#include <boost/shared_ptr.hpp>
+#include <sm/value_store/ValueStore.hpp>
+
+#include <aslam/calibration/Timestamp.h>
+
+namespace aslam {
+namespace calibration {
+
+class Model;
+
+/**
+ * Selects the measurements of a sensor worth an error term before the error terms get built.
+ * Configuration (all optional):
+ *  - used (false)
+ *  - maxMeasurements (1000): the budget of measurements to keep per batch
+ *  - windowDuration (0.1) [s]: measurements get selected in windows of at most this duration. Only one measurement per window gets scored.
+ *    0 makes every measurement a window, which costs one error term per measurement for the scoring.
+ */
+class MeasurementSelector {
+ public:
+  MeasurementSelector(sm::value_store::ValueStoreRef config);
+
+  bool isUsed() const {
+    return used_;
+  }
+  size_t getMaxMeasurements() const {
+    return maxMeasurements_;
+  }
+  double getWindowDuration() const {
+    return windowDuration_;
+  }
+
+  typedef std::function<boost::shared_ptr<aslam::backend::ErrorTerm>(size_t index)> ErrorTermFactory;
+
+  /**
+   * Choose the measurements to keep.
+   * Every window is scored by the error term of its middle measurement at the current (initial) estimate:
+   * its whitened Jacobian w.r.t. the model's active calibration variables, weighted with the window's number of measurements.
+   * Whole windows get kept by greedy D-optimal selection (selectMostInformative) until the budget is used up.
+   * Spline design variables are ignored in the scores.
+   * Windows end at the segment boundaries of the model's trajectories. Every segment with candidates keeps one window first. These coverage windows count against the budget; if there are more segments than the budget, only evenly spaced ones get covered.
+   *
+   * \param timestamps the candidate measurements' timestamps, ascending
+   * \param createErrorTerm creates the error term for the candidate with the given index or returns an empty pointer if it would not get one anyway
+   * \return whether to keep each candidate
+   */
+  std::vector<bool> select(const Model & model, const std::vector<Timestamp> & timestamps, const ErrorTermFactory & createErrorTerm) const;
+
+ private:
+  bool used_;
+  size_t maxMeasurements_;
+  double windowDuration_;
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* HC5559EFE_AD02_4159_91C0_5C9A02F03A81 */
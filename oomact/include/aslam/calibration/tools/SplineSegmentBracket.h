@@ -0,0 +1,100 @@
+#ifndef H5F1C9E3A_7B2D_4E86_9C0F_3A8D6B21E457
+#define H5F1C9E3A_7B2D_4E86_9C0F_3A8D6B21E457
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+#include <aslam/backend/DesignVariable.hpp>
+#include <aslam/backend/EuclideanExpression.hpp>
+#include <aslam/backend/GenericScalarExpression.hpp>
+#include <sm/timing/NsecTimeUtilities.hpp>
+
+#include "../Timestamp.h"
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * The knot spans of a spline a time within [lBound, uBound] can reach, with their basis derivatives and control vertices.
+ * It gets built once per measurement, when its error terms are built. Locating the span of a time then only scans the bracket's few spans
+ * (constant for a fixed ratio of the bounds' width and the knot spacing) instead of searching the whole knot sequence on every evaluation.
+ */
+class SplineSegmentBracket {
+ public:
+  /**
+   * \param knots the spline's knots [ns]
+   * \param controlVertices all the spline's control vertices. Only those affecting the bracket are kept.
+   */
+  SplineSegmentBracket(const std::vector<sm::timing::NsecTime> & knots, int order, const std::vector<backend::DesignVariable*> & controlVertices, Timestamp lBound, Timestamp uBound);
+
+  int getOrder() const { return order_; }
+  int getNumSpans() const { return spanStarts_.size() - 1; }
+  Timestamp getLowerBound() const { return lBound_; }
+  Timestamp getUpperBound() const { return uBound_; }
+
+  /// The span containing t (clamped into the bounds), counted from the bracket's first span.
+  int getSpan(Timestamp t) const;
+
+  /// The weights of the order control vertices affecting span to get the derivative-th derivative [1/s^derivative] at t.
+  Eigen::VectorXd getBasisWeights(int span, Timestamp t, int derivative) const;
+
+  /// The r-th of the order control vertices affecting span.
+  backend::DesignVariable * getControlVertex(int span, int r) const { return controlVertices_[span + r]; }
+  const std::vector<backend::DesignVariable*> & getControlVertices() const { return controlVertices_; }
+
+ private:
+  int order_;
+  Timestamp lBound_, uBound_;
+  std::vector<sm::timing::NsecTime> spanStarts_;
+  std::vector<Eigen::MatrixXd> basisDerivatives_;
+  std::vector<backend::DesignVariable*> controlVertices_;
+};
+
+/**
+ * The knots and control vertices of a spline that is linear in its control vertices (e.g. a bsplines::EuclideanBSpline).
+ * It must be updated whenever the spline got (re)initialized. Building a bracket from it then only costs a binary search and the bracket's own spans.
+ */
+class SplineKnotTable {
+ public:
+  template <typename Spline>
+  void update(const Spline & spline) {
+    order_ = spline.getSplineOrder();
+    const auto knots = spline.getKnotsVector();
+    knots_.assign(knots.begin(), knots.end());
+    controlVertices_.resize(spline.numDesignVariables());
+    for (size_t i = 0; i < controlVertices_.size(); ++i) {
+      controlVertices_[i] = spline.designVariable(i);
+    }
+  }
+
+  /// Whether the table has spline's order and control vertices. A cheap guard against a missing update().
+  template <typename Spline>
+  bool matches(const Spline & spline) const {
+    return order_ == spline.getSplineOrder() && controlVertices_.size() == spline.numDesignVariables() && (controlVertices_.empty() || controlVertices_.front() == spline.designVariable(0));
+  }
+
+  int getOrder() const { return order_; }
+  const std::vector<sm::timing::NsecTime> & getKnots() const { return knots_; }
+  const std::vector<backend::DesignVariable*> & getControlVertices() const { return controlVertices_; }
+
+  std::shared_ptr<const SplineSegmentBracket> createBracket(Timestamp lBound, Timestamp uBound) const {
+    return std::make_shared<const SplineSegmentBracket>(knots_, order_, controlVertices_, lBound, uBound);
+  }
+
+ private:
+  int order_ = 0;
+  std::vector<sm::timing::NsecTime> knots_;
+  std::vector<backend::DesignVariable*> controlVertices_;
+};
+
+/**
+ * The derivative-th time derivative of a three dimensional spline that is linear in its control vertices at the time t, which must stay within the bracket's bounds.
+ * The Jacobians cover the control vertices and t.
+ */
+backend::EuclideanExpression createEuclideanSplineExpression(const std::shared_ptr<const SplineSegmentBracket> & bracket, const backend::GenericScalarExpression<Timestamp> & t, int derivative);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H5F1C9E3A_7B2D_4E86_9C0F_3A8D6B21E457 */
@@ -1,25 +1,198 @@
 #ifndef H4FCBA143_7A1D_4792_8B1C_825C9B311CE5
 #define H4FCBA143_7A1D_4792_8B1C_825C9B311CE5
 
-#include <sm/timing/NsecTimeUtilities.hpp>
+#include <algorithm>
 #include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <glog/logging.h>
+#include <sm/timing/NsecTimeUtilities.hpp>
+#include "aslam/calibration/algo/BSplineGramMatrix.h"
+#include "aslam/calibration/tools/ThreadPool.h"
 #include "aslam/calibration/tools/tools.h"
 
 namespace aslam {
 namespace calibration {
 
+/// The times getMinTime(), getMinTime() + dt, ... up to getMaxTime() of spline.
+template <typename Spline>
+std::vector<sm::timing::NsecTime> getSampleTimes(const Spline& spline, double dt) {
+  const sm::timing::NsecTime dtNSec = sm::timing::secToNsec(dt);
+  CHECK_GT(dtNSec, 0) << "The sample period must be positive!";
+  const auto t0 = spline.getMinTime(), T = spline.getMaxTime();
+  std::vector<sm::timing::NsecTime> times;
+  times.reserve(T >= t0 ? (T - t0) / dtNSec + 1 : 0);
+  for (auto t = t0; t <= T; t += dtNSec) {
+    times.push_back(t);
+  }
+  return times;
+}
+
+/**
+ * Evaluate spline and its derivatives up to MaxDerivative at all times (ascending) in one pass.
+ * derivatives[d].col(i) becomes the d-th derivative at times[i].
+ * It only uses the splines' evaluators and no expression factories or expressions.
+ */
+template <int MaxDerivative, typename Spline>
+void sampleSpline(const Spline& spline, const std::vector<sm::timing::NsecTime> & times, std::vector<Eigen::MatrixXd> & derivatives) {
+  derivatives.assign(MaxDerivative + 1, Eigen::MatrixXd());
+  for (size_t i = 0; i < times.size(); ++i) {
+    DCHECK(i == 0 || times[i - 1] <= times[i]) << "The times must be sorted!";
+    const auto evaluator = spline.template getEvaluatorAt<MaxDerivative>(times[i]);
+    for (int d = 0; d <= MaxDerivative; ++d) {
+      const auto value = evaluator.evalD(d);
+      if (i == 0) {
+        derivatives[d].resize(value.rows(), times.size());
+      }
+      derivatives[d].col(i) = value;
+    }
+  }
+}
+
+/// As sampleSpline but the times get sampled concurrently on pool.
+template <int MaxDerivative, typename Spline>
+void sampleSpline(const Spline& spline, const std::vector<sm::timing::NsecTime> & times, std::vector<Eigen::MatrixXd> & derivatives, ThreadPool & pool) {
+  derivatives.assign(MaxDerivative + 1, Eigen::MatrixXd());
+  if (times.empty()) {
+    return;
+  }
+  {
+    const auto evaluator = spline.template getEvaluatorAt<MaxDerivative>(times.front());
+    for (int d = 0; d <= MaxDerivative; ++d) {
+      derivatives[d].resize(evaluator.evalD(d).rows(), times.size());
+    }
+  }
+  pool.parallelFor(0, times.size(), [&](size_t i){
+    const auto evaluator = spline.template getEvaluatorAt<MaxDerivative>(times[i]);
+    for (int d = 0; d <= MaxDerivative; ++d) {
+      derivatives[d].col(i) = evaluator.evalD(d);
+    }
+  });
+}
+
+/**
+ * Evaluates a spline that is linear in its control vertices (e.g. a bsplines::EuclideanBSpline) and its derivatives at ascending times.
+ * It walks the knot spans in order and expands the spline once per span into its Taylor polynomial at the span's start.
+ * Every sample then only evaluates that polynomial. There is no segment search and no basis evaluation per sample.
+ */
+template <typename Spline>
+class EuclideanSplineSampler {
+ public:
+  explicit EuclideanSplineSampler(const Spline& spline) : spline_(spline), order_(spline.getSplineOrder()) {
+    const auto knots = spline.getKnotsVector();
+    CHECK_GT(spline.numDesignVariables(), 0u) << "The spline must be initialized!";
+    CHECK_EQ(knots.size(), spline.numDesignVariables() + order_) << "Unexpected knot layout!";
+    knots_.assign(knots.begin(), knots.end());
+    Eigen::MatrixXd cv;
+    spline.designVariable(0)->getParameters(cv);
+    controlVertices_.resize(cv.rows(), order_);
+    knotSeconds_.reserve(knots_.size());
+    for (const auto k : knots_) {
+      knotSeconds_.push_back(sm::timing::nsecToSec(k - knots_.front()));
+    }
+  }
+
+  int getDimension() const {
+    return controlVertices_.rows();
+  }
+
+  /// Move to time t. Only walks forward from the current span unless t lies before it.
+  void moveTo(sm::timing::NsecTime t) {
+    const int firstSpan = order_ - 1, lastSpan = int(spline_.numDesignVariables()) - 1;
+    int span = span_;
+    if (span < firstSpan || t < knots_[span]) {
+      span = int(std::upper_bound(knots_.begin() + firstSpan, knots_.begin() + lastSpan + 1, t) - knots_.begin()) - 1;
+    }
+    while (span < lastSpan && knots_[span + 1] <= t) {
+      ++span;
+    }
+    span = std::max(firstSpan, std::min(lastSpan, span));
+    if (span != span_) {
+      span_ = span;
+      expandSpan();
+    }
+    x_ = sm::timing::nsecToSec(t - knots_[span_]);
+  }
+
+  /// The derivative-th derivative at the time of the last moveTo.
+  Eigen::VectorXd evalD(int derivative) const {
+    Eigen::VectorXd value = Eigen::VectorXd::Zero(taylor_.rows());
+    double factor = 1; // x^(k - derivative) / (k - derivative)!
+    for (int k = derivative; k < order_; ++k) {
+      value += taylor_.col(k) * factor;
+      factor *= x_ / (k - derivative + 1);
+    }
+    return value;
+  }
+
+ private:
+  void expandSpan() {
+    const Eigen::MatrixXd D = computeBSplineBasisDerivativesAtSpanStart(knotSeconds_, order_, span_);
+    Eigen::MatrixXd cv;
+    for (int r = 0; r < order_; ++r) {
+      spline_.designVariable(span_ - order_ + 1 + r)->getParameters(cv);
+      controlVertices_.col(r) = cv.col(0);
+    }
+    // Column k holds the k-th derivative at the span's start.
+    taylor_ = controlVertices_ * D.transpose();
+  }
+
+  const Spline& spline_;
+  const int order_;
+  std::vector<sm::timing::NsecTime> knots_;
+  std::vector<double> knotSeconds_;
+  int span_ = -1;
+  double x_ = 0;
+  Eigen::MatrixXd controlVertices_, taylor_;
+};
+
+namespace internal {
+/// Samples times[begin, end) into the already allocated derivatives.
+template <int MaxDerivative, typename Spline>
+void sampleEuclideanSplineRange(const Spline& spline, const std::vector<sm::timing::NsecTime> & times, size_t begin, size_t end, std::vector<Eigen::MatrixXd> & derivatives) {
+  EuclideanSplineSampler<Spline> sampler(spline);
+  for (size_t i = begin; i < end; ++i) {
+    DCHECK(i == begin || times[i - 1] <= times[i]) << "The times must be sorted!";
+    sampler.moveTo(times[i]);
+    for (int d = 0; d <= MaxDerivative; ++d) {
+      derivatives[d].col(i) = sampler.evalD(d);
+    }
+  }
+}
+}
+
+/// As sampleSpline but for splines that are linear in their control vertices, using an EuclideanSplineSampler.
+template <int MaxDerivative, typename Spline>
+void sampleEuclideanSpline(const Spline& spline, const std::vector<sm::timing::NsecTime> & times, std::vector<Eigen::MatrixXd> & derivatives) {
+  derivatives.assign(MaxDerivative + 1, Eigen::MatrixXd(EuclideanSplineSampler<Spline>(spline).getDimension(), times.size()));
+  internal::sampleEuclideanSplineRange<MaxDerivative>(spline, times, 0, times.size(), derivatives);
+}
+
+/// As sampleEuclideanSpline but contiguous chunks of times are sampled concurrently on pool.
+template <int MaxDerivative, typename Spline>
+void sampleEuclideanSpline(const Spline& spline, const std::vector<sm::timing::NsecTime> & times, std::vector<Eigen::MatrixXd> & derivatives, ThreadPool & pool) {
+  derivatives.assign(MaxDerivative + 1, Eigen::MatrixXd(EuclideanSplineSampler<Spline>(spline).getDimension(), times.size()));
+  const size_t numChunks = 4 * pool.getNumThreads(), chunkSize = (times.size() + numChunks - 1) / numChunks;
+  pool.parallelFor(0, numChunks, [&](size_t chunk){
+    internal::sampleEuclideanSplineRange<MaxDerivative>(spline, times, std::min(times.size(), chunk * chunkSize), std::min(times.size(), (chunk + 1) * chunkSize), derivatives);
+  }, 1);
+}
+
+inline void writeSamples(const std::vector<sm::timing::NsecTime> & times, const Eigen::MatrixXd & values, std::ofstream & stream) {
+  for (size_t i = 0; i < times.size(); ++i) {
+    stream << times[i] << " " << values.col(i).transpose() << '\n';
+  }
+  stream.flush();
+}
+
 template <typename Spline>
 void writeSpline(const Spline& spline, double dt, std::ofstream & stream) {
-  using sm::timing::secToNsec;
   if(stream.is_open()){
-    auto t = spline.getMinTime();
-    auto T = spline.getMaxTime();
-    sm::timing::NsecTime dtNSec = secToNsec(dt);
-    while (t <= T) {
-      auto expFactory = spline.template getExpressionFactoryAt<0>(t);
-      stream << t << " " << expFactory.getValueExpression().toValue().transpose() << std::endl;
-      t += dtNSec;
-    }
+    const auto times = getSampleTimes(spline, dt);
+    std::vector<Eigen::MatrixXd> values;
+    sampleSpline<0>(spline, times, values);
+    writeSamples(times, values[0], stream);
   }
 }
 
@@ -32,6 +205,32 @@ void writeSpline(const Spline& spline, double dt, const std::string & path) {
   }
 }
 
+/// As writeSpline but samples on pool.
+template <typename Spline>
+void writeSpline(const Spline& spline, double dt, const std::string & path, ThreadPool & pool) {
+  std::ofstream stream;
+  openStream(stream, path);
+  if(stream.is_open()){
+    const auto times = getSampleTimes(spline, dt);
+    std::vector<Eigen::MatrixXd> values;
+    sampleSpline<0>(spline, times, values, pool);
+    writeSamples(times, values[0], stream);
+  }
+}
+
+/// As writeSpline but for splines that are linear in their control vertices (see sampleEuclideanSpline).
+template <typename Spline>
+void writeEuclideanSpline(const Spline& spline, double dt, const std::string & path, ThreadPool & pool) {
+  std::ofstream stream;
+  openStream(stream, path);
+  if(stream.is_open()){
+    const auto times = getSampleTimes(spline, dt);
+    std::vector<Eigen::MatrixXd> values;
+    sampleEuclideanSpline<0>(spline, times, values, pool);
+    writeSamples(times, values[0], stream);
+  }
+}
+
 }
 }
 
@@ -0,0 +1,116 @@
+#ifndef H5B2D8E41_C7A3_4F09_B6E2_1A9C3D7F5E28
+#define H5B2D8E41_C7A3_4F09_B6E2_1A9C3D7F5E28
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace aslam {
+namespace calibration {
+
+class ThreadPool;
+
+/**
+ * A set of tasks that can be waited for as a whole (fork-join).
+ * The first exception thrown by any of its tasks is rethrown by ThreadPool::wait.
+ */
+class TaskGroup {
+ public:
+  TaskGroup() = default;
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup & operator=(const TaskGroup &) = delete;
+
+  bool isDone() const {
+    return pending_.load() == 0;
+  }
+ private:
+  friend class ThreadPool;
+  void taskDone(std::exception_ptr e);
+
+  std::atomic<size_t> pending_{0};
+  std::mutex m_;
+  std::condition_variable cv_;
+  std::exception_ptr exception_;
+};
+
+struct ThreadPoolStatistics {
+  size_t tasksExecuted = 0;
+  size_t tasksStolen = 0;
+  double taskSeconds = 0;
+};
+std::ostream & operator << (std::ostream & out, const ThreadPoolStatistics & stats);
+
+/**
+ * A persistent work-stealing thread pool.
+ * Every worker owns a task queue. It works on its own queue LIFO and steals FIFO from the others when its own queue is empty.
+ * Threads waiting for a TaskGroup execute pending tasks meanwhile. Nested fork-join therefore does not deadlock.
+ * With numThreads <= 1 no worker gets started and all tasks run synchronously in the submitting thread.
+ */
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t numThreads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  size_t getNumThreads() const {
+    return workers_.empty() ? 1 : workers_.size();
+  }
+
+  /// Schedule task as part of group.
+  void run(TaskGroup & group, std::function<void()> task);
+
+  /// Block until all tasks of group are done, helping with pending tasks meanwhile. Rethrows the group's first exception.
+  void wait(TaskGroup & group);
+
+  /**
+   * Call f(i) for all i in [begin, end) and wait for all calls to return.
+   * \param grainSize the number of consecutive indices handled by one task. 0 picks one that gives about four tasks per thread.
+   */
+  void parallelFor(size_t begin, size_t end, const std::function<void(size_t)> & f, size_t grainSize = 0);
+
+  /// The counters since construction or the last resetStatistics().
+  ThreadPoolStatistics getStatistics() const;
+  void resetStatistics();
+
+ private:
+  struct Task {
+    std::function<void()> f;
+    TaskGroup * group;
+  };
+  struct Worker {
+    std::deque<Task> queue;
+    std::mutex m;
+    std::thread thread;
+  };
+
+  void workerLoop(size_t index);
+  bool tryPop(size_t index, Task & task);
+  bool trySteal(size_t thiefIndex, Task & task);
+  bool tryGetTask(size_t index, Task & task);
+  void execute(Task & task);
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> nextQueue_{0};
+  std::atomic<size_t> numQueued_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex sleepMutex_;
+  std::condition_variable sleepCv_;
+
+  std::atomic<size_t> tasksExecuted_{0}, tasksStolen_{0};
+  std::atomic<long long> taskNanoSeconds_{0};
+};
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H5B2D8E41_C7A3_4F09_B6E2_1A9C3D7F5E28 */
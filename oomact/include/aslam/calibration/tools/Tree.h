@@ -1,7 +1,11 @@
 #ifndef H45524307_F3B1_4796_B68A_9C62139560F1
 #define H45524307_F3B1_4796_B68A_9C62139560F1
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #include <iostream>
 
@@ -10,22 +14,19 @@
 namespace aslam {
 namespace calibration {
 
-
-template <typename N, typename EP>
+/**
+ * A tree given by its edges (child -> parent).
+ * After init() every node has a dense index, its parent's index and its depth.
+ * Node lookups are hash lookups and all path queries only touch the nodes on the path without allocating memory.
+ */
+template <typename N, typename EP, typename Hash = std::hash<N>>
 class Tree {
  public:
   class TreeFailure : public std::runtime_error {
     using std::runtime_error::runtime_error;
   };
 
-  struct Edge;
-
-  struct Node {
-    Node(N node) : node(node){}
-    N node;
-    Node * parent = nullptr;
-    Edge * toParentEdge = nullptr;
-  };
+  static constexpr size_t NoIndex = std::numeric_limits<size_t>::max();
 
   struct Edge {
     N from, to;
@@ -38,75 +39,64 @@ class Tree {
   }
 
   void init() {
-    nodes.reserve(edges.size() * 2); // prevent reallocation which otherwise would ruin the addresses.
-    for(auto & e : edges){
-      auto toNode = getNode(e.to, true);
-      auto fromNode = getNode(e.from, true);
-      CHECK(toNode);
-      CHECK(fromNode);
-      CHECK(fromNode->parent == nullptr) << "This is not a tree because" << fromNode << " has multiple parents!";
-      fromNode->parent = toNode;
-      fromNode->toParentEdge = &e;
+    for(size_t e = 0; e < edges.size(); e++){
+      const size_t to = getOrCreateIndex(edges[e].to);
+      const size_t from = getOrCreateIndex(edges[e].from);
+      CHECK(nodes[from].parent == NoIndex) << "This is not a tree because " << edges[e].from << " has multiple parents!";
+      nodes[from].parent = to;
+      nodes[from].toParentEdge = e;
     }
 
-    auto isRoot = [&](const Node & n){
-      return n.parent == nullptr;
-    };
-    CHECK(std::count_if(nodes.begin(), nodes.end(), isRoot) == 1) << "This is not a tree!";
-    root = &(* std::find_if(nodes.begin(), nodes.end(), isRoot));
+    CHECK(std::count_if(nodes.begin(), nodes.end(), [](const Node & n){ return n.parent == NoIndex; }) == 1) << "This is not a tree!";
+    for(size_t i = 0; i < nodes.size(); i++){
+      size_t depth = 0;
+      for(size_t n = i; nodes[n].parent != NoIndex; n = nodes[n].parent){
+        CHECK(++depth < nodes.size()) << "This is not a tree because " << nodes[i].node << " is on a cycle!";
+      }
+      nodes[i].depth = depth;
+      if(depth == 0){
+        root = i;
+      }
+    }
   }
 
-  N getClosestCommonAncestor(N from, N to){
+  N getClosestCommonAncestor(N from, N to) const {
     CHECK(isInitialized()) << "Did you forget to call init() after adding?";
     if(from == to) return from;
-    auto pathFromToRoot = getPathToRoot(getNode(from));
-    auto pathToToRoot = getPathToRoot(getNode(to));
-    int fi = pathFromToRoot.size() - 1;
-    for(auto it = pathToToRoot.rbegin(); it != pathToToRoot.rend(); it++){
-      if(fi < 0 || pathFromToRoot[fi] != *it){
-        if(fi >= 0) CHECK((*it)->to == pathFromToRoot[fi]->to) << "No common ancestor found!";
-        return (*it)->to;
-      }
-      fi--;
+    return nodes[getClosestCommonAncestor(getIndex(from), getIndex(to))].node;
+  }
+
+  /// The closest common ancestor of the nodes with index a and b. O(depth(a) + depth(b) - 2 * depth(result)).
+  size_t getClosestCommonAncestor(size_t a, size_t b) const {
+    while(nodes[a].depth > nodes[b].depth) a = nodes[a].parent;
+    while(nodes[b].depth > nodes[a].depth) b = nodes[b].parent;
+    while(a != b){
+      a = nodes[a].parent;
+      b = nodes[b].parent;
     }
-    CHECK(fi >= 0);
-    return pathFromToRoot[fi]->to;
+    return a;
   }
 
+  /**
+   * Calls f(payload, towardsLeafs) for every edge on the path from `from` to `to`.
+   * First for the edges up to the closest common ancestor (towardsLeafs = false) and then for the ones down to `to` (towardsLeafs = true).
+   */
   template <typename F>
-  void walkPath(N from, N to, F f){
+  void walkPath(N from, N to, F f) const {
     CHECK(isInitialized()) << "Did you forget to call init() after adding?";
     if(from == to) return;
-    auto pathFromToRoot = getPathToRoot(getNode(from));
-    auto pathToToRoot = getPathToRoot(getNode(to));
-    int fi = pathFromToRoot.size() - 1;
-    bool foundClosestCommonAncestor = false;
-
-    auto goForward = [&](){
-      for(int i = 0; i <= fi; i ++){
-        f(pathFromToRoot[i]->payload, false);
-      }
-    };
-    for(auto it = pathToToRoot.rbegin(); it != pathToToRoot.rend(); it++){
-      if(foundClosestCommonAncestor){
-        f((*it)->payload, true);
-      } else if(fi < 0 || pathFromToRoot[fi] != *it){
-        goForward();
-        f((*it)->payload, true);
-        foundClosestCommonAncestor = true;
-      }
-      fi--;
-    }
-    if(!foundClosestCommonAncestor){
-      goForward();
+    const size_t fromIndex = getIndex(from), toIndex = getIndex(to);
+    const size_t ancestor = getClosestCommonAncestor(fromIndex, toIndex);
+    for(size_t n = fromIndex; n != ancestor; n = nodes[n].parent){
+      f(edges[nodes[n].toParentEdge].payload, false);
     }
+    walkDown(ancestor, toIndex, f);
   }
 
   friend std::ostream & operator <<(std::ostream & o, const Tree & t){
     for(const Node & n : t.nodes){
-      if (n.parent) {
-        CHECK(n.toParentEdge);
-        o << "(" << n.node << "->" << n.toParentEdge->payload << "->" << n.parent->node << ")";
+      if (n.parent != NoIndex) {
+        o << "(" << n.node << "->" << t.edges[n.toParentEdge].payload << "->" << t.nodes[n.parent].node << ")";
       } else {
         o << "(ROOT:" << n.node <<")";
       }
@@ -114,39 +104,87 @@ class Tree {
     return o;
   }
 
-  bool isInitialized() {
-    return root != nullptr;
+  bool isInitialized() const {
+    return root != NoIndex;
+  }
+
+  N getRoot() const {
+    CHECK(isInitialized()) << "Did you forget to call init() after adding?";
+    return nodes[root].node;
+  }
+
+  template <typename F>
+  void forEachNode(F f) const {
+    for(const Node & n : nodes){
+      f(n.node);
+    }
+  }
+
+  size_t getNumNodes() const {
+    return nodes.size();
+  }
+
+  /// The dense index in [0, getNumNodes()) of node.
+  size_t getIndex(N node) const {
+    auto it = index.find(node);
+    if(it == index.end()){
+      LOG(FATAL) << node << " not in the tree!";
+    }
+    return it->second;
+  }
+
+  N getNode(size_t i) const {
+    return nodes[i].node;
+  }
+
+  size_t getDepth(size_t i) const {
+    return nodes[i].depth;
+  }
+
+  /// The parent's index or NoIndex for the root.
+  size_t getParent(size_t i) const {
+    return nodes[i].parent;
+  }
+
+  /// The payload of the edge to the parent. Must not be called for the root.
+  const EP & getToParentPayload(size_t i) const {
+    CHECK(nodes[i].parent != NoIndex) << nodes[i].node << " has no parent!";
+    return edges[nodes[i].toParentEdge].payload;
   }
  private:
-  Node * getNode(N node, bool create = false){
-    auto it = std::find_if(nodes.begin(), nodes.end(), [&](const Node & n){
-      return n.node == node;
-    });
-    if(it == nodes.end()){
-      if(!create){
-        LOG(FATAL) << node << " not in the tree!";
-      }
+  struct Node {
+    Node(N node) : node(node){}
+    N node;
+    size_t parent = NoIndex;
+    size_t toParentEdge = NoIndex;
+    size_t depth = 0;
+  };
+
+  size_t getOrCreateIndex(N node){
+    auto it = index.emplace(node, nodes.size());
+    if(it.second){
       nodes.emplace_back(Node{node});
-      return &nodes.back();
-    } else {
-      return &(*it);
     }
+    return it.first->second;
   }
 
-  std::vector<Edge*> getPathToRoot(const Node * np) {
-    std::vector<Edge*> ret;
-    while(np->parent){
-      ret.emplace_back(np->toParentEdge);
-      np = np->parent;
-    }
-    return ret;
+  /// Calls f for the edges from ancestor down to n in that order. The recursion depth is the path length.
+  template <typename F>
+  void walkDown(size_t ancestor, size_t n, F & f) const {
+    if(n == ancestor) return;
+    walkDown(ancestor, nodes[n].parent, f);
+    f(edges[nodes[n].toParentEdge].payload, true);
   }
 
   std::vector<Edge> edges;
   std::vector<Node> nodes;
-  Node * root = nullptr;
+  std::unordered_map<N, size_t, Hash> index;
+  size_t root = NoIndex;
 };
 
+template <typename N, typename EP, typename Hash>
+constexpr size_t Tree<N, EP, Hash>::NoIndex;
+
 }
 }
 
@@ -0,0 +1,25 @@
+#ifndef H9E6EE830_C39C_408A_AF6C_D2826B7564E5
+#define H9E6EE830_C39C_408A_AF6C_D2826B7564E5
+#include <Eigen/Core>
+
+#include <aslam/backend/RotationExpression.hpp>
+#include <aslam/backend/VectorExpression.hpp>
+
+namespace aslam {
+namespace calibration {
+
+/**
+ * The rotation expression of a unit quaternion valued vector expression (e.g. a UnitQuaternionBSpline's value expression).
+ * In contrast to backend::Vector2RotationQuaternionExpressionAdapter it maps the quaternion's Jacobians
+ * to the rotation's minimal parameterization with one closed form 3x4 matrix and no intermediate expression nodes.
+ * The quaternion must be normalized (as the spline's values are by construction).
+ */
+backend::RotationExpression toUnitQuaternionRotationExpression(const backend::VectorExpression<4> & q);
+
+/// The Jacobian of the rotation's minimal perturbation with respect to the unit quaternion q.
+Eigen::Matrix<double, 3, 4> calcUnitQuaternionRotationJacobian(const Eigen::Vector4d & q);
+
+} /* namespace calibration */
+} /* namespace aslam */
+
+#endif /* H9E6EE830_C39C_408A_AF6C_D2826B7564E5 */
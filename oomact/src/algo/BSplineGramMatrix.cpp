@@ -0,0 +1,214 @@
+#include <aslam/calibration/algo/BSplineGramMatrix.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include <Eigen/Eigenvalues>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <glog/logging.h>
+
+namespace aslam {
+namespace calibration {
+
+namespace {
+double binomial(int n, int k) {
+  if(k < 0 || k > n){
+    return 0;
+  }
+  double r = 1;
+  for(int i = 1; i <= k; i++){
+    r = r * (n - k + i) / i;
+  }
+  return r;
+}
+double factorial(int n) {
+  double r = 1;
+  for(int i = 2; i <= n; i++){
+    r *= i;
+  }
+  return r;
+}
+}
+
+Eigen::MatrixXd computeUniformBSplineBasisMatrix(int order) {
+  CHECK_GT(order, 0);
+  const int k = order;
+  // Qin, "General matrix representations for B-splines"
+  Eigen::MatrixXd M(k, k);
+  for(int p = 0; p < k; p++){
+    for(int i = 0; i < k; i++){
+      double sum = 0;
+      for(int s = i; s < k; s++){
+        sum += ((s - i) % 2 ? -1. : 1.) * binomial(k, s - i) * std::pow(double(k - s - 1), k - 1 - p);
+      }
+      M(p, i) = binomial(k - 1, p) * sum / factorial(k - 1);
+    }
+  }
+  return M;
+}
+
+Eigen::MatrixXd computeBSplineBasisDerivativesAtSpanStart(const std::vector<double> & knots, int order, int span) {
+  CHECK_GT(order, 0);
+  const int p = order - 1;
+  CHECK_GE(span, p);
+  CHECK_LT(span + p, int(knots.size()));
+  const double u = knots[span];
+
+  // Piegl and Tiller, "The NURBS Book", algorithm A2.3
+  Eigen::MatrixXd ndu(order, order);
+  Eigen::VectorXd left(order), right(order);
+  ndu(0, 0) = 1;
+  for(int j = 1; j <= p; j++){
+    left[j] = u - knots[span + 1 - j];
+    right[j] = knots[span + j] - u;
+    double saved = 0;
+    for(int r = 0; r < j; r++){
+      // The knot differences are stored in the lower triangle.
+      ndu(j, r) = right[r + 1] + left[j - r];
+      const double temp = ndu(r, j - 1) / ndu(j, r);
+      ndu(r, j) = saved + right[r + 1] * temp;
+      saved = left[j - r] * temp;
+    }
+    ndu(j, j) = saved;
+  }
+
+  Eigen::MatrixXd D(order, order);
+  D.row(0) = ndu.col(p).transpose();
+  Eigen::MatrixXd a(2, order);
+  for(int r = 0; r <= p; r++){
+    int s1 = 0, s2 = 1;
+    a(0, 0) = 1;
+    for(int k = 1; k <= p; k++){
+      double d = 0;
+      const int rk = r - k, pk = p - k;
+      if(r >= k){
+        a(s2, 0) = a(s1, 0) / ndu(pk + 1, rk);
+        d = a(s2, 0) * ndu(rk, pk);
+      }
+      const int j1 = rk >= -1 ? 1 : -rk;
+      const int j2 = r - 1 <= pk ? k - 1 : p - r;
+      for(int j = j1; j <= j2; j++){
+        a(s2, j) = (a(s1, j) - a(s1, j - 1)) / ndu(pk + 1, rk + j);
+        d += a(s2, j) * ndu(rk + j, pk);
+      }
+      if(r <= pk){
+        a(s2, k) = -a(s1, k - 1) / ndu(pk + 1, r);
+        d += a(s2, k) * ndu(r, pk);
+      }
+      D(k, r) = d;
+      std::swap(s1, s2);
+    }
+  }
+  double factor = p;
+  for(int k = 1; k <= p; k++){
+    D.row(k) *= factor;
+    factor *= p - k;
+  }
+  return D;
+}
+
+Eigen::MatrixXd computeUniformBSplineGramMatrix(int order, int derivative) {
+  CHECK_GE(derivative, 0);
+  const Eigen::MatrixXd M = computeUniformBSplineBasisMatrix(order);
+  if(derivative >= order){
+    return Eigen::MatrixXd::Zero(order, order);
+  }
+  // The monomial coefficients of the derivatives.
+  const int n = order - derivative;
+  Eigen::MatrixXd D(n, order);
+  for(int p = 0; p < n; p++){
+    D.row(p) = M.row(p + derivative) * (factorial(p + derivative) / factorial(p));
+  }
+  // integral_0^1 u^p u^q du
+  Eigen::MatrixXd H(n, n);
+  for(int p = 0; p < n; p++){
+    for(int q = 0; q < n; q++){
+      H(p, q) = 1. / (p + q + 1);
+    }
+  }
+  return D.transpose() * H * D;
+}
+
+Eigen::MatrixXd computeUniformBSplineGramMatrixSqrt(int order, int derivative) {
+  const int rank = std::max(0, order - derivative);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(computeUniformBSplineGramMatrix(order, derivative));
+  // The eigenvalues are ascending. Only the last rank ones are nonzero.
+  const Eigen::VectorXd values = eigen.eigenvalues().tail(rank).cwiseMax(0).cwiseSqrt();
+  return values.asDiagonal() * eigen.eigenvectors().rightCols(rank).transpose();
+}
+
+Eigen::MatrixXd fitBSplineControlVertices(const std::vector<double> & knots, int order, const std::vector<double> & times, const Eigen::MatrixXd & points, double lambda) {
+  CHECK_GT(order, 0);
+  CHECK_EQ(times.size(), size_t(points.cols()));
+  CHECK_GE(lambda, 0);
+  const int p = order - 1;
+  const int numControlVertices = int(knots.size()) - order;
+  CHECK_GE(numControlVertices, order);
+
+  // The polynomial coefficients of every span's basis functions. Span s affects the control vertices s - p, ..., s.
+  const int firstSpan = p, lastSpan = numControlVertices - 1;
+  std::vector<Eigen::MatrixXd> spanBases(lastSpan + 1);
+  for(int span = firstSpan; span <= lastSpan; span++){
+    spanBases[span] = computeBSplineBasisDerivativesAtSpanStart(knots, order, span);
+    for(int k = 2; k < order; k++){
+      spanBases[span].row(k) /= factorial(k);
+    }
+  }
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  auto addBlock = [&](int span, const Eigen::MatrixXd & block){
+    for(int r = 0; r < order; r++){
+      for(int c = 0; c < order; c++){
+        triplets.emplace_back(span - p + r, span - p + c, block(r, c));
+      }
+    }
+  };
+
+  Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(numControlVertices, points.rows());
+  for(size_t i = 0; i < times.size(); i++){
+    const int span = std::min<int>(lastSpan, std::max<int>(firstSpan, std::upper_bound(knots.begin() + firstSpan, knots.begin() + lastSpan + 1, times[i]) - knots.begin() - 1));
+    const double s = times[i] - knots[span];
+    Eigen::RowVectorXd b = spanBases[span].row(0);
+    double sk = 1;
+    for(int k = 1; k < order; k++){
+      sk *= s;
+      b += sk * spanBases[span].row(k);
+    }
+    addBlock(span, b.transpose() * b);
+    rhs.middleRows(span - p, order) += b.transpose() * points.col(i).transpose();
+  }
+
+  // The second derivative on a span of length h is sum_m C(m, r) s^m, hence its squared integral is C^T H C with H(a, b) = h^(a + b + 1) / (a + b + 1).
+  if(lambda > 0 && order > 2){
+    const int n = order - 2;
+    for(int span = firstSpan; span <= lastSpan; span++){
+      const double h = knots[span + 1] - knots[span];
+      if(h <= 0){
+        continue;
+      }
+      Eigen::MatrixXd C(n, order);
+      for(int m = 0; m < n; m++){
+        C.row(m) = spanBases[span].row(m + 2) * ((m + 2) * (m + 1));
+      }
+      Eigen::MatrixXd H(n, n);
+      for(int a = 0; a < n; a++){
+        for(int b = 0; b < n; b++){
+          H(a, b) = std::pow(h, a + b + 1) / (a + b + 1);
+        }
+      }
+      addBlock(span, lambda * C.transpose() * H * C);
+    }
+  }
+
+  Eigen::SparseMatrix<double> normalMatrix(numControlVertices, numControlVertices);
+  normalMatrix.setFromTriplets(triplets.begin(), triplets.end());
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(normalMatrix);
+  CHECK_EQ(Eigen::Success, solver.info()) << "The spline fit is underdetermined. It needs more points or lambda > 0.";
+  const Eigen::MatrixXd controlVertices = solver.solve(rhs);
+  return controlVertices.transpose();
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
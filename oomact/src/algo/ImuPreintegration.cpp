@@ -0,0 +1,117 @@
+#include <aslam/calibration/algo/ImuPreintegration.h>
+
+#include <cmath>
+
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+namespace aslam {
+namespace calibration {
+
+namespace {
+Eigen::Matrix3d skew(const Eigen::Vector3d & v){
+  Eigen::Matrix3d m;
+  m << 0, -v[2], v[1],
+       v[2], 0, -v[0],
+       -v[1], v[0], 0;
+  return m;
+}
+constexpr double SmallAngle = 1e-5;
+}
+
+Eigen::Matrix3d expSO3(const Eigen::Vector3d & phi) {
+  const double angle = phi.norm();
+  if(angle < SmallAngle){
+    return Eigen::Matrix3d::Identity() + skew(phi);
+  }
+  return Eigen::AngleAxisd(angle, phi / angle).toRotationMatrix();
+}
+
+Eigen::Vector3d logSO3(const Eigen::Matrix3d & R) {
+  const Eigen::AngleAxisd aa(R);
+  return aa.axis() * aa.angle();
+}
+
+Eigen::Matrix3d rightJacobianSO3(const Eigen::Vector3d & phi) {
+  const double angle = phi.norm();
+  const Eigen::Matrix3d phiX = skew(phi);
+  if(angle < SmallAngle){
+    return Eigen::Matrix3d::Identity() - 0.5 * phiX + phiX * phiX / 6.;
+  }
+  const double angle2 = angle * angle;
+  return Eigen::Matrix3d::Identity() - (1. - std::cos(angle)) / angle2 * phiX + (angle - std::sin(angle)) / (angle2 * angle) * phiX * phiX;
+}
+
+Eigen::Matrix3d inverseRightJacobianSO3(const Eigen::Vector3d & phi) {
+  const double angle = phi.norm();
+  const Eigen::Matrix3d phiX = skew(phi);
+  if(angle < SmallAngle){
+    return Eigen::Matrix3d::Identity() + 0.5 * phiX + phiX * phiX / 12.;
+  }
+  return Eigen::Matrix3d::Identity() + 0.5 * phiX + (1. / (angle * angle) - (1. + std::cos(angle)) / (2. * angle * std::sin(angle))) * phiX * phiX;
+}
+
+ImuPreintegration::ImuPreintegration(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias) :
+  accBias_(accBias),
+  gyroBias_(gyroBias)
+{
+}
+
+void ImuPreintegration::integrate(const Eigen::Vector3d & acc, const Eigen::Vector3d & gyro, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov) {
+  CHECK_GT(dt, 0);
+  const Eigen::Vector3d phi = (gyro - gyroBias_) * dt;
+  integrateStep(acc - accBias_, phi, expSO3(phi), dt, accCov, gyroCov);
+}
+
+void ImuPreintegration::integrate(const Eigen::Vector3d & acc0, const Eigen::Vector3d & gyro0, const Eigen::Vector3d & acc1, const Eigen::Vector3d & gyro1, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov) {
+  CHECK_GT(dt, 0);
+  const Eigen::Vector3d phi = (0.5 * (gyro0 + gyro1) - gyroBias_) * dt;
+  const Eigen::Matrix3d dRk = expSO3(phi);
+  // The bias Jacobians and the covariance treat the mean like a single sample.
+  integrateStep(0.5 * ((acc0 - accBias_) + dRk * (acc1 - accBias_)), phi, dRk, dt, accCov, gyroCov);
+}
+
+void ImuPreintegration::integrateStep(const Eigen::Vector3d & a, const Eigen::Vector3d & phi, const Eigen::Matrix3d & dRk, double dt, const Eigen::Matrix3d & accCov, const Eigen::Matrix3d & gyroCov) {
+  const Eigen::Matrix3d Jr = rightJacobianSO3(phi);
+  const Eigen::Matrix3d dRaX = dR_ * skew(a);
+  const double dt2 = dt * dt;
+
+  // Propagate the covariance of (rotation, velocity, position). Everything on the right hand side refers to the state before this sample.
+  Covariance A = Covariance::Identity();
+  A.block<3, 3>(0, 0) = dRk.transpose();
+  A.block<3, 3>(3, 0) = -dRaX * dt;
+  A.block<3, 3>(6, 0) = -0.5 * dRaX * dt2;
+  A.block<3, 3>(6, 3) = Eigen::Matrix3d::Identity() * dt;
+  Eigen::Matrix<double, 9, 3> Bg = Eigen::Matrix<double, 9, 3>::Zero(), Ba = Eigen::Matrix<double, 9, 3>::Zero();
+  Bg.topRows<3>() = Jr * dt;
+  Ba.middleRows<3>(3) = dR_ * dt;
+  Ba.bottomRows<3>() = 0.5 * dR_ * dt2;
+  cov_ = A * cov_ * A.transpose() + Bg * gyroCov * Bg.transpose() + Ba * accCov * Ba.transpose();
+
+  dp_dba_ += dv_dba_ * dt - 0.5 * dR_ * dt2;
+  dp_dbg_ += dv_dbg_ * dt - 0.5 * dRaX * dR_dbg_ * dt2;
+  dv_dba_ -= dR_ * dt;
+  dv_dbg_ -= dRaX * dR_dbg_ * dt;
+  dR_dbg_ = dRk.transpose() * dR_dbg_ - Jr * dt;
+
+  dp_ += dv_ * dt + 0.5 * dR_ * a * dt2;
+  dv_ += dR_ * a * dt;
+  dR_ = dR_ * dRk;
+  dt_ += dt;
+  numSamples_++;
+}
+
+Eigen::Matrix3d ImuPreintegration::getDeltaR(const Eigen::Vector3d & gyroBias) const {
+  return dR_ * expSO3(dR_dbg_ * (gyroBias - gyroBias_));
+}
+
+Eigen::Vector3d ImuPreintegration::getDeltaV(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias) const {
+  return dv_ + dv_dba_ * (accBias - accBias_) + dv_dbg_ * (gyroBias - gyroBias_);
+}
+
+Eigen::Vector3d ImuPreintegration::getDeltaP(const Eigen::Vector3d & accBias, const Eigen::Vector3d & gyroBias) const {
+  return dp_ + dp_dba_ * (accBias - accBias_) + dp_dbg_ * (gyroBias - gyroBias_);
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -0,0 +1,117 @@
+#include <aslam/calibration/algo/KnotPlacement.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Geometry>
+#include <glog/logging.h>
+
+namespace aslam {
+namespace calibration {
+
+namespace {
+Eigen::Quaterniond toQuaternion(const Eigen::Vector4d & q){
+  return Eigen::Quaterniond(q[3], q[0], q[1], q[2]);
+}
+
+/// The (body) angular velocity turning a into b within dt.
+Eigen::Vector3d calcAngularVelocity(const Eigen::Vector4d & a, const Eigen::Vector4d & b, double dt){
+  const Eigen::AngleAxisd aa(toQuaternion(a).conjugate() * toQuaternion(b)); // angle in [0, pi]
+  return aa.axis() * aa.angle() / dt;
+}
+}
+
+std::vector<double> computeLocalKnotsPerSecond(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, const AdaptiveKnotOptions & options) {
+  CHECK_EQ(timestamps.size(), transPoses.size());
+  CHECK_EQ(timestamps.size(), rotPoses.size());
+  CHECK_GT(options.positionTolerance, 0);
+  CHECK_GT(options.rotationTolerance, 0);
+  CHECK_GT(options.minKnotsPerSecond, 0);
+  CHECK_GE(options.smoothingDuration, 0);
+
+  const size_t n = timestamps.size();
+  std::vector<double> rates(n, options.minKnotsPerSecond);
+  if(n < 3){
+    return rates;
+  }
+
+  // Prefix sums of the acceleration norms and the number of valid samples, to average over the smoothing window in linear time.
+  std::vector<double> sumAcc(n + 1, 0), sumAngAcc(n + 1, 0), numValid(n + 1, 0);
+  for(size_t i = 0; i < n; i++){
+    double acc = 0, angAcc = 0, valid = 0;
+    // The first and last sample use the finite differences of their neighbor.
+    const size_t j = std::min(std::max<size_t>(i, 1), n - 2);
+    const double dtA = (timestamps[j] - timestamps[j - 1]) * 1e-9, dtB = (timestamps[j + 1] - timestamps[j]) * 1e-9;
+    if(dtA > 0 && dtB > 0){
+      const double dt = (dtA + dtB) / 2;
+      acc = (((transPoses[j + 1] - transPoses[j]) / dtB - (transPoses[j] - transPoses[j - 1]) / dtA) / dt).norm();
+      angAcc = ((calcAngularVelocity(rotPoses[j], rotPoses[j + 1], dtB) - calcAngularVelocity(rotPoses[j - 1], rotPoses[j], dtA)) / dt).norm();
+      valid = 1;
+    }
+    sumAcc[i + 1] = sumAcc[i] + acc;
+    sumAngAcc[i + 1] = sumAngAcc[i] + angAcc;
+    numValid[i + 1] = numValid[i] + valid;
+  }
+
+  const sm::timing::NsecTime halfWindow = sm::timing::NsecTime(options.smoothingDuration * 0.5e9);
+  size_t lo = 0, hi = 0;
+  for(size_t i = 0; i < n; i++){
+    while(timestamps[lo] < timestamps[i] - halfWindow){
+      lo++;
+    }
+    while(hi < n && timestamps[hi] <= timestamps[i] + halfWindow){
+      hi++;
+    }
+    const double count = numValid[hi] - numValid[lo];
+    if(count > 0){
+      rates[i] = std::max({
+          options.minKnotsPerSecond,
+          std::sqrt((sumAcc[hi] - sumAcc[lo]) / count / (8 * options.positionTolerance)),
+          std::sqrt((sumAngAcc[hi] - sumAngAcc[lo]) / count / (8 * options.rotationTolerance))
+        });
+    }
+  }
+  return rates;
+}
+
+std::vector<sm::timing::NsecTime> placeKnots(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<double> & localKnotsPerSecond, int maxSegments) {
+  CHECK_EQ(timestamps.size(), localKnotsPerSecond.size());
+  CHECK_GE(timestamps.size(), 2u);
+  CHECK_LT(timestamps.front(), timestamps.back());
+
+  // The number of segments the local knot rates require up to every timestamp.
+  const size_t n = timestamps.size();
+  std::vector<double> requiredSegments(n, 0);
+  for(size_t i = 1; i < n; i++){
+    CHECK_GT(localKnotsPerSecond[i], 0);
+    requiredSegments[i] = requiredSegments[i - 1] + 0.5 * (localKnotsPerSecond[i - 1] + localKnotsPerSecond[i]) * (timestamps[i] - timestamps[i - 1]) * 1e-9;
+  }
+  int numSegments = std::max<int>(1, std::lround(requiredSegments.back()));
+  if(maxSegments > 0){
+    numSegments = std::min(numSegments, maxSegments);
+  }
+  const double segmentsPerKnot = requiredSegments.back() / numSegments;
+
+  std::vector<sm::timing::NsecTime> knots;
+  knots.reserve(numSegments + 1);
+  knots.push_back(timestamps.front());
+  size_t j = 0;
+  for(int k = 1; k < numSegments; k++){
+    const double target = k * segmentsPerKnot;
+    while(requiredSegments[j + 1] < target){
+      j++;
+    }
+    const double alpha = (target - requiredSegments[j]) / (requiredSegments[j + 1] - requiredSegments[j]);
+    knots.push_back(timestamps[j] + sm::timing::NsecTime(std::llround(alpha * (timestamps[j + 1] - timestamps[j]))));
+  }
+  knots.push_back(timestamps.back());
+  return knots;
+}
+
+double computeRequiredKnotsPerSecond(const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, const AdaptiveKnotOptions & options) {
+  const std::vector<double> rates = computeLocalKnotsPerSecond(timestamps, transPoses, rotPoses, options);
+  return rates.empty() ? options.minKnotsPerSecond : *std::max_element(rates.begin(), rates.end());
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
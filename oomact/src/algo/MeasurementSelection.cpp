@@ -0,0 +1,117 @@
+#include <aslam/calibration/algo/MeasurementSelection.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include <Eigen/Cholesky>
+#include <glog/logging.h>
+
+namespace aslam {
+namespace calibration {
+
+namespace {
+/// log det(I + w * J * info^-1 * J^T), with infoLlt the Cholesky decomposition of info
+double computeLogDetGain(const Eigen::LLT<Eigen::MatrixXd> & infoLlt, const Eigen::MatrixXd & J, double w) {
+  if(J.rows() == 0 || w <= 0){
+    return 0;
+  }
+  const Eigen::MatrixXd A = infoLlt.matrixL().solve(J.transpose());
+  const Eigen::MatrixXd M = Eigen::MatrixXd::Identity(J.rows(), J.rows()) + w * A.transpose() * A;
+  return 2 * Eigen::LLT<Eigen::MatrixXd>(M).matrixLLT().diagonal().array().log().sum();
+}
+}
+
+std::vector<size_t> selectMostInformative(const std::vector<Eigen::MatrixXd> & jacobians, const std::vector<double> & weights, size_t budget, const std::vector<size_t> & preselected, double regularization) {
+  CHECK_EQ(jacobians.size(), weights.size());
+  CHECK_GT(regularization, 0);
+  const size_t n = jacobians.size();
+  std::vector<size_t> selected;
+  if(budget >= n){
+    for(size_t i = 0; i < n; i++){
+      selected.push_back(i);
+    }
+    return selected;
+  }
+
+  std::vector<bool> isSelected(n, false);
+  for(size_t i : preselected){
+    CHECK_LT(i, n);
+    if(!isSelected[i]){
+      isSelected[i] = true;
+      selected.push_back(i);
+    }
+  }
+  if(selected.size() >= budget){
+    std::sort(selected.begin(), selected.end());
+    return selected;
+  }
+
+  int dim = 0;
+  for(auto & J : jacobians){
+    if(J.rows() > 0){
+      dim = J.cols();
+      break;
+    }
+  }
+  if(dim == 0){
+    std::vector<size_t> remaining;
+    for(size_t i = 0; i < n; i++){
+      if(!isSelected[i]){
+        remaining.push_back(i);
+      }
+    }
+    const size_t numMissing = budget - selected.size();
+    for(size_t k = 0; k < numMissing; k++){
+      selected.push_back(remaining[(2 * k + 1) * remaining.size() / (2 * numMissing)]);
+    }
+    std::sort(selected.begin(), selected.end());
+    return selected;
+  }
+
+  Eigen::MatrixXd information = Eigen::MatrixXd::Identity(dim, dim) * regularization;
+  for(size_t i : selected){
+    if(jacobians[i].rows() > 0){
+      information += weights[i] * jacobians[i].transpose() * jacobians[i];
+    }
+  }
+  Eigen::LLT<Eigen::MatrixXd> informationLlt(information);
+
+  struct Candidate {
+    double gain;
+    size_t index;
+    size_t round;
+    bool operator < (const Candidate & other) const {
+      return gain < other.gain || (gain == other.gain && index > other.index);
+    }
+  };
+  std::priority_queue<Candidate> queue;
+  const size_t numPreselected = selected.size();
+  for(size_t i = 0; i < n; i++){
+    CHECK(jacobians[i].rows() == 0 || jacobians[i].cols() == dim) << "Inconsistent Jacobian of candidate " << i;
+    if(!isSelected[i]){
+      queue.push({computeLogDetGain(informationLlt, jacobians[i], weights[i]), i, numPreselected});
+    }
+  }
+
+  while(selected.size() < budget && !queue.empty()){
+    Candidate c = queue.top();
+    queue.pop();
+    if(c.round != selected.size()){
+      c.gain = computeLogDetGain(informationLlt, jacobians[c.index], weights[c.index]);
+      c.round = selected.size();
+      queue.push(c);
+      continue;
+    }
+    selected.push_back(c.index);
+    if(jacobians[c.index].rows() > 0){
+      information += weights[c.index] * jacobians[c.index].transpose() * jacobians[c.index];
+      informationLlt.compute(information);
+    }
+  }
+  std::sort(selected.begin(), selected.end());
+  return selected;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
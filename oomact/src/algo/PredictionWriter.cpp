@@ -7,6 +7,7 @@
 #include "aslam/calibration/tools/tools.h"
 
 #include "aslam/calibration/error-terms/ErrorTermPose.h"
+#include "aslam/calibration/error-terms/ErrorTermWheelPair.h"
 
 namespace aslam {
 namespace calibration {
@@ -20,6 +21,10 @@ void outMeasurementsAndPredictions(Timestamp timestamp, const ErrorTermPose & e,
   outPred << timestamp << " " << e.getPrediction().transpose(); outPred << std::endl;
   outMeasure << timestamp << " " << e.getMeasurement().transpose(); outMeasure << std::endl;
 }
+void outMeasurementsAndPredictions(Timestamp timestamp, const ErrorTermWheelPair & e, std::ostream & outPred, std::ostream & outMeasure){
+  outPred << timestamp << " " << e.getPrediction().transpose(); outPred << std::endl;
+  outMeasure << timestamp << " " << e.getMeasurement().transpose(); outMeasure << std::endl;
+}
 void outMeasurementsAndPredictions(Timestamp /* timestamp */, const backend::ErrorTerm & /* e */, std::ostream &/* outPred */, std::ostream &/* outMeasure */){
 }
 void outMeasurementsAndPredictions(Timestamp timestamp, const MeasurementErrorTerm<1, aslam::backend::ScalarExpression> & e, std::ostream &outPred, std::ostream &outMeasure){
@@ -0,0 +1,123 @@
+#include <aslam/calibration/algo/SchurComplementSolver.h>
+
+#include <Eigen/Cholesky>
+#include <Eigen/SparseCholesky>
+#include <glog/logging.h>
+
+namespace aslam {
+namespace calibration {
+
+SchurComplementSolver::SchurComplementSolver(int dimState, int dimCalibration) :
+  dimState_(dimState),
+  dimCalibration_(dimCalibration)
+{
+  CHECK_GE(dimState, 0);
+  CHECK_GE(dimCalibration, 0);
+  clear();
+}
+
+void SchurComplementSolver::clear() {
+  stateTriplets_.clear();
+  stateCalibrationTriplets_.clear();
+  H_cc_.setZero(dimCalibration_, dimCalibration_);
+  b_.setZero(dimState_ + dimCalibration_);
+}
+
+void SchurComplementSolver::addToHessian(int row, int col, const Eigen::MatrixXd & block) {
+  if(row >= dimState_){
+    if(col >= dimState_){
+      H_cc_.block(row - dimState_, col - dimState_, block.rows(), block.cols()) += block;
+    }
+    // The calibration x state blocks are covered by their transposed counterparts.
+    return;
+  }
+  auto & triplets = col >= dimState_ ? stateCalibrationTriplets_ : stateTriplets_;
+  const int colOffset = col >= dimState_ ? col - dimState_ : col;
+  for(int c = 0; c < block.cols(); c++){
+    for(int r = 0; r < block.rows(); r++){
+      triplets.emplace_back(row + r, colOffset + c, block(r, c));
+    }
+  }
+}
+
+void SchurComplementSolver::addErrorTerm(const JacobianBlocks & jacobianBlocks, const Eigen::VectorXd & error) {
+  for(auto & i : jacobianBlocks){
+    CHECK_EQ(i.second.rows(), error.rows());
+    CHECK_LE(i.first + i.second.cols(), dimState_ + dimCalibration_);
+    b_.segment(i.first, i.second.cols()) -= i.second.transpose() * error;
+    for(auto & j : jacobianBlocks){
+      addToHessian(i.first, j.first, i.second.transpose() * j.second);
+    }
+  }
+}
+
+bool SchurComplementSolver::eliminateState(double lambda, Eigen::MatrixXd & S, Eigen::MatrixXd & X, Eigen::VectorXd & y) const {
+  S = H_cc_;
+  S.diagonal().array() += lambda;
+  if(dimState_ == 0){
+    X.resize(0, dimCalibration_);
+    y.resize(0);
+    return true;
+  }
+
+  Eigen::SparseMatrix<double> H_ss(dimState_, dimState_);
+  H_ss.setFromTriplets(stateTriplets_.begin(), stateTriplets_.end());
+  for(int i = 0; i < dimState_; i++){
+    H_ss.coeffRef(i, i) += lambda;
+  }
+
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> stateLdlt(H_ss);
+  if(stateLdlt.info() != Eigen::Success){
+    LOG(WARNING) << "Factorization of the state block failed!";
+    return false;
+  }
+  y = stateLdlt.solve(b_.head(dimState_));
+
+  Eigen::SparseMatrix<double> H_sc(dimState_, dimCalibration_);
+  H_sc.setFromTriplets(stateCalibrationTriplets_.begin(), stateCalibrationTriplets_.end());
+  X = stateLdlt.solve(Eigen::MatrixXd(H_sc)); // H_ss^-1 H_sc
+  S.noalias() -= H_sc.transpose() * X;
+  return true;
+}
+
+bool SchurComplementSolver::solve(double lambda, Eigen::VectorXd & dx) const {
+  Eigen::MatrixXd S, X;
+  Eigen::VectorXd y;
+  if(!eliminateState(lambda, S, X, y)){
+    return false;
+  }
+  dx.resize(dimState_ + dimCalibration_);
+  if(dimCalibration_ == 0){
+    dx = y;
+    return true;
+  }
+
+  Eigen::LDLT<Eigen::MatrixXd> schurLdlt(S);
+  if(schurLdlt.info() != Eigen::Success){
+    LOG(WARNING) << "Factorization of the Schur complement failed!";
+    return false;
+  }
+  // b_c - H_cs y = b_c - X^T b_s because H_ss is symmetric.
+  const Eigen::VectorXd dx_c = schurLdlt.solve(b_.tail(dimCalibration_) - X.transpose() * b_.head(dimState_));
+  dx.head(dimState_) = y - X * dx_c;
+  dx.tail(dimCalibration_) = dx_c;
+  return true;
+}
+
+bool SchurComplementSolver::computeCalibrationCovariance(Eigen::MatrixXd & covariance) const {
+  Eigen::MatrixXd S, X;
+  Eigen::VectorXd y;
+  if(!eliminateState(0, S, X, y)){
+    return false;
+  }
+  Eigen::LDLT<Eigen::MatrixXd> schurLdlt(S);
+  if(schurLdlt.info() != Eigen::Success || !schurLdlt.isPositive()){
+    LOG(WARNING) << "The Schur complement is not positive definite. The calibration variables are not fully observable!";
+    return false;
+  }
+  covariance = schurLdlt.solve(Eigen::MatrixXd::Identity(dimCalibration_, dimCalibration_));
+  return true;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -1,8 +1,11 @@
 #include "aslam/calibration/calibrator/AbstractCalibrator.h"
 
+#include <algorithm>
 #include <chrono>
+#include <exception>
 #include <functional>
 #include <map>
+#include <mutex>
 
 #include <glog/logging.h>
 #include <sm/MatrixArchive.hpp>
@@ -11,6 +14,7 @@
 #include <aslam/calibration/calibrator/CalibrationConfI.h>
 
 #include <aslam/calibration/calibrator/CalibrationProblem.h>
+#include <aslam/calibration/calibrator/ModelAtTimeCache.h>
 #include <aslam/calibration/DesignVariableReceiver.h>
 #include <aslam/calibration/model/Model.h>
 #include <aslam/calibration/calibrator/StateCarrier.h>
@@ -26,7 +30,23 @@ template class ModuleLink<Sensor>;
 
 // TODO C move CalibratorI::getModelAt to a more suitable place
 aslam::calibration::ModelAtTime CalibratorI::getModelAt(const Sensor& sensor, Timestamp time, int maximalDerivativeOrder, const ModelSimplification& simplification) const {
-  return sensor.hasDelay() ? getModelAt(sensor.getBoundedTimestampExpression(*this, time), maximalDerivativeOrder, simplification) : getModelAt(time, maximalDerivativeOrder, simplification);
+  if(!sensor.isDelayActive()){
+    // A fixed delay yields a constant time. That saves the segment search for the moving time on every evaluation and shares the cache with all other users of that time.
+    return getModelAt(time - sensor.getDelay(), maximalDerivativeOrder, simplification);
+  }
+  auto create = [&](){ return getModelAt(sensor.getBoundedTimestampExpression(*this, time), maximalDerivativeOrder, simplification); };
+  if(auto cache = getModelAtTimeCache()){
+    return cache->get({time, simplification, static_cast<const DelayCv*>(&sensor)}, maximalDerivativeOrder, create);
+  }
+  return create();
+}
+
+aslam::calibration::ModelAtTime CalibratorI::getModelAt(Timestamp time, int maximalDerivativeOrder, const ModelSimplification& simplification) const {
+  auto create = [&](){ return getModel().getAtTime(time, maximalDerivativeOrder, simplification); };
+  if(auto cache = getModelAtTimeCache()){
+    return cache->get({time, simplification}, maximalDerivativeOrder, create);
+  }
+  return create();
 }
 
 AbstractCalibratorOptions::AbstractCalibratorOptions(const sm::value_store::ValueStoreRef& config) :
@@ -34,7 +54,8 @@ AbstractCalibratorOptions::AbstractCalibratorOptions(const sm::value_store::Valu
     verbose(config.getBool("verbose", false)),
     acceptConstantErrorTerms(config.getBool("acceptConstantErrorTerms", true)),
     splineOutputSamplePeriod(config.getDouble("splineOutputSamplePeriod", 0.01)),
-    numThreads(config.getInt("numThreads", 1))
+    numThreads(config.getInt("numThreads", 1)),
+    cacheModelAtTime(config.getBool("cacheModelAtTime", false))
 {
   if(acceptConstantErrorTerms){
     LOG(INFO)<< "Using acceptConstantErrorTerms = true";
@@ -60,6 +81,9 @@ AbstractCalibrator::AbstractCalibrator(ValueStoreRef config, std::shared_ptr<Mod
   }
 }
 
+AbstractCalibrator::~AbstractCalibrator() {
+}
+
 
 bool AbstractCalibrator::initStates(){
   for(Module & m : getModel().getModules()){
@@ -87,6 +111,7 @@ void AbstractCalibrator::setLowestTimestamp(Timestamp lowestTimestamp) {
 
 std::shared_ptr<PredictionFunctorWriter> AbstractCalibrator::createPredictionCollector(const std::string & name){
   auto pd = std::make_shared<PredictionFunctorWriter>(name);
+  std::lock_guard<std::mutex> lock(_predictionDataMutex);
   _predictionData.push_back(pd);
   return pd;
 }
@@ -128,6 +153,21 @@ void AbstractCalibrator::setCalibrationVariablesActivity(const CalibrationConfI&
   for (Module& m : getModel().getModules()) {
     m.setCalibrationActive(ec);
   }
+  getModel().updateConstantLinks();
+}
+
+AbstractCalibrator::ProblemDependencies AbstractCalibrator::getProblemDependencies(const CalibrationConfI& ec) const {
+  ProblemDependencies d;
+  for(const auto & cv : getModel().getCalibrationVariables()){
+    d.calibrationVariableActivity.push_back(cv->isActivated());
+  }
+  for(const Module & m : getModel().getModules()){
+    d.stateActivity.push_back(!m.isA<Activatable>() || ec.getStateActivator().isActive(m.as<Activatable>()));
+    d.observeOnly.push_back(m.shouldObserveOnly(ec));
+    d.numMeasurements.push_back(m.getNumMeasurements(getCurrentStorage()));
+  }
+  d.constantLinkValues = getModel().getConstantLinkValues();
+  return d;
 }
 
 
@@ -188,14 +228,106 @@ void AbstractCalibrator::addMeasurementTimestamp(Timestamp t, const Sensor & sen
   }
 }
 
+namespace {
+/// Collects error terms of one module while it is being processed by a worker thread.
+class ErrorTermBuffer : public backend::ErrorTermReceiver {
+ public:
+  void addErrorTerm(const boost::shared_ptr<backend::ErrorTerm> & et) override {
+    errorTerms.push_back(et);
+  }
+
+  void passTo(backend::ErrorTermReceiver & receiver) {
+    for(auto & et : errorTerms){
+      receiver.addErrorTerm(et);
+    }
+    errorTerms.clear();
+  }
+ private:
+  std::vector<boost::shared_ptr<backend::ErrorTerm>> errorTerms;
+};
+}
+
+ModelAtTimeCache * AbstractCalibrator::getModelAtTimeCache() const {
+  return _modelAtTimeCacheActive ? _modelAtTimeCache.get() : nullptr;
+}
+
 void AbstractCalibrator::addFactors(const CalibrationConfI& estimationConfig, ErrorTermReceiver & problem, std::function<void()> statusCallback) {
-  for(Module & m : getModel().getModules()){
-    LOG(INFO) << "Adding module " << m.getName() << "'s error terms.";
-    m.addErrorTerms(*this, getCurrentStorage(), estimationConfig, problem);
+  if(!getOptions().getCacheModelAtTime()){
+    addModuleErrorTerms(estimationConfig, problem, statusCallback);
+    return;
+  }
+
+  // The cached models are only valid while the design variables stay the same. Hence, the cache is only used while the error terms are being built.
+  if(!_modelAtTimeCache){
+    _modelAtTimeCache.reset(new ModelAtTimeCache);
+  }
+  struct CacheActivation {
+    AbstractCalibrator & c;
+    CacheActivation(AbstractCalibrator & c) : c(c) {
+      c._modelAtTimeCache->resetStatistics();
+      c._modelAtTimeCacheActive = true;
+    }
+    ~CacheActivation() {
+      c._modelAtTimeCacheActive = false;
+      c._modelAtTimeCacheStatistics = c._modelAtTimeCache->getStatistics();
+      c._modelAtTimeCache->clear();
+    }
+  } activation(*this);
+  addModuleErrorTerms(estimationConfig, problem, statusCallback);
+  LOG(INFO) << "ModelAtTime cache: " << _modelAtTimeCache->size() << " models, " << _modelAtTimeCache->getHits() << " hits, " << _modelAtTimeCache->getMisses() << " misses (hit rate " << _modelAtTimeCache->getHitRate() << ").";
+}
+
+ModelAtTimeCacheStatistics AbstractCalibrator::getModelAtTimeCacheStatistics() const {
+  return _modelAtTimeCacheStatistics;
+}
+
+void AbstractCalibrator::addModuleErrorTerms(const CalibrationConfI& estimationConfig, ErrorTermReceiver & problem, std::function<void()> statusCallback) {
+  const int numThreads = getOptions().getNumThreads();
+  if(numThreads <= 1){
+    for(Module & m : getModel().getModules()){
+      LOG(INFO) << "Adding module " << m.getName() << "'s error terms.";
+      m.addErrorTerms(*this, getCurrentStorage(), estimationConfig, problem);
+      statusCallback();
+    }
+    return;
+  }
+
+  // Every module builds its error terms into its own buffer. The buffers are merged in module order afterwards to keep the problem independent of the thread scheduling.
+  const auto & modules = getModel().getModules();
+  std::vector<ErrorTermBuffer> buffers(modules.size());
+  std::vector<std::exception_ptr> exceptions(modules.size());
+  {
+    LOG(INFO) << "Adding error terms of " << modules.size() << " modules using " << numThreads << " threads.";
+    ThreadPool & pool = getThreadPool();
+    pool.resetStatistics();
+    pool.parallelFor(0, modules.size(), [&](size_t i){
+      try {
+        modules[i].get().addErrorTerms(*this, getCurrentStorage(), estimationConfig, buffers[i]);
+      } catch (...) {
+        exceptions[i] = std::current_exception();
+      }
+    }, 1);
+    LOG_IF(INFO, getOptions().getVerbose()) << "Adding error terms: " << pool.getStatistics();
+  }
+
+  for(size_t i = 0; i < modules.size(); i++){
+    if(exceptions[i]){
+      LOG(ERROR) << "Failed to add module " << modules[i].get().getName() << "'s error terms.";
+      std::rethrow_exception(exceptions[i]);
+    }
+    LOG(INFO) << "Adding module " << modules[i].get().getName() << "'s error terms.";
+    buffers[i].passTo(problem);
     statusCallback();
   }
 }
 
+ThreadPool & AbstractCalibrator::getThreadPool() const {
+  std::call_once(_threadPoolCreated, [this](){
+    _threadPool.reset(new ThreadPool(std::max(1, getOptions().getNumThreads())));
+  });
+  return *_threadPool;
+}
+
 ValueStoreRef AbstractCalibrator::getValueStore() const {
   return _config;
 }
@@ -208,6 +340,14 @@ const char* getActivityPrefix(const CalibrationVariable& cv);
 
 void AbstractCalibrator::printBatchErrorTermStatistics(const CalibrationProblem& batch, bool updateError, std::ostream& out) {
   sm::timing::Timer t("printBatchErrorTermStatistics");
+  if(updateError){
+    // Evaluate every error term once and concurrently. The statistics below only read the stored errors.
+    const auto & errorTerms = batch.getErrorTerms();
+    getThreadPool().parallelFor(0, errorTerms.size(), [&](size_t i){
+      errorTerms[i]->evaluateError();
+    });
+    updateError = false;
+  }
   //TODO B order by error!
   out << "Error term statistics:" << std::endl;
   std::map<std::reference_wrapper<const ErrorTermGroup>, ErrorTermStatistics> etgs;
@@ -277,6 +417,22 @@ void AbstractCalibrator::updateOptimizerInspector(const CalibrationProblem &  cu
     });
 }
 
+namespace {
+class StateVariableReceiver : public DesignVariableReceiver {
+ public:
+  StateVariableReceiver(CalibrationProblem & problem) : problem_(problem) {}
+
+  void addDesignVariable(backend::DesignVariable * dv) override {
+    problem_.addStateVariable(dv);
+  }
+  void addTimedDesignVariable(backend::DesignVariable * dv, double time) override {
+    problem_.addStateVariable(dv, time);
+  }
+ private:
+  CalibrationProblem & problem_;
+};
+}
+
 void AbstractCalibrator::estimate(const CalibrationConfI & estimationConfig, CalibrationProblem & problem, BatchStateReceiver & batchStateReceiver, std::function<void()> optimize) {
   using sm::timing::Timer;
 
@@ -293,6 +449,7 @@ void AbstractCalibrator::estimate(const CalibrationConfI & estimationConfig, Cal
   }
 
   setCalibrationVariablesActivity(estimationConfig);
+  _problemDependencies = getProblemDependencies(estimationConfig);
 
   ValueObserver dimCalibObserver, dimStateObserver, numErrorTermsObserver;
 
@@ -322,14 +479,7 @@ void AbstractCalibrator::estimate(const CalibrationConfI & estimationConfig, Cal
 
     logGroupDimsAndErrorNum();
 
-    if(estimationConfig.getUseCalibPriors()){
-      getModel().addCalibPriors(problem);
-      logGroupDimsAndErrorNum();
-    }
-
-    auto stateVariableReceiver = createFunctorDesignVariableReceiver([&](backend::DesignVariable* dv) {
-          problem.addStateVariable(dv);
-        });
+    StateVariableReceiver stateVariableReceiver(problem);
 
     for(Module & m : getModel().getModules()){
       if(m.isUsed()){
@@ -340,6 +490,13 @@ void AbstractCalibrator::estimate(const CalibrationConfI & estimationConfig, Cal
     }
 
     getModel().updateCVIndices();
+    problem.arrangeDesignVariables();
+
+    // Only now, as error terms must not be added before the design variables are arranged.
+    if(estimationConfig.getUseCalibPriors()){
+      getModel().addCalibPriors(problem);
+      logGroupDimsAndErrorNum();
+    }
   }
 
   {
@@ -358,5 +515,30 @@ void AbstractCalibrator::estimate(const CalibrationConfI & estimationConfig, Cal
   clearAfterEstimation();
 }
 
+bool AbstractCalibrator::reestimate(const CalibrationConfI & estimationConfig, CalibrationProblem & problem, std::function<void()> optimize) {
+  setCalibrationVariablesActivity(estimationConfig);
+  if(!(getProblemDependencies(estimationConfig) == _problemDependencies)){
+    LOG(INFO) << "The activity, the measurements or the constant links changed since the problem was built.";
+    return false;
+  }
+
+  estimationConfig.print(LOG(INFO) << "Optimizing again");
+  if(_statusUpdateHandler){
+    std::stringstream ss;
+    estimationConfig.print(ss);
+    _statusUpdateHandler(ss.str());
+  }
+  getModel().updateCVIndices();
+
+  if(problem.getNumErrorTerms() == 0){
+    LOG(WARNING) << "Not estimating because there are no error terms!";
+  } else {
+    optimize();
+  }
+
+  clearAfterEstimation();
+  return true;
+}
+
 } /* namespace calibration */
 } /* namespace aslam */
@@ -0,0 +1,64 @@
+#include <aslam/calibration/calibrator/BatchCalibrationProblem.h>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+namespace aslam {
+namespace calibration {
+
+void BatchCalibrationProblem::arrangeDesignVariables() {
+  if(!timeSortedOrdering_){
+    return;
+  }
+  CHECK_EQ(0u, problem_.numErrorTerms()) << "The design variables must be arranged before any error term is added!";
+
+  std::vector<size_t> order(stateDesignVariables_.size());
+  std::iota(order.begin(), order.end(), 0);
+  // Untimed state variables have infinite time and therefore end up after the timed ones.
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b){
+    return stateDesignVariableTimes_[a] < stateDesignVariableTimes_[b];
+  });
+
+  sortedStateDesignVariables_.clear();
+  for(size_t i : order){
+    sortedStateDesignVariables_.push_back(stateDesignVariables_[i]);
+    addToProblem(stateDesignVariables_[i]);
+  }
+  for(auto dv : calibrationDesignVariables_){
+    addToProblem(dv);
+  }
+}
+
+std::pair<size_t, size_t> BatchCalibrationProblem::getStateBandwidths() const {
+  return {computeBandwidth(stateDesignVariables_, getErrorTerms()), computeBandwidth(getStateDesignVariables(), getErrorTerms())};
+}
+
+size_t computeBandwidth(const std::vector<backend::DesignVariable*> & ordering, const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms) {
+  std::unordered_map<const backend::DesignVariable*, size_t> columns;
+  size_t column = 0;
+  for(auto dv : ordering){
+    columns.emplace(dv, column);
+    column += dv->minimalDimensions();
+  }
+
+  size_t bandwidth = 0;
+  for(auto & et : errorTerms){
+    size_t minColumn = std::numeric_limits<size_t>::max(), maxColumn = 0;
+    for(size_t i = 0; i < et->numDesignVariables(); i++){
+      const backend::DesignVariable * dv = et->designVariable(i);
+      auto it = columns.find(dv);
+      if(it != columns.end()){
+        minColumn = std::min(minColumn, it->second);
+        maxColumn = std::max(maxColumn, it->second + dv->minimalDimensions());
+      }
+    }
+    if(minColumn < maxColumn){
+      bandwidth = std::max(bandwidth, maxColumn - minColumn);
+    }
+  }
+  return bandwidth;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -3,12 +3,22 @@
 #include <aslam/backend/Optimizer2.hpp>
 #include <aslam/backend/SparseCholeskyLinearSystemSolver.hpp>
 #include <sm/BoostPropertyTree.hpp>
+#include <sm/MatrixArchive.hpp>
+#include <sm/assert_macros.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <aslam/calibration/calibrator/AbstractCalibrator.h>
 #include "aslam/calibration/calibrator/CalibratorI.h"
-#include <aslam/calibration/calibrator/CalibrationProblem.h>
+#include <aslam/calibration/calibrator/BatchCalibrationProblem.h>
+#include <aslam/calibration/calibrator/DesignVariableSnapshot.h>
+#include <aslam/calibration/calibrator/SchurComplementOptimizer.h>
 #include <aslam/calibration/calibrator/SimpleModuleStorage.h>
 #include <aslam/calibration/data/MapStorage.h>
+#include <aslam/calibration/model/CalibrationVariable.h>
 #include <aslam/calibration/calibrator/StateCarrier.h>
 #include <aslam/calibration/model/Sensor.h>
 #include <sm/boost/null_deleter.hpp>
@@ -17,7 +27,58 @@ namespace aslam {
 namespace calibration {
 
 class BatchCalibratorOptions : public AbstractCalibratorOptions {
-  using AbstractCalibratorOptions::AbstractCalibratorOptions;
+ public:
+  BatchCalibratorOptions(const sm::value_store::ValueStoreRef& config) :
+    AbstractCalibratorOptions(config),
+    useSchurComplementSolver(config.getString("estimator/solver", "sparseCholesky") == "schurComplement"),
+    reuseProblem(config.getBool("reuseProblem", false)),
+    timeSortedOrdering(config.getBool("estimator/timeSortedOrdering", false)),
+    useCalibPriors(config.getBool("useCalibPriors", false)),
+    computeCovariances(config.getBool("estimator/computeCovariances", false))
+  {
+    const std::string solver = config.getString("estimator/solver", "sparseCholesky");
+    SM_ASSERT_TRUE(std::runtime_error, solver == "sparseCholesky" || solver == "schurComplement", "Unknown estimator/solver '" + solver + "'! Supported are sparseCholesky and schurComplement.");
+  }
+
+  bool getUseSchurComplementSolver() const {
+    return useSchurComplementSolver;
+  }
+
+  /**
+   * Keep the problem and its error terms to only reset the design variables and rerun the optimizer in the next calibrate() on the same batch interval.
+   * The problem gets rebuilt nevertheless if the activity of the variables or error terms or the number of measurements changed.
+   */
+  bool getReuseProblem() const {
+    return reuseProblem;
+  }
+  void setReuseProblem(bool reuseProblem) {
+    this->reuseProblem = reuseProblem;
+  }
+
+  /// Order the state design variables by time and put the calibration variables last.
+  bool getTimeSortedOrdering() const {
+    return timeSortedOrdering;
+  }
+
+  /// Add a prior error term for every active calibration variable at its value before the calibration.
+  bool getUseCalibPriors() const {
+    return useCalibPriors;
+  }
+
+  /// Compute the calibration variables' marginal covariances after each calibration.
+  bool getComputeCovariances() const {
+    return computeCovariances;
+  }
+  void setComputeCovariances(bool computeCovariances) {
+    this->computeCovariances = computeCovariances;
+  }
+
+ private:
+  bool useSchurComplementSolver;
+  bool reuseProblem;
+  bool timeSortedOrdering;
+  bool useCalibPriors;
+  bool computeCovariances;
 };
 
 class BatchCalibrationConf : public CalibrationConfI {
@@ -79,71 +140,6 @@ class BatchCalibrationConf : public CalibrationConfI {
   bool useCalibPriors_ = false;
 };
 
-class BatchCalibrationProblem : public CalibrationProblem, public BatchStateReceiver {
- public:
-  BatchCalibrationProblem() :
-    problemSp_(new backend::OptimizationProblem()),
-    problem_(*problemSp_)
-  {
-  }
-
-  virtual ~BatchCalibrationProblem() {}
-
-  void addCalibrationVariable(CalibrationVariable* c) override {
-    CHECK_NOTNULL(c);
-    dimCalibVariables_ += c->getDesignVariable().minimalDimensions();
-    problem_.addDesignVariable(aslam::backend::DesignVariable::Ptr(&c->getDesignVariable(), sm::null_deleter()));
-  }
-
-  void addStateVariable(backend::DesignVariable* s) override {
-    CHECK_NOTNULL(s);
-    dimStateVariables_ += s->minimalDimensions();
-    problem_.addDesignVariable(aslam::backend::DesignVariable::Ptr(s, sm::null_deleter()));
-  }
-
-  size_t getDimCalibrationVariables() const override {
-    return dimCalibVariables_;
-  }
-  size_t getDimStateVariables() const override {
-    return dimStateVariables_;
-  }
-  size_t getNumErrorTerms() const override {
-    return problem_.numErrorTerms();
-  }
-
-  void addErrorTerm(const boost::shared_ptr<aslam::backend::ErrorTerm> & et) override {
-    problem_.addErrorTerm(et);
-  }
-
-  void addBatchState(StateCarrier & /*stateCarrier*/, const BatchStateSP& /*batchState*/) override {
-
-  }
-
-  virtual const std::vector<boost::shared_ptr<backend::ErrorTerm>> & getErrorTerms() const override {
-    struct A : public backend::OptimizationProblem {
-      const std::vector<boost::shared_ptr<backend::ErrorTerm>> & getErrorTerms() const {
-        return _errorTerms;
-      }
-    };
-
-    return static_cast<A&>(problem_).getErrorTerms();
-  }
-
-  virtual void getErrors(const backend::DesignVariable* dv, std::set<backend::ErrorTerm*>& outErrorSet) const override {
-    problem_.getErrors(dv, outErrorSet);
-  }
-
-  const boost::shared_ptr<backend::OptimizationProblem>& getProblemSp() const {
-    return problemSp_;
-  }
-
- private:
-  boost::shared_ptr<backend::OptimizationProblem> problemSp_;
-  backend::OptimizationProblem & problem_;
-
-  size_t dimCalibVariables_ = 0, dimStateVariables_ = 0;
-};
-
 class BatchCalibrator : public virtual BatchCalibratorI, public AbstractCalibrator {
  public:
   BatchCalibrator (ValueStoreRef config, std::shared_ptr<Model> model) :
@@ -158,35 +154,79 @@ class BatchCalibrator : public virtual BatchCalibratorI, public AbstractCalibrat
     LOG(INFO) << "Before calibration:" << std::endl << getModel() << std::endl;
     LOG(INFO) << "Staring calibration in interval " << secsSinceStart(getCurrentEffectiveBatchInterval());
 
-    for(Module & m : getModel().getModules()){
-      m.preProcessNewWindow(*this);
+    BatchCalibrationConf estConf(*this);
+    estConf.setUseCalibPriors(options_.getUseCalibPriors());
+
+    bool reused = false;
+    if(problem_ && options_.getReuseProblem() && problemInterval_.start == _currentEffectiveBatchInterval.start && problemInterval_.end == _currentEffectiveBatchInterval.end){
+      LOG(INFO) << "Reusing the problem of the previous calibration.";
+      initialValues_.restore();
+      reused = reestimate(estConf, *problem_, [&](){ optimize(*problem_); });
+      LOG_IF(INFO, !reused) << "Rebuilding the problem instead.";
     }
-    if(!initStates()){
-      LOG(FATAL) << "initStates failed";
-      return;
+    if(!reused){
+      problem_.reset(); // release the old state before it gets replaced by initStates
+      initialValues_.clear();
+
+      for(Module & m : getModel().getModules()){
+        m.preProcessNewWindow(*this);
+      }
+      if(!initStates()){
+        LOG(FATAL) << "initStates failed";
+        return;
+      }
+
+      problem_.reset(new BatchCalibrationProblem(options_.getTimeSortedOrdering()));
+      problemInterval_ = _currentEffectiveBatchInterval;
+      estimate(estConf, *problem_, *problem_, [&](){
+        if(options_.getReuseProblem()){
+          storeInitialValues(*problem_);
+        }
+        optimize(*problem_);
+      });
     }
 
-    BatchCalibrationConf estConf(*this);
-    BatchCalibrationProblem problem;
-
-    estimate(estConf, problem, problem, [&](){
-      boost::shared_ptr<backend::LinearSystemSolver> linearSystemSolver(new aslam::backend::SparseCholeskyLinearSystemSolver());
-      linearSystemSolver->setAcceptConstantErrorTerms(options_.getAcceptConstantErrorTerms());
-
-      aslam::backend::Optimizer2 opt(config_.getChild("estimator/optimizer").asPropertyTree(), linearSystemSolver, boost::make_shared<backend::LevenbergMarquardtTrustRegionPolicy>(100));
-      updateOptimizerInspector(problem, false, [&](std::ostream &out){
-          out << "The Jacobian matrix is: " << linearSystemSolver->JRows()<< " x " << linearSystemSolver->JCols();
-      }, opt.callback());
-      opt.setProblem(problem.getProblemSp());
-      opt.options().verbose = false;
-      LOG(INFO) << "Optimizer options for batch estimation:" << opt.getOptions();
-      opt.optimize();
-      LOG(INFO) << "Final "<< opt.getStatus();
-    });
+    if(!options_.getReuseProblem()){
+      problem_.reset();
+    }
 
     getModel().printCalibrationVariables(LOG(INFO) << "After calibration:" << std::endl) << std::endl;
   }
 
+  std::pair<size_t, size_t> getStateBandwidths() const override {
+    return stateBandwidths_;
+  }
+
+  size_t getNumErrorTerms() const override {
+    return numErrorTerms_;
+  }
+
+  Eigen::MatrixXd getMarginalCovariance(const CalibrationVariable & cv) const override {
+    auto it = covariances_.find(&cv.getDesignVariable());
+    return it == covariances_.end() ? Eigen::MatrixXd() : it->second;
+  }
+
+  void addToArchive(sm::MatrixArchive & archive, bool append = false) const override {
+    AbstractCalibrator::addToArchive(archive, append);
+    for(const auto & c: getModel().getCalibrationVariables()){
+      Eigen::MatrixXd cov = getMarginalCovariance(*c);
+      if(cov.size() == 0){
+        continue;
+      }
+      // Stored column wise like the values to support appending.
+      const Eigen::VectorXd v = Eigen::Map<const Eigen::VectorXd>(cov.data(), cov.size());
+      const std::string name = c->getName() + "_cov";
+      if(!append || archive.find(name) == archive.end()){
+        archive.setMatrix(name, v);
+      }else{
+        Eigen::MatrixXd & old = archive.getMatrix(name);
+        Eigen::MatrixXd M = old;
+        old.resize(v.rows(), M.cols() + 1);
+        old << M, v;
+      }
+    }
+  }
+
   BatchCalibratorOptions& getOptions() {
     return options_;
   }
@@ -233,9 +273,76 @@ class BatchCalibrator : public virtual BatchCalibratorI, public AbstractCalibrat
   }
 
  private:
+  void optimize(BatchCalibrationProblem & problem) {
+    // Computing the bandwidths takes two passes over all error terms. They only matter for the time sorted ordering.
+    if(options_.getTimeSortedOrdering()){
+      stateBandwidths_ = problem.getStateBandwidths();
+      LOG(INFO) << "Bandwidth of the state block: " << stateBandwidths_.first << " in insertion order, " << stateBandwidths_.second << " in time sorted order.";
+    } else {
+      stateBandwidths_ = {0, 0};
+    }
+
+    numErrorTerms_ = problem.getNumErrorTerms();
+    covariances_.clear();
+    optimizeProblem(problem);
+
+    if(options_.getComputeCovariances()){
+      if(!computeCalibrationVariableCovariances(problem.getStateDesignVariables(), problem.getCalibrationDesignVariables(), problem.getErrorTerms(), covariances_)){
+        LOG(WARNING) << "Could not compute the calibration variables' marginal covariances!";
+      } else if(getOptions().getVerbose()){
+        for(const auto & c: getModel().getCalibrationVariables()){
+          LOG_IF(INFO, covariances_.count(&c->getDesignVariable())) << "Marginal covariance of " << c->getName() << ":\n" << covariances_.at(&c->getDesignVariable());
+        }
+      }
+    }
+  }
+
+  void optimizeProblem(BatchCalibrationProblem & problem) {
+    if(options_.getUseSchurComplementSolver()){
+      SchurComplementOptimizer opt(config_.getChild("estimator/schurComplement"));
+      auto status = opt.optimize(problem.getStateDesignVariables(), problem.getCalibrationDesignVariables(), problem.getErrorTerms(), [this](){
+        if(getOptions().getVerbose()){
+          getModel().printCalibrationVariables(LOG(INFO) << "Optimizer: Variables updated:" << std::endl);
+        }
+        if(_calibrationUpdateHandler){
+          _calibrationUpdateHandler();
+        }
+      });
+      LOG(INFO) << "Final " << status;
+      return;
+    }
+
+    boost::shared_ptr<backend::LinearSystemSolver> linearSystemSolver(new aslam::backend::SparseCholeskyLinearSystemSolver());
+    linearSystemSolver->setAcceptConstantErrorTerms(options_.getAcceptConstantErrorTerms());
+
+    aslam::backend::Optimizer2 opt(config_.getChild("estimator/optimizer").asPropertyTree(), linearSystemSolver, boost::make_shared<backend::LevenbergMarquardtTrustRegionPolicy>(100));
+    updateOptimizerInspector(problem, false, [&](std::ostream &out){
+        out << "The Jacobian matrix is: " << linearSystemSolver->JRows()<< " x " << linearSystemSolver->JCols();
+    }, opt.callback());
+    opt.setProblem(problem.getProblemSp());
+    opt.options().verbose = false;
+    LOG(INFO) << "Optimizer options for batch estimation:" << opt.getOptions();
+    opt.optimize();
+    LOG(INFO) << "Final "<< opt.getStatus();
+  }
+
+  void storeInitialValues(const BatchCalibrationProblem & problem) {
+    initialValues_.clear();
+    initialValues_.capture(problem.getCalibrationDesignVariables());
+    initialValues_.capture(problem.getStateDesignVariables());
+  }
+
   sm::value_store::ValueStoreRef config_;
   BatchCalibratorOptions options_;
   SimpleModuleStorage storage_;
+
+  /// The last problem. Only kept beyond calibrate() if options_.getReuseProblem().
+  std::unique_ptr<BatchCalibrationProblem> problem_;
+  Interval problemInterval_;
+  DesignVariableSnapshot initialValues_;
+  std::pair<size_t, size_t> stateBandwidths_;
+  size_t numErrorTerms_ = 0;
+  std::unordered_map<const backend::DesignVariable*, Eigen::MatrixXd> covariances_;
 };
 
 
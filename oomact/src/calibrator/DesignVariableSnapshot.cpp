@@ -0,0 +1,25 @@
+#include <aslam/calibration/calibrator/DesignVariableSnapshot.h>
+
+#include <glog/logging.h>
+#include <aslam/backend/DesignVariable.hpp>
+
+namespace aslam {
+namespace calibration {
+
+void DesignVariableSnapshot::capture(const std::vector<backend::DesignVariable*> & designVariables) {
+  values_.reserve(values_.size() + designVariables.size());
+  for(auto dv : designVariables){
+    CHECK_NOTNULL(dv);
+    values_.emplace_back(dv, Eigen::MatrixXd());
+    dv->getParameters(values_.back().second);
+  }
+}
+
+void DesignVariableSnapshot::restore() const {
+  for(auto & v : values_){
+    v.first->setParameters(v.second);
+  }
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
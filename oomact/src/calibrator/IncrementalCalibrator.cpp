@@ -0,0 +1,345 @@
+#include <aslam/backend/LevenbergMarquardtTrustRegionPolicy.hpp>
+#include <aslam/backend/Optimizer2.hpp>
+#include <aslam/backend/SparseCholeskyLinearSystemSolver.hpp>
+#include <sm/BoostPropertyTree.hpp>
+#include <sm/assert_macros.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <aslam/calibration/calibrator/AbstractCalibrator.h>
+#include "aslam/calibration/calibrator/CalibratorI.h"
+#include <aslam/calibration/calibrator/BatchCalibrationProblem.h>
+#include <aslam/calibration/calibrator/SimpleModuleStorage.h>
+#include <aslam/calibration/model/ModuleList.h>
+#include <aslam/calibration/model/Sensor.h>
+#include <sm/boost/null_deleter.hpp>
+
+namespace aslam {
+namespace calibration {
+
+class IncrementalCalibratorOptions : public AbstractCalibratorOptions {
+ public:
+  IncrementalCalibratorOptions(const sm::value_store::ValueStoreRef& config) :
+    AbstractCalibratorOptions(config),
+    windowDuration(config.getDouble("windowDuration", 10.0)),
+    minimalWindowDuration(config.getDouble("minimalWindowDuration", 0.0)),
+    windowOverlap(config.getDouble("windowOverlap", 0.0)),
+    useCalibPriors(config.getBool("useCalibPriors", false))
+  {
+    SM_ASSERT_GT(std::runtime_error, windowDuration, 0.0, "windowDuration must be positive");
+    SM_ASSERT_GE(std::runtime_error, windowOverlap, 0.0, "windowOverlap must not be negative");
+    SM_ASSERT_LT(std::runtime_error, windowOverlap, windowDuration, "windowOverlap must be shorter than windowDuration");
+  }
+
+  double getWindowDuration() const {
+    return windowDuration;
+  }
+  double getMinimalWindowDuration() const {
+    return minimalWindowDuration;
+  }
+  /// The duration of the end of a window whose measurements are used again at the beginning of the next window.
+  double getWindowOverlap() const {
+    return windowOverlap;
+  }
+  bool getUseCalibPriors() const {
+    return useCalibPriors;
+  }
+ private:
+  double windowDuration;
+  double minimalWindowDuration;
+  double windowOverlap;
+  bool useCalibPriors;
+};
+
+class IncrementalCalibrationConf : public CalibrationConfI {
+ public:
+  IncrementalCalibrationConf(IncrementalCalibratorI & calibrator, size_t windowIndex, bool useCalibPriors) : calibrator_(calibrator), windowIndex_(windowIndex), useCalibPriors_(useCalibPriors) {}
+
+  virtual ~IncrementalCalibrationConf() = default;
+
+  const Activator& getCalibrationActivator() const override {
+    return AllActiveActivator;
+  }
+
+  const Activator& getStateActivator() const override {
+    return AllActiveActivator;
+  }
+
+  const Activator& getErrorTermActivator() const override {
+    return AllActiveActivator;
+  }
+
+  bool isSpatialActive() const override {
+    return true;
+  }
+  bool isTemporalActive() const override {
+    return true;
+  }
+
+  std::string getOutputFolder(size_t /*segmentIndex*/ = 0) const override {
+    return "output/";
+  }
+
+  bool getUseCalibPriors() const override {
+    return useCalibPriors_;
+  }
+
+  void print(std::ostream & o) const override {
+    o << "IncrementalEstimationConfig(window=" << windowIndex_ << ", useCalibPriors=" << useCalibPriors_ << ")";
+  }
+
+  bool shouldSensorsBeRegistered(const Sensor & /*from*/, const Sensor & /*to*/) const override {
+    return true;
+  }
+  bool shouldAnySensorBeRegisteredTo(const Sensor & /*to*/) const override {
+    return true;
+  }
+
+  const IncrementalCalibratorI & getCalibrator() const override {
+    return calibrator_;
+  }
+  IncrementalCalibratorI & getCalibrator() override {
+    return calibrator_;
+  }
+
+ private:
+  IncrementalCalibratorI & calibrator_;
+  size_t windowIndex_;
+  bool useCalibPriors_;
+};
+
+/**
+ * Sliding window calibrator.
+ * Measurements are collected into the current window's storage until the time base sensor's timestamps span windowDuration.
+ * Then the window is estimated as one batch, starting from the calibration values of the previous window (they stay in the model).
+ * Every window gets its own ModuleStorage. The measurements of the last windowOverlap seconds are carried over into the next window's storage, all others are dropped.
+ */
+class IncrementalCalibrator : public virtual IncrementalCalibratorI, public AbstractCalibrator {
+ public:
+  IncrementalCalibrator (ValueStoreRef config, std::shared_ptr<Model> model) :
+    AbstractCalibrator(config, model, true),
+    config_(config),
+    options_(config),
+    storage_(new SimpleModuleStorage(*this))
+  {
+  }
+
+  void setWindowFullHandler(WindowFullHandler handler) override {
+    windowFullHandler_ = handler;
+  }
+
+  void addMeasurementsAsNewBatch() override {
+    SM_ASSERT_TRUE(std::runtime_error, _currentEffectiveBatchInterval, "There is no window to estimate!");
+    LOG(INFO) << "Starting calibration of window " << windowIndex_ << " in interval " << secsSinceStart(getCurrentEffectiveBatchInterval());
+
+    std::vector<Eigen::VectorXd> lastGoodValues;
+    for(const auto & c : getModel().getCalibrationVariables()){
+      lastGoodValues.push_back(c->getMinimalComponents());
+    }
+
+    for(Module & m : getModel().getModules()){
+      m.preProcessNewWindow(*this);
+    }
+    if(initStates()){
+      IncrementalCalibrationConf estConf(*this, windowIndex_, windowIndex_ > 0 && options_.getUseCalibPriors());
+      BatchCalibrationProblem problem;
+
+      estimate(estConf, problem, problem, [&](){
+        boost::shared_ptr<backend::LinearSystemSolver> linearSystemSolver(new aslam::backend::SparseCholeskyLinearSystemSolver());
+        linearSystemSolver->setAcceptConstantErrorTerms(options_.getAcceptConstantErrorTerms());
+
+        aslam::backend::Optimizer2 opt(config_.getChild("estimator/optimizer").asPropertyTree(), linearSystemSolver, boost::make_shared<backend::LevenbergMarquardtTrustRegionPolicy>(100));
+        updateOptimizerInspector(problem, false, [&](std::ostream &out){
+            out << "The Jacobian matrix is: " << linearSystemSolver->JRows()<< " x " << linearSystemSolver->JCols();
+        }, opt.callback());
+        opt.setProblem(problem.getProblemSp());
+        opt.options().verbose = false;
+        opt.optimize();
+        LOG(INFO) << "Final "<< opt.getStatus();
+      });
+      getModel().printCalibrationVariables(LOG(INFO) << "After calibration of window " << windowIndex_ << ":" << std::endl) << std::endl;
+    } else {
+      LOG(ERROR) << "initStates failed for window " << windowIndex_ << ". Going to skip it and keep the previous calibration.";
+      size_t i = 0;
+      for(const auto & c : getModel().getCalibrationVariables()){
+        c->setMinimalComponents(lastGoodValues[i++]);
+      }
+    }
+
+    startNextWindow();
+  }
+
+  void skipLastWindow() override {
+    LOG(INFO) << "Skipping window " << windowIndex_ << ".";
+    startNextWindow();
+  }
+
+  bool invokeWindowFullHanlderIfNecessary(bool acceptShortWindow = false) override {
+    if(!hasNewData()){
+      return false;
+    }
+    const double elapsed = static_cast<double>(_currentEffectiveBatchInterval.getElapsedTime());
+    if(elapsed >= options_.getWindowDuration() || (acceptShortWindow && elapsed >= options_.getMinimalWindowDuration())){
+      if(windowFullHandler_){
+        windowFullHandler_(*this);
+      } else {
+        addMeasurementsAsNewBatch();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void startCollectingDataFrom(const ModuleList & moduleList, Timestamp startTime) override {
+    for(Module & m : moduleList.resolveModuleList(getModel())){
+      LOG(INFO) << "Start collecting data from " << m.getName() << " at " << secsSinceStart(startTime) << ".";
+      collectingIntervals_[&m] = Interval(startTime, InvalidTimestamp());
+    }
+  }
+
+  void stopCollectingDataFrom(const ModuleList & moduleList, Timestamp endTime) override {
+    for(Module & m : moduleList.resolveModuleList(getModel())){
+      auto it = collectingIntervals_.find(&m);
+      if(it == collectingIntervals_.end()){
+        LOG(WARNING) << "Stopping to collect data from " << m.getName() << ", which was not started!";
+        continue;
+      }
+      LOG(INFO) << "Stop collecting data from " << m.getName() << " at " << secsSinceStart(endTime) << ".";
+      it->second.end = endTime;
+    }
+  }
+
+  size_t getNumModulesDataCollecting() const override {
+    size_t num = 0;
+    for(auto & i : collectingIntervals_){
+      if(i.second.end == InvalidTimestamp()){
+        num++;
+      }
+    }
+    return num;
+  }
+
+  void enableIcpInspection(bool active, const std::string & /*inspectionOutputFolder*/) override {
+    LOG_IF(WARNING, active) << "ICP inspection is not supported by this calibrator.";
+  }
+
+  IncrementalCalibratorOptions& getOptions() {
+    return options_;
+  }
+  const IncrementalCalibratorOptions& getOptions() const override {
+    return options_;
+  }
+
+  bool handleNewTimeBaseTimestamp(Timestamp t) override {
+    if (!_currentEffectiveBatchInterval){
+      _currentEffectiveBatchInterval.start = t;
+      _currentEffectiveBatchInterval.end = t;
+      timeBaseTimestamps_.assign(1, t);
+      return true;
+    }
+    if(_currentEffectiveBatchInterval.start > t){
+      LOG(WARNING) << "Ignoring time base timestamp " << secsSinceStart(t) << " before the current window's start!";
+      return false;
+    }
+    if(_currentEffectiveBatchInterval.end < t){
+      _currentEffectiveBatchInterval.end = t;
+      timeBaseTimestamps_.push_back(t);
+      return true;
+    }
+    return false;
+  }
+
+  bool isMeasurementRelevant(const Sensor & s, Timestamp t) const override {
+    if(_currentEffectiveBatchInterval && t < _currentEffectiveBatchInterval.start + s.getDelayLowerBound()){
+      return false;
+    }
+    auto it = collectingIntervals_.find(&static_cast<const Module &>(s));
+    if(it != collectingIntervals_.end()){
+      const Interval & i = it->second;
+      return i.start <= t && (i.end == InvalidTimestamp() || t <= i.end);
+    }
+    return true;
+  }
+
+  ModuleStorage & getCurrentStorage() override {
+    return *storage_;
+  }
+
+  const ModuleStorage & getCurrentStorage() const override {
+    return *storage_;
+  }
+
+  bool isNextWindowScheduled() const override {
+    return hasNewData();
+  }
+
+  Timestamp getNextTimeWindowStartTimestamp() const override {
+    return _currentEffectiveBatchInterval.start;
+  }
+
+ private:
+  /// Whether the current window has time base timestamps beyond the ones carried over from the previous window.
+  bool hasNewData() const {
+    return _currentEffectiveBatchInterval && (carriedOverUntil_ == InvalidTimestamp() || _currentEffectiveBatchInterval.end > carriedOverUntil_);
+  }
+
+  void startNextWindow() {
+    std::unique_ptr<SimpleModuleStorage> nextStorage(new SimpleModuleStorage(*this));
+
+    // The next window starts with the first time base timestamp within the overlap.
+    Timestamp nextStart = InvalidTimestamp();
+    if(options_.getWindowOverlap() > 0 && _currentEffectiveBatchInterval){
+      const Timestamp overlapStart = _currentEffectiveBatchInterval.end - Duration(options_.getWindowOverlap());
+      auto it = std::lower_bound(timeBaseTimestamps_.begin(), timeBaseTimestamps_.end(), overlapStart);
+      if(it != timeBaseTimestamps_.end()){
+        nextStart = *it;
+        timeBaseTimestamps_.erase(timeBaseTimestamps_.begin(), it);
+      }
+    }
+
+    if(nextStart == InvalidTimestamp()){
+      for(Module & m : getModel().getModules()){
+        m.clearMeasurements(*storage_);
+      }
+      _currentEffectiveBatchInterval.clear();
+      carriedOverUntil_ = InvalidTimestamp();
+      timeBaseTimestamps_.clear();
+    } else {
+      LOG(INFO) << "Carrying the measurements since " << secsSinceStart(nextStart) << " over into window " << (windowIndex_ + 1) << ".";
+      for(Module & m : getModel().getModules()){
+        Timestamp moduleStart = nextStart;
+        if(m.isA<Sensor>()){
+          moduleStart = moduleStart + m.as<Sensor>().getDelayLowerBound();
+        }
+        m.carryOverMeasurements(*storage_, *nextStorage, moduleStart);
+      }
+      carriedOverUntil_ = _currentEffectiveBatchInterval.end;
+      _currentEffectiveBatchInterval.start = nextStart;
+    }
+    storage_ = std::move(nextStorage);
+    windowIndex_++;
+  }
+
+  sm::value_store::ValueStoreRef config_;
+  IncrementalCalibratorOptions options_;
+  /// The current window's storage.
+  std::unique_ptr<SimpleModuleStorage> storage_;
+  /// The time base sensor's timestamps in the current window in increasing order.
+  std::vector<Timestamp> timeBaseTimestamps_;
+  /// The end of the previous window if the current window overlaps with it.
+  Timestamp carriedOverUntil_ = InvalidTimestamp();
+  WindowFullHandler windowFullHandler_;
+  std::unordered_map<const Module *, Interval> collectingIntervals_;
+  size_t windowIndex_ = 0;
+};
+
+
+std::unique_ptr<IncrementalCalibratorI> createIncrementalCalibrator(ValueStoreRef vs, std::shared_ptr<Model> model) {
+  return std::unique_ptr<IncrementalCalibratorI>(new IncrementalCalibrator(vs, model));
+}
+
+}
+}
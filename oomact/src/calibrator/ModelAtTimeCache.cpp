@@ -0,0 +1,67 @@
+#include <aslam/calibration/calibrator/ModelAtTimeCache.h>
+
+namespace aslam {
+namespace calibration {
+
+size_t ModelAtTimeCache::KeyHash::operator()(const Key & k) const {
+  size_t h = std::hash<long long>()(k.timestamp.getNumerator());
+  h = h * 31 + std::hash<const void*>()(k.delayVariable);
+  return h * 31 + (k.needGlobalPosition << 1 | k.needGlobalOrientation);
+}
+
+ModelAtTime ModelAtTimeCache::get(const Key & key, int maximalDerivativeOrder, const std::function<ModelAtTime()> & create) {
+  {
+    std::lock_guard<std::mutex> lk(m_);
+    auto it = models_.find(key);
+    if(it != models_.end() && it->second.maximalDerivativeOrder >= maximalDerivativeOrder){
+      hits_++;
+      return it->second.model;
+    }
+  }
+  // Create outside the lock. If two threads race for the same key the first one to insert a sufficient model wins.
+  ModelAtTime model = create();
+  std::lock_guard<std::mutex> lk(m_);
+  auto it = models_.find(key);
+  if(it == models_.end()){
+    it = models_.emplace(key, Entry{maximalDerivativeOrder, std::move(model)}).first;
+  } else if(it->second.maximalDerivativeOrder < maximalDerivativeOrder){
+    // Models handed out earlier stay valid. Only later requests get the more capable one.
+    it->second = Entry{maximalDerivativeOrder, std::move(model)};
+  } else {
+    hits_++;
+    return it->second.model;
+  }
+  misses_++;
+  return it->second.model;
+}
+
+void ModelAtTimeCache::clear() {
+  std::lock_guard<std::mutex> lk(m_);
+  models_.clear();
+}
+
+size_t ModelAtTimeCache::size() const {
+  std::lock_guard<std::mutex> lk(m_);
+  return models_.size();
+}
+
+double ModelAtTimeCache::getHitRate() const {
+  const size_t hits = hits_, total = hits + misses_;
+  return total ? double(hits) / total : 0.0;
+}
+
+ModelAtTimeCacheStatistics ModelAtTimeCache::getStatistics() const {
+  ModelAtTimeCacheStatistics stats;
+  stats.models = size();
+  stats.hits = hits_;
+  stats.misses = misses_;
+  return stats;
+}
+
+void ModelAtTimeCache::resetStatistics() {
+  hits_ = 0;
+  misses_ = 0;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -0,0 +1,179 @@
+#include <aslam/calibration/calibrator/SchurComplementOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include <glog/logging.h>
+#include <aslam/backend/DesignVariable.hpp>
+#include <aslam/backend/ErrorTerm.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+#include <sm/timing/Timer.hpp>
+
+#include <aslam/calibration/algo/SchurComplementSolver.h>
+
+namespace aslam {
+namespace calibration {
+
+std::ostream & operator << (std::ostream & out, const SchurComplementOptimizerStatus & status) {
+  return out << "SchurComplementOptimizerStatus(iterations=" << status.iterations << ", initialCost=" << status.initialCost << ", finalCost=" << status.finalCost << ", converged=" << status.converged << ")";
+}
+
+SchurComplementOptimizer::SchurComplementOptimizer(sm::value_store::ValueStoreRef config) :
+  maxIterations_(config.getInt("maxIterations", 50)),
+  convergenceDeltaX_(config.getDouble("convergenceDeltaX", 1e-6)),
+  convergenceDeltaJ_(config.getDouble("convergenceDeltaJ", 1e-9)),
+  initialLambda_(config.getDouble("initialLambda", 1e-3))
+{
+}
+
+namespace {
+typedef std::unordered_map<const backend::DesignVariable*, int> DvOffsets;
+
+int addActive(const std::vector<backend::DesignVariable*> & dvs, int offset, DvOffsets & offsets, std::vector<backend::DesignVariable*> & activeDvs){
+  for(auto dv : dvs){
+    if(dv->isActive() && offsets.emplace(dv, offset).second){
+      activeDvs.push_back(dv);
+      offset += dv->minimalDimensions();
+    }
+  }
+  return offset;
+}
+
+double evaluateCost(const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms){
+  double cost = 0;
+  Eigen::VectorXd e;
+  for(auto & et : errorTerms){
+    et->evaluateError();
+    et->getWeightedError(e, true);
+    cost += e.squaredNorm();
+  }
+  return cost;
+}
+
+/// Requires the errors to be evaluated at the current linearization point.
+void buildSystem(const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms, const DvOffsets & offsets, SchurComplementSolver & solver){
+  solver.clear();
+  Eigen::VectorXd e;
+  SchurComplementSolver::JacobianBlocks blocks;
+  for(auto & et : errorTerms){
+    backend::JacobianContainer jc(et->dimension());
+    et->getWeightedJacobians(jc, true);
+    et->getWeightedError(e, true);
+    blocks.clear();
+    for(auto it = jc.begin(); it != jc.end(); ++it){
+      auto o = offsets.find(it->first);
+      if(o != offsets.end()){
+        blocks.emplace_back(o->second, it->second);
+      }
+    }
+    if(!blocks.empty()){
+      solver.addErrorTerm(blocks, e);
+    }
+  }
+}
+}
+
+SchurComplementOptimizerStatus SchurComplementOptimizer::optimize(
+    const std::vector<backend::DesignVariable*> & stateVariables,
+    const std::vector<backend::DesignVariable*> & calibrationVariables,
+    const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms,
+    std::function<void()> variablesUpdatedCallback) const
+{
+  DvOffsets offsets;
+  std::vector<backend::DesignVariable*> activeDvs;
+  const int dimState = addActive(stateVariables, 0, offsets, activeDvs);
+  const int dimAll = addActive(calibrationVariables, dimState, offsets, activeDvs);
+  LOG(INFO) << "Schur complement optimizer: dim(state)=" << dimState << ", dim(calib)=" << (dimAll - dimState) << ", #errorTerms=" << errorTerms.size();
+
+  SchurComplementOptimizerStatus status;
+  SchurComplementSolver solver(dimState, dimAll - dimState);
+
+  double cost = evaluateCost(errorTerms);
+  status.initialCost = cost;
+  double lambda = initialLambda_;
+  Eigen::VectorXd dx;
+  // Only an accepted step moves the linearization point. After a rejected step or a failed solve the system gets solved again with a larger lambda.
+  bool needsRebuild = true;
+  for(; status.iterations < maxIterations_; status.iterations++){
+    if(needsRebuild){
+      sm::timing::Timer timer("SchurComplementOptimizer: build system");
+      buildSystem(errorTerms, offsets, solver);
+      needsRebuild = false;
+    }
+    bool solved;
+    {
+      sm::timing::Timer timer("SchurComplementOptimizer: solve system");
+      solved = solver.solve(lambda, dx);
+    }
+    if(!solved){
+      lambda *= 10;
+      continue;
+    }
+
+    for(auto dv : activeDvs){
+      dv->update(&dx[offsets.at(dv)], dv->minimalDimensions());
+    }
+    const double newCost = evaluateCost(errorTerms);
+    if(newCost < cost){
+      const double deltaJ = cost - newCost;
+      cost = newCost;
+      lambda = std::max(lambda / 10, 1e-12);
+      needsRebuild = true;
+      if(variablesUpdatedCallback){
+        variablesUpdatedCallback();
+      }
+      if(dx.lpNorm<Eigen::Infinity>() < convergenceDeltaX_ || deltaJ < convergenceDeltaJ_ * cost){
+        status.converged = true;
+        status.iterations++;
+        break;
+      }
+    } else {
+      for(auto dv : activeDvs){
+        dv->revertUpdate();
+      }
+      evaluateCost(errorTerms); // restore the errors at the linearization point
+      lambda *= 10;
+      if(dx.lpNorm<Eigen::Infinity>() < convergenceDeltaX_){
+        status.converged = true;
+        status.iterations++;
+        break;
+      }
+    }
+  }
+  status.finalCost = cost;
+  return status;
+}
+
+bool computeCalibrationVariableCovariances(
+    const std::vector<backend::DesignVariable*> & stateVariables,
+    const std::vector<backend::DesignVariable*> & calibrationVariables,
+    const std::vector<boost::shared_ptr<backend::ErrorTerm>> & errorTerms,
+    std::unordered_map<const backend::DesignVariable*, Eigen::MatrixXd> & covariances)
+{
+  sm::timing::Timer timer("computeCalibrationVariableCovariances");
+  DvOffsets offsets;
+  std::vector<backend::DesignVariable*> activeDvs;
+  const int dimState = addActive(stateVariables, 0, offsets, activeDvs);
+  const int dimAll = addActive(calibrationVariables, dimState, offsets, activeDvs);
+
+  SchurComplementSolver solver(dimState, dimAll - dimState);
+  evaluateCost(errorTerms);
+  buildSystem(errorTerms, offsets, solver);
+
+  Eigen::MatrixXd covariance;
+  if(!solver.computeCalibrationCovariance(covariance)){
+    return false;
+  }
+  covariances.clear();
+  for(auto dv : activeDvs){
+    const int offset = offsets.at(dv) - dimState;
+    if(offset >= 0){
+      covariances[dv] = covariance.block(offset, offset, dv->minimalDimensions(), dv->minimalDimensions());
+    }
+  }
+  return true;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
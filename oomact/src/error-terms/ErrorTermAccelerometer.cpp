@@ -29,7 +29,11 @@ namespace aslam {
   namespace calibration {
     ErrorTermAccelerometer::ErrorTermAccelerometer(const EuclideanExpression& a_m_mi, const RotationExpression& R_i_m, const EuclideanExpression& g_m, const EuclideanExpression& bias, const Input& am, const Covariance& sigma2,
                                                    const ErrorTermGroupReference & etgr) :
-        Parent(RotationExpression(R_i_m) * (a_m_mi + g_m) + bias, am, sigma2, etgr)
+        Parent(createPrediction(a_m_mi, R_i_m, g_m, bias), am, sigma2, etgr)
     {}
+
+    EuclideanExpression ErrorTermAccelerometer::createPrediction(const EuclideanExpression& a_m_mi, const RotationExpression& R_i_m, const EuclideanExpression& g_m, const EuclideanExpression& bias) {
+      return RotationExpression(R_i_m) * (a_m_mi + g_m) + bias;
+    }
   }
 }
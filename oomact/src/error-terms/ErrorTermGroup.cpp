@@ -1,9 +1,15 @@
 #include <aslam/calibration/error-terms/ErrorTermGroup.h>
+
+#include <mutex>
+#include <unordered_map>
+
 namespace aslam {
 namespace calibration {
 
 const ErrorTermGroup & ErrorTermGroup::getByName(const std::string & name){
   static std::unordered_map<std::string, ErrorTermGroup> m;
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex); // error terms may be created concurrently (see AbstractCalibrator::addFactors)
 
   auto i = m.find(name);
   if(i != m.end()){
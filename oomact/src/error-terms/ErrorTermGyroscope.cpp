@@ -29,7 +29,11 @@ namespace aslam {
   namespace calibration {
     ErrorTermGyroscope::ErrorTermGyroscope(const EuclideanExpression& w_i_mi, const EuclideanExpression& bias, const Input& wm, const Covariance& sigma2,
                                            const ErrorTermGroupReference & etgr) :
-        Parent(w_i_mi + bias, wm, sigma2, etgr)
+        Parent(createPrediction(w_i_mi, bias), wm, sigma2, etgr)
     {}
+
+    EuclideanExpression ErrorTermGyroscope::createPrediction(const EuclideanExpression& w_i_mi, const EuclideanExpression& bias) {
+      return w_i_mi + bias;
+    }
   }
 }
@@ -0,0 +1,100 @@
+#include "aslam/calibration/error-terms/ErrorTermImuPreintegration.h"
+
+#include <sm/kinematics/rotations.hpp>
+
+namespace aslam {
+namespace calibration {
+
+ErrorTermImuPreintegration::ErrorTermImuPreintegration(const State & from, const State & till,
+    const aslam::backend::EuclideanExpression & g_m,
+    const aslam::backend::EuclideanExpression & accBias,
+    const aslam::backend::EuclideanExpression & gyroBias,
+    const ImuPreintegration & preintegration,
+    const ErrorTermGroupReference & etgr) :
+    ErrorTermGroupMember(etgr),
+    from_(from), till_(till), g_m_(g_m), accBias_(accBias), gyroBias_(gyroBias), preintegration_(preintegration) {
+  setInvR(preintegration.getCovariance().inverse());
+  aslam::backend::DesignVariable::set_t dv;
+  for(const State * s : {&from_, &till_}){
+    s->R_m_i.getDesignVariables(dv);
+    s->p_m_i.getDesignVariables(dv);
+    s->v_m_i.getDesignVariables(dv);
+  }
+  g_m_.getDesignVariables(dv);
+  accBias_.getDesignVariables(dv);
+  gyroBias_.getDesignVariables(dv);
+  setDesignVariablesIterator(dv.begin(), dv.end());
+}
+
+double ErrorTermImuPreintegration::evaluateErrorImplementation() {
+  const double dt = preintegration_.getDeltaT();
+  const Eigen::Matrix3d R_i_m = from_.R_m_i.toRotationMatrix().transpose();
+  const Eigen::Vector3d v_i = from_.v_m_i.toEuclidean(), g = g_m_.toEuclidean();
+  const Eigen::Vector3d b_a = accBias_.toEuclidean(), b_g = gyroBias_.toEuclidean();
+
+  error_t error;
+  error.head<3>() = logSO3(preintegration_.getDeltaR(b_g).transpose() * R_i_m * till_.R_m_i.toRotationMatrix());
+  error.segment<3>(3) = R_i_m * (till_.v_m_i.toEuclidean() - v_i + g * dt) - preintegration_.getDeltaV(b_a, b_g);
+  error.tail<3>() = R_i_m * (till_.p_m_i.toEuclidean() - from_.p_m_i.toEuclidean() - v_i * dt + 0.5 * g * dt * dt) - preintegration_.getDeltaP(b_a, b_g);
+  setError(error);
+  return evaluateChiSquaredError();
+}
+
+void ErrorTermImuPreintegration::evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) {
+  typedef Eigen::Matrix<double, 9, 3> Jacobian;
+  const double dt = preintegration_.getDeltaT();
+  const Eigen::Matrix3d R_i_m = from_.R_m_i.toRotationMatrix().transpose();
+  const Eigen::Vector3d v_i = from_.v_m_i.toEuclidean(), g = g_m_.toEuclidean();
+  const Eigen::Vector3d b_g = gyroBias_.toEuclidean();
+  const Eigen::Vector3d u_v = till_.v_m_i.toEuclidean() - v_i + g * dt;
+  const Eigen::Vector3d u_p = till_.p_m_i.toEuclidean() - from_.p_m_i.toEuclidean() - v_i * dt + 0.5 * g * dt * dt;
+  const Eigen::Matrix3d dR = preintegration_.getDeltaR(b_g);
+  const Eigen::Vector3d r_R = logSO3(dR.transpose() * R_i_m * till_.R_m_i.toRotationMatrix());
+  // Rotations are perturbed from the left: R -> Exp(d) * R.
+  const Eigen::Matrix3d dRotation = inverseRightJacobianSO3(-r_R) * dR.transpose() * R_i_m;
+
+  Jacobian J = Jacobian::Zero();
+  J.topRows<3>() = -dRotation;
+  J.middleRows<3>(3) = R_i_m * sm::kinematics::crossMx(u_v);
+  J.bottomRows<3>() = R_i_m * sm::kinematics::crossMx(u_p);
+  from_.R_m_i.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.topRows<3>() = dRotation;
+  till_.R_m_i.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.middleRows<3>(3) = -R_i_m;
+  J.bottomRows<3>() = -R_i_m * dt;
+  from_.v_m_i.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.middleRows<3>(3) = R_i_m;
+  till_.v_m_i.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.bottomRows<3>() = -R_i_m;
+  from_.p_m_i.evaluateJacobians(jacobians, J);
+
+  J.bottomRows<3>() = R_i_m;
+  till_.p_m_i.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.middleRows<3>(3) = R_i_m * dt;
+  J.bottomRows<3>() = 0.5 * R_i_m * dt * dt;
+  g_m_.evaluateJacobians(jacobians, J);
+
+  J.setZero();
+  J.middleRows<3>(3) = -preintegration_.getDVdAccBias();
+  J.bottomRows<3>() = -preintegration_.getDPdAccBias();
+  accBias_.evaluateJacobians(jacobians, J);
+
+  const Eigen::Matrix3d & dR_dbg = preintegration_.getDRdGyroBias();
+  J.topRows<3>() = -inverseRightJacobianSO3(-r_R) * rightJacobianSO3(dR_dbg * (b_g - preintegration_.getGyroBias())) * dR_dbg;
+  J.middleRows<3>(3) = -preintegration_.getDVdGyroBias();
+  J.bottomRows<3>() = -preintegration_.getDPdGyroBias();
+  gyroBias_.evaluateJacobians(jacobians, J);
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -36,23 +36,32 @@ ErrorTermPose::ErrorTermPose(const aslam::backend::TransformationExpression& T,
   ErrorTermPose(T, pm.t, pm.q, cov_t, cov_r, etgr) {
 }
 
-sm::kinematics::RotationVector rotVec;
+namespace {
+// RotationVector is stateless. A local instance per call keeps the error terms free of shared mutable state and cheap to construct.
+inline Eigen::Vector3d rotationError(const Eigen::Matrix3d & C_error) {
+  return sm::kinematics::RotationVector().rotationMatrixToParameters(C_error);
+}
+}
 
 double ErrorTermPose::evaluateErrorImplementation() {
-  const Eigen::Matrix4d T = _T.toTransformationMatrix();
+  _linearizationT = _T.toTransformationMatrix();
+  _linearizationRotationError = rotationError(_linearizationT.topLeftCorner<3, 3>() * _C.transpose());
+  _isLinearized = true;
   error_t error;
-  error.head<3>() = T.topRightCorner<3, 1>() - _t;
-  error.tail<3>() = rotVec.rotationMatrixToParameters(T.topLeftCorner<3, 3>() * _C.transpose());
+  error.head<3>() = _linearizationT.topRightCorner<3, 1>() - _t;
+  error.tail<3>() = _linearizationRotationError;
   setError(error);
   return evaluateChiSquaredError();
 }
 
+/// Like the M-estimator weights, the Jacobians refer to the linearization point of the last error evaluation.
 void ErrorTermPose::evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) {
-  const Eigen::Matrix4d T = _T.toTransformationMatrix();
-  Eigen::Matrix<double, 6, 6> J = Eigen::Matrix<double, 6, 6>::Identity();
-  J.topRightCorner<3, 3>() = sm::kinematics::crossMx(T.topRightCorner<3, 1>());
-  J.bottomRightCorner<3, 3>() = (rotVec.parametersToSMatrix(rotVec.rotationMatrixToParameters(T.topLeftCorner<3, 3>() * _C.transpose()))).inverse();
-  _T.evaluateJacobians(jacobians, J);
+  if(!_isLinearized){
+    evaluateErrorImplementation();
+  }
+  _chainRule.topRightCorner<3, 3>() = sm::kinematics::crossMx(_linearizationT.topRightCorner<3, 1>());
+  _chainRule.bottomRightCorner<3, 3>() = sm::kinematics::RotationVector().parametersToSMatrix(_linearizationRotationError).inverse();
+  _T.evaluateJacobians(jacobians, _chainRule);
 }
 
 Eigen::VectorXd ErrorTermPose::getPrediction() const {
@@ -0,0 +1,50 @@
+#include "aslam/calibration/error-terms/ErrorTermSplineDerivativeIntegral.h"
+
+#include <cmath>
+
+#include <aslam/backend/JacobianContainer.hpp>
+
+namespace aslam {
+namespace calibration {
+
+ErrorTermSplineDerivativeIntegral::ErrorTermSplineDerivativeIntegral(std::vector<aslam::backend::DesignVariable*> coefficients, const Eigen::MatrixXd & sqrtGram, double segmentDuration, int derivative, const Eigen::MatrixXd & sqrtInvR, const ErrorTermGroupReference & etgr) :
+    aslam::backend::ErrorTermDs(sqrtGram.rows() * sqrtInvR.rows()),
+    ErrorTermGroupMember(etgr),
+    _coefficients(std::move(coefficients)),
+    _dim(sqrtInvR.cols()) {
+  CHECK_EQ(sqrtGram.cols(), int(_coefficients.size()));
+  CHECK_GT(segmentDuration, 0);
+
+  // integral = h^(1 - 2 derivative) * sum_ij G(i, j) c_i^T sqrtInvR^T sqrtInvR c_j = |(U kron sqrtInvR) c|^2 * h^(1 - 2 derivative)
+  const double scale = std::pow(segmentDuration, 0.5 - derivative);
+  _W.resize(dimension(), _dim * _coefficients.size());
+  for(int r = 0; r < sqrtGram.rows(); r++){
+    for(int c = 0; c < sqrtGram.cols(); c++){
+      _W.block(r * sqrtInvR.rows(), c * _dim, sqrtInvR.rows(), _dim) = sqrtGram(r, c) * scale * sqrtInvR;
+    }
+  }
+
+  setInvR(Eigen::MatrixXd::Identity(dimension(), dimension()));
+  setDesignVariablesIterator(_coefficients.begin(), _coefficients.end());
+}
+
+double ErrorTermSplineDerivativeIntegral::evaluateErrorImplementation() {
+  Eigen::VectorXd c(_W.cols());
+  Eigen::MatrixXd p;
+  for(size_t i = 0; i < _coefficients.size(); i++){
+    _coefficients[i]->getParameters(p);
+    CHECK_EQ(p.size(), _dim);
+    c.segment(i * _dim, _dim) = Eigen::Map<const Eigen::VectorXd>(p.data(), _dim);
+  }
+  setError(_W * c);
+  return evaluateChiSquaredError();
+}
+
+void ErrorTermSplineDerivativeIntegral::evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) {
+  for(size_t i = 0; i < _coefficients.size(); i++){
+    jacobians.add(_coefficients[i], _W.middleCols(i * _dim, _dim));
+  }
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
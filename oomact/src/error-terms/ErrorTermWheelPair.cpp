@@ -0,0 +1,58 @@
+#include "aslam/calibration/error-terms/ErrorTermWheelPair.h"
+
+namespace aslam {
+namespace calibration {
+
+ErrorTermWheelPair::ErrorTermWheelPair(const aslam::backend::EuclideanExpression & v_r_mr, const aslam::backend::EuclideanExpression & w_r_mr,
+    const aslam::backend::ScalarExpression & L, const aslam::backend::ScalarExpression & R_l, const aslam::backend::ScalarExpression & R_r,
+    const Eigen::Vector2d & measurement, const Eigen::Vector2d & variances,
+    const ErrorTermGroupReference & etgr) :
+    ErrorTermGroupMember(etgr),
+    _v_r_mr(v_r_mr), _w_r_mr(w_r_mr), _L(L), _R_l(R_l), _R_r(R_r), _measurement(measurement) {
+  setInvR(variances.cwiseInverse().asDiagonal().toDenseMatrix());
+  aslam::backend::DesignVariable::set_t dv;
+  _v_r_mr.getDesignVariables(dv);
+  _w_r_mr.getDesignVariables(dv);
+  _L.getDesignVariables(dv);
+  _R_l.getDesignVariables(dv);
+  _R_r.getDesignVariables(dv);
+  setDesignVariablesIterator(dv.begin(), dv.end());
+}
+
+Eigen::Vector2d ErrorTermWheelPair::getPrediction() const {
+  const double v = _v_r_mr.toEuclidean()[0];
+  const double w = _w_r_mr.toEuclidean()[2];
+  const double lHalf = 0.5 * _L.toScalar();
+  return Eigen::Vector2d((v - w * lHalf) / _R_l.toScalar(), (v + w * lHalf) / _R_r.toScalar());
+}
+
+double ErrorTermWheelPair::evaluateErrorImplementation() {
+  setError(getPrediction() - _measurement);
+  return evaluateChiSquaredError();
+}
+
+void ErrorTermWheelPair::evaluateJacobiansImplementation(aslam::backend::JacobianContainer& jacobians) {
+  const double v = _v_r_mr.toEuclidean()[0];
+  const double w = _w_r_mr.toEuclidean()[2];
+  const double L = _L.toScalar(), R_l = _R_l.toScalar(), R_r = _R_r.toScalar();
+  const double v_l = v - 0.5 * w * L, v_r = v + 0.5 * w * L;
+
+  Eigen::Matrix<double, 2, 3> J_v = Eigen::Matrix<double, 2, 3>::Zero(), J_w = Eigen::Matrix<double, 2, 3>::Zero();
+  J_v(0, 0) = 1. / R_l;
+  J_v(1, 0) = 1. / R_r;
+  J_w(0, 2) = -0.5 * L / R_l;
+  J_w(1, 2) = 0.5 * L / R_r;
+  _v_r_mr.evaluateJacobians(jacobians, J_v);
+  _w_r_mr.evaluateJacobians(jacobians, J_w);
+
+  Eigen::Matrix<double, 2, 1> J_L, J_R_l = Eigen::Matrix<double, 2, 1>::Zero(), J_R_r = Eigen::Matrix<double, 2, 1>::Zero();
+  J_L << -0.5 * w / R_l, 0.5 * w / R_r;
+  J_R_l(0) = -v_l / (R_l * R_l);
+  J_R_r(1) = -v_r / (R_r * R_r);
+  _L.evaluateJacobians(jacobians, J_L);
+  _R_l.evaluateJacobians(jacobians, J_R_l);
+  _R_r.evaluateJacobians(jacobians, J_R_r);
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -1,5 +1,11 @@
 #include <aslam/calibration/model/FrameGraphModel.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #include <glog/logging.h>
 
 #include <aslam/backend/KinematicChain.hpp>
@@ -36,7 +42,116 @@ struct FrameLinkStorage {
   FrameLinkStorage(const FrameLinkI* frameLink) : ptr(frameLink), type(Type::NonStatic) {}
 };
 
+/**
+ * The frame tree together with the kinematic chains of all frames, precomputed in init().
+ * The chain from an ancestor A to a frame F is the tail of F's chain from the root, starting at A's depth.
+ * Hence, for any pair of frames the links are available as a flat range without any tree walking or allocation.
+ */
 class FrameGraph: public Tree<const Frame*, FrameLinkStorage> {
+ public:
+  struct ChainLink {
+    FrameLinkStorage link;
+    /// The index of the link's frame.
+    size_t node;
+  };
+  typedef std::vector<ChainLink>::const_iterator LinkIterator;
+
+  /// A static link without active design variables and without velocities or accelerations, folded into its constant transformation.
+  struct ConstantLink {
+    bool isConstant = false;
+    /// Evaluated whenever a chain gets built because the inactive design variables' values may still change between problems (e.g. loadFromArchive).
+    backend::RotationExpression R_parent_frame;
+    backend::EuclideanExpression t_parent_frame;
+  };
+
+  void init() {
+    Tree::init();
+    const size_t n = getNumNodes();
+    linksFromRoot_.resize(n);
+    for(size_t i = 0; i < n; i++){
+      auto & links = linksFromRoot_[i];
+      links.reserve(getDepth(i));
+      for(size_t j = i; getParent(j) != NoIndex; j = getParent(j)){
+        links.push_back(ChainLink{getToParentPayload(j), j});
+      }
+      std::reverse(links.begin(), links.end());
+    }
+
+    closestCommonAncestors_.resize(n * n);
+    for(size_t i = 0; i < n; i++){
+      for(size_t j = 0; j < n; j++){
+        closestCommonAncestors_[i * n + j] = Tree::getClosestCommonAncestor(i, j);
+      }
+    }
+    constantLinks_.assign(n, ConstantLink());
+  }
+
+  /// Determine which static links are constant given the current activity of the design variables.
+  void updateConstantLinks() {
+    size_t numConstant = 0;
+    for(size_t i = 0; i < getNumNodes(); i++){
+      ConstantLink & c = constantLinks_[i];
+      c = ConstantLink();
+      if(getParent(i) == NoIndex || getToParentPayload(i).type != FrameLinkStorage::Type::Static){
+        continue;
+      }
+      const RelativeKinematicExpression rk = getToParentPayload(i).ptr.staticFrameLink->calcRelativeKinematics();
+      CoordinateFrame cf(boost::shared_ptr<CoordinateFrame>(), rk.R, rk.p, rk.omega, rk.v, rk.alpha, rk.a);
+      backend::DesignVariable::set_t dvs;
+      cf.getR_G_L().getDesignVariables(dvs);
+      cf.getPG().getDesignVariables(dvs);
+      if(std::any_of(dvs.begin(), dvs.end(), [](const backend::DesignVariable * dv){ return dv->isActive(); })){
+        continue;
+      }
+      // Folding would drop the derivatives.
+      if(!cf.getOmegaG().evaluate().isZero(0) || !cf.getVG().evaluate().isZero(0) || !cf.getAlphaG().evaluate().isZero(0) || !cf.getAG().evaluate().isZero(0)){
+        continue;
+      }
+      c.isConstant = true;
+      c.R_parent_frame = cf.getR_G_L();
+      c.t_parent_frame = cf.getPG();
+      numConstant++;
+    }
+    VLOG(1) << "Folding " << numConstant << " constant links of " << (getNumNodes() - 1) << ".";
+  }
+
+  const ConstantLink & getConstantLink(size_t node) const {
+    return constantLinks_[node];
+  }
+
+  Eigen::VectorXd getConstantLinkValues() const {
+    std::vector<double> values;
+    for(const ConstantLink & c : constantLinks_){
+      if(c.isConstant){
+        const Eigen::Matrix3d C = c.R_parent_frame.toRotationMatrix();
+        const Eigen::Vector3d t = c.t_parent_frame.evaluate();
+        values.insert(values.end(), C.data(), C.data() + C.size());
+        values.insert(values.end(), t.data(), t.data() + t.size());
+      }
+    }
+    return Eigen::Map<const Eigen::VectorXd>(values.data(), values.size());
+  }
+
+  const Frame & getClosestCommonAncestor(const Frame & a, const Frame & b) const {
+    return *getNode(getClosestCommonAncestorIndex(getIndex(&a), getIndex(&b)));
+  }
+
+  /// The links from ancestor down to frame in the order they need to be chained.
+  std::pair<LinkIterator, LinkIterator> getLinksFromAncestor(const Frame & ancestor, const Frame & frame) const {
+    const size_t ancestorIndex = getIndex(&ancestor), frameIndex = getIndex(&frame);
+    CHECK(getClosestCommonAncestorIndex(ancestorIndex, frameIndex) == ancestorIndex) << "Only walking to leaf frames is currently supported! Path was: to=" << frame << ", from=" << ancestor;
+    const auto & links = linksFromRoot_[frameIndex];
+    return {links.begin() + getDepth(ancestorIndex), links.end()};
+  }
+
+ private:
+  size_t getClosestCommonAncestorIndex(size_t a, size_t b) const {
+    return closestCommonAncestors_[a * getNumNodes() + b];
+  }
+
+  std::vector<std::vector<ChainLink>> linksFromRoot_;
+  std::vector<size_t> closestCommonAncestors_;
+  std::vector<ConstantLink> constantLinks_;
 };
 
 
@@ -61,22 +176,51 @@ class FrameGraphModelAtTimeImpl: public ModelAtTimeImpl {
   }
 
   CoordinateFrame getKinematicChainFromTo(const Frame & fromLocal, const Frame & toGlobal, const size_t maximalDerivativeOrder) const {
-    boost::shared_ptr<CoordinateFrame> f, fInv;
-    fgModel_.frameGraph_->walkPath(&toGlobal , &fromLocal, [&](const FrameLinkStorage & frameLink, bool towardsLeafs){
-      CHECK(towardsLeafs) << "Only walking to leaf frames is currently supported! Path was: to=" << fromLocal << ", from=" << toGlobal;
+    const FrameGraph & frameGraph = *fgModel_.frameGraph_;
+    boost::shared_ptr<CoordinateFrame> f;
+
+    // Consecutive constant links get multiplied into one constant coordinate frame.
+    bool haveConstant = false;
+    Eigen::Matrix3d C;
+    Eigen::Vector3d t;
+    auto flushConstant = [&](){
+      if(haveConstant){
+        f = relativeKinematics2CF(f, RelativeKinematicExpression(aslam::backend::RotationExpression(C), aslam::backend::EuclideanExpression(t)));
+        haveConstant = false;
+      }
+    };
+
+    const auto links = frameGraph.getLinksFromAncestor(toGlobal, fromLocal);
+    for(auto it = links.first; it != links.second; ++it){
+      const auto & constantLink = frameGraph.getConstantLink(it->node);
+      if(constantLink.isConstant){
+        const Eigen::Matrix3d C_parent_frame = constantLink.R_parent_frame.toRotationMatrix();
+        const Eigen::Vector3d t_parent_frame = constantLink.t_parent_frame.evaluate();
+        if(haveConstant){
+          t += C * t_parent_frame;
+          C = C * C_parent_frame;
+        } else {
+          C = C_parent_frame;
+          t = t_parent_frame;
+          haveConstant = true;
+        }
+        continue;
+      }
+      flushConstant();
+
+      const FrameLinkStorage & frameLink = it->link;
       switch(frameLink.type){
         case FrameLinkStorage::Type::Static:
           f = relativeKinematics2CF(f, frameLink.ptr.staticFrameLink->calcRelativeKinematics());
           break;
         case FrameLinkStorage::Type::NonStatic:
-          f = relativeKinematics2CF(f, frameLink.ptr.frameLink->calcRelativeKinematics(timestamp_,
-                    simplification_, maximalDerivativeOrder));
+          f = relativeKinematics2CF(f, getRelativeKinematics(*frameLink.ptr.frameLink, maximalDerivativeOrder));
           break;
         default:
           CHECK(false);
       }
-
-    });
+    }
+    flushConstant();
     return std::move(*f);
   }
 
@@ -86,7 +230,7 @@ class FrameGraphModelAtTimeImpl: public ModelAtTimeImpl {
   }
 
   aslam::backend::TransformationExpression getTransformationToFrom(const Frame & to, const Frame & from) const override {
-    const Frame & closestCommonAncestor = *fgModel_.frameGraph_->getClosestCommonAncestor(&to, &from);
+    const Frame & closestCommonAncestor = fgModel_.frameGraph_->getClosestCommonAncestor(to, from);
     auto to2ca = getKinematicChainFromTo(to, closestCommonAncestor);
     auto from2ca = getKinematicChainFromTo(from, closestCommonAncestor);
     return aslam::backend::TransformationExpression(to2ca.getR_G_L(), to2ca.getPG()).inverse() * aslam::backend::TransformationExpression(from2ca.getR_G_L(), from2ca.getPG());
@@ -108,10 +252,22 @@ class FrameGraphModelAtTimeImpl: public ModelAtTimeImpl {
     return getKinematicChainFromTo(of, in).getAlphaG();
   }
  private:
+  /// Memoized such that all queries to this model share the links' (trajectory) expressions.
+  const RelativeKinematicExpression & getRelativeKinematics(const FrameLinkI & frameLink, const size_t maximalDerivativeOrder) const {
+    std::lock_guard<std::mutex> lk(relativeKinematicsMutex_);
+    auto it = relativeKinematics_.find(std::make_pair(&frameLink, maximalDerivativeOrder));
+    if(it == relativeKinematics_.end()){
+      it = relativeKinematics_.emplace(std::make_pair(&frameLink, maximalDerivativeOrder), frameLink.calcRelativeKinematics(timestamp_, simplification_, maximalDerivativeOrder)).first;
+    }
+    return it->second;
+  }
+
   int maximalDerivativeOrder_;
   const FrameGraphModel & fgModel_;
   const ModelSimplification simplification_;
   Time timestamp_;
+  mutable std::mutex relativeKinematicsMutex_;
+  mutable std::map<std::pair<const FrameLinkI*, size_t>, RelativeKinematicExpression> relativeKinematics_;
 };
 
 FrameGraphModel::FrameGraphModel(ValueStoreRef config, std::shared_ptr<ConfigPathResolver> configPathResolver, const std::vector<const Frame*> frames) :
@@ -145,5 +301,13 @@ void FrameGraphModel::init() {
   Model::init();
 }
 
+void FrameGraphModel::updateConstantLinks() {
+  frameGraph_->updateConstantLinks();
+}
+
+Eigen::VectorXd FrameGraphModel::getConstantLinkValues() const {
+  return frameGraph_->getConstantLinkValues();
+}
+
 } /* namespace calibration */
 } /* namespace aslam */
@@ -93,6 +93,14 @@ void Module::clearMeasurements(ModuleStorage& storage) {
 void Module::clearMeasurements() {
 }
 
+size_t Module::getNumMeasurements(const ModuleStorage& /*storage*/) const {
+  return 0;
+}
+
+void Module::carryOverMeasurements(ModuleStorage& storage, ModuleStorage& /*nextStorage*/, Timestamp /*nextWindowStart*/) {
+  clearMeasurements(storage);
+}
+
 bool Module::shouldObserveOnly(const CalibrationConfI& ec) const {
   const bool observeOnly = isA<Observer>() && as<Observer>().isObserveOnly();
   const bool errorTermsInactive = isA<Activatable>() && !ec.getErrorTermActivator().isActive(as<Activatable>());
@@ -5,7 +5,6 @@
 
 #include <aslam/backend/EuclideanExpression.hpp>
 #include <aslam/backend/RotationExpression.hpp>
-#include <aslam/backend/Vector2RotationQuaternionExpressionAdapter.hpp>
 #include <aslam/calibration/calibrator/CalibrationConfI.h>
 #include <bsplines/NsecTimePolicy.hpp>
 #include <sm/kinematics/quaternion_algebra.hpp>
@@ -15,6 +14,7 @@
 #include "aslam/calibration/calibrator/CalibratorI.h"
 #include <aslam/calibration/DesignVariableReceiver.h>
 #include "aslam/calibration/data/PoseMeasurement.h"
+#include <aslam/calibration/error-terms/BlockedMeasurementErrorTerm.h>
 #include <aslam/calibration/error-terms/ErrorTermTangency.h>
 #include <aslam/calibration/model/Model.h>
 #include <aslam/calibration/model/ModuleTools.h>
@@ -41,13 +41,15 @@ Eigen::Vector4d negateQuatIfThatBringsItCloser(const Eigen::Vector4d& pquat, con
   }
 }
 
-class BaseTrajectoryBatchState : public BatchState, public So3R3Trajectory {
+class BaseTrajectoryBatchState : public BatchState {
  public:
   BaseTrajectoryBatchState(PoseTrajectory & baseTrajectory)
-    : So3R3Trajectory(baseTrajectory)
+    : trajectory(createSo3R3Trajectory(baseTrajectory))
   {}
 
   void writeToFile(const CalibratorI & calib, const std::string & pathPrefix) const override;
+
+  const std::unique_ptr<So3R3Trajectory> trajectory;
 };
 
 
@@ -59,6 +61,8 @@ PoseTrajectory::PoseTrajectory(Model& model, const std::string& name, sm::value_
   estimate(getMyConfig().getBool("estimate", true)),
   useTanConstraint(getMyConfig().getBool("tangentialConstraint/used", false)),
   tanConstraintVariance(getMyConfig().getDouble("tangentialConstraint/variance", TAN_CONSTRAINT_VARIANCE_DEFAULT)),
+  tanConstraintPerSegment(getMyConfig().getBool("tangentialConstraint/perSegment", false)),
+  tanConstraintPointsPerSegment(getMyConfig().getInt("tangentialConstraint/pointsPerSegment", 2)),
   initWithPoseMeasurements(getMyConfig().getBool("initWithPoseMeasurements", false)),
   poseSensor(*this, "McSensor", initWithPoseMeasurements),
   odometrySensor(*this, "OdomSensor"),
@@ -86,6 +90,10 @@ void PoseTrajectory::writeConfig(std::ostream& out) const {
   So3R3TrajectoryCarrier::writeConfig(out);
   if(useTanConstraint){
     MODULE_WRITE_PARAM(tanConstraintVariance);
+    MODULE_WRITE_PARAM(tanConstraintPerSegment);
+    if(tanConstraintPerSegment){
+      MODULE_WRITE_PARAM(tanConstraintPointsPerSegment);
+    }
   }
 }
 
@@ -129,14 +137,18 @@ bool initSplines(CalibratorI& calib, So3R3Trajectory& trajectory, const PoseSens
     }
   }
 
-  trajectory.fitSplines(effectiveBatchInterval, numMeasurements, timestamps, transPoses, rotPoses);
+  trajectory.fitSplines(effectiveBatchInterval, numMeasurements, timestamps, transPoses, rotPoses, calib.getThreadPool());
 
-  const auto startTimestamp = trajectory.getRotationSpline().getMinTime();
-  const auto endTimestamp = trajectory.getRotationSpline().getMaxTime();
+  const auto startTimestamp = trajectory.getMinTime();
+  const auto endTimestamp = trajectory.getMaxTime();
   static_cast<void>(startTimestamp); // prevent unused warning
   static_cast<void>(endTimestamp);
-  assert(trajectory.getTranslationSpline().getMinTime() == startTimestamp);
-  assert(trajectory.getTranslationSpline().getMaxTime() == endTimestamp);
+  trajectory.visitSplines([&](const auto & rotationSpline, const auto & translationSpline){
+    static_cast<void>(rotationSpline);
+    static_cast<void>(translationSpline);
+    assert(translationSpline.getMinTime() == startTimestamp);
+    assert(translationSpline.getMaxTime() == endTimestamp);
+  });
 
   assert(effectiveBatchInterval.start == Timestamp::fromNumerator(startTimestamp));
   assert(effectiveBatchInterval.end == Timestamp::fromNumerator(endTimestamp));
@@ -242,7 +254,7 @@ bool initSplines(CalibratorI & calib, So3R3Trajectory & trajectory, const WheelO
   CHECK_EQ(rotPoses.size(), transPoses.size());
   CHECK(!transPoses.empty());
 
-  trajectory.fitSplines(effectiveBatchInterval, numWheelSpeedsMeasurements, timestampsWheelSpeeds, transPoses, rotPoses);
+  trajectory.fitSplines(effectiveBatchInterval, numWheelSpeedsMeasurements, timestampsWheelSpeeds, transPoses, rotPoses, calib.getThreadPool());
 
   // TODO: Initialize bias splines
 
@@ -252,10 +264,12 @@ bool initSplines(CalibratorI & calib, So3R3Trajectory & trajectory, const WheelO
   //const int measPerSec = std::round(numWheelSpeedsMeasurements / elapsedTime);
   //int numSegments;
 
-  CHECK_EQ(Timestamp::fromNumerator(trajectory.getRotationSpline().getMinTime()), startTimestamp);
-  CHECK_EQ(Timestamp::fromNumerator(trajectory.getRotationSpline().getMaxTime()), endTimestamp);
-  CHECK_EQ(Timestamp::fromNumerator(trajectory.getTranslationSpline().getMinTime()), startTimestamp);
-  CHECK_EQ(Timestamp::fromNumerator(trajectory.getTranslationSpline().getMaxTime()), endTimestamp);
+  trajectory.visitSplines([&](const auto & rotationSpline, const auto & translationSpline){
+    CHECK_EQ(Timestamp::fromNumerator(rotationSpline.getMinTime()), startTimestamp);
+    CHECK_EQ(Timestamp::fromNumerator(rotationSpline.getMaxTime()), endTimestamp);
+    CHECK_EQ(Timestamp::fromNumerator(translationSpline.getMinTime()), startTimestamp);
+    CHECK_EQ(Timestamp::fromNumerator(translationSpline.getMaxTime()), endTimestamp);
+  });
   return true;
 }
 
@@ -288,57 +302,91 @@ void PoseTrajectory::addToBatch(const Activator & stateActivator, BatchStateRece
     LOG(INFO) << "Activating " << getName() << "'s splines.";
   }
   CHECK(state_);
-  state_->addToProblem(stateActive, problem);
+  state_->trajectory->addToProblem(stateActive, problem);
   batchStateReceiver.addBatchState(*this, state_);
 }
 
 void PoseTrajectory::addErrorTerms(CalibratorI & calib, const CalibrationConfI & ec, ErrorTermReceiver & problem) const {
   if(useTanConstraint && state_){
-    LOG(INFO) << "Adding soft constraints error terms.";
-
     const bool observerOnly = !ec.getStateActivator().isActive(*this) && !ec.getCalibrationActivator().isActive(*this);
+    addTangentialConstraintErrorTerms(calib, problem, observerOnly);
+  }
+}
 
-    auto & trajectory = getCurrentTrajectory();
-
-    Timestamp
-      minTime = calib.getCurrentEffectiveBatchInterval().start,
-      maxTime = calib.getCurrentEffectiveBatchInterval().end;
+typedef BlockedMeasurementErrorTerm<3, aslam::backend::EuclideanExpression> TangencyErrorTermBlock;
 
-    const double elapsedTime = maxTime - minTime;
+void PoseTrajectory::addTangentialConstraintErrorTerms(CalibratorI & calib, ErrorTermReceiver & problem, bool observeOnly) const {
+  LOG(INFO) << "Adding soft constraints error terms" << (tanConstraintPerSegment ? " per segment." : ".");
 
-    const int numSegments = std::ceil(getKnotsPerSecond() * 2 * elapsedTime);
-    const double tangentialVariance = tanConstraintVariance;
+  auto & trajectory = getCurrentTrajectory();
 
-    ErrorTermStatisticsWithProblemAndPredictor statWPAP(calib, "TangentialConstraint", problem, observerOnly);
-    ErrorTermGroupReference etgr(statWPAP.getName());
-    for (int i = 0; i < numSegments + 1 ; i++) {
-      Timestamp timestamp = minTime + Timestamp((double)i * elapsedTime / numSegments);
+  Timestamp
+    minTime = calib.getCurrentEffectiveBatchInterval().start,
+    maxTime = calib.getCurrentEffectiveBatchInterval().end;
 
-      auto translationExpressionFactory = trajectory.getTranslationSpline().getExpressionFactoryAt<1>(timestamp);
-      auto rotationExpressionFactory = trajectory.getRotationSpline().getExpressionFactoryAt<0>(timestamp);
+  const double elapsedTime = maxTime - minTime;
+  const Eigen::Matrix3d covariance = Eigen::Matrix3d::Identity() * tanConstraintVariance;
+  // The sampled constraint's density [1/s]. tanConstraintVariance refers to it.
+  const int numSamples = std::ceil(getKnotsPerSecond() * 2 * elapsedTime);
+  const double sampleDensity = numSamples / elapsedTime;
 
-      aslam::backend::EuclideanExpression v_r_mwl, v_r_mwr;
-      aslam::backend::RotationExpression R_m_r;
+  auto getTangencyConstraint = [&](Timestamp timestamp){
+    const auto relativeKinematics = trajectory.calcRelativeKinematics(timestamp, false, 1);
+    const aslam::backend::RotationExpression & R_m_r = relativeKinematics.R;
+    const aslam::backend::EuclideanExpression & v_m_mr = relativeKinematics.v;
+    const auto v_r_mr = R_m_r.inverse() * v_m_mr;
 
-      R_m_r = aslam::backend::Vector2RotationQuaternionExpressionAdapter::adapt(rotationExpressionFactory.getValueExpression());
-      const auto v_m_mr = translationExpressionFactory.getValueExpression(1);
-      const auto v_r_mr = R_m_r.inverse() * v_m_mr;
+    // Is it missing a constraint on the direction of the velocity?? By construction quaternion spline is not constrained to be tangent to the pose
+    // We should add that constraint. Possibly in Jerome case we could not see that since there was an error term on the veloctiy,
+    // That was constraining the local direction of versor i, in robot (vehicle frame). Otherwise rotation is not exactly well constrained
 
-      // Is it missing a constraint on the direction of the velocity?? By construction quaternion spline is not constrained to be tangent to the pose
-      // We should add that constraint. Possibly in Jerome case we could not see that since there was an error term on the veloctiy,
-      // That was constraining the local direction of versor i, in robot (vehicle frame). Otherwise rotation is not exactly well constrained
+    // TODO: B Add a constraint on the velocity to be parallel to the orientation i x v = 0
+    return v_r_mr.cross(aslam::backend::EuclideanExpression(Eigen::Vector3d(1.0, 0.0, 0.0)));
+  };
 
-      // TODO: B Add a constraint on the velocity to be parallel to the orientation i x v = 0
-      auto tangency_constraint = v_r_mr.cross(aslam::backend::EuclideanExpression(Eigen::Vector3d(1.0, 0.0, 0.0)));
-      auto e_tan = boost::make_shared<ErrorTermTangency>(tangency_constraint, Eigen::Vector3d(tangentialVariance, tangentialVariance, tangentialVariance).asDiagonal(), etgr);
+  ErrorTermStatisticsWithProblemAndPredictor statWPAP(calib, "TangentialConstraint", problem, observeOnly);
+  ErrorTermGroupReference etgr(statWPAP.getName());
+  if(tanConstraintPerSegment){
+    // The samples of one segment depend on the same design variables. One dense block per segment covers them all.
+    CHECK_GT(tanConstraintPointsPerSegment, 0);
+    // The segment boundaries, which need not be uniform (see knotPlacement).
+    std::vector<Timestamp> segmentKnots;
+    trajectory.visitSplines([&](const auto & rotationSpline, const auto & /* translationSpline */){
+      const auto knots = rotationSpline.getKnotsVector();
+      const int order = rotationSpline.getSplineOrder();
+      for(int k = order - 1; k <= int(knots.size()) - order; k++){
+        segmentKnots.push_back(Timestamp::fromNumerator(knots[k]));
+      }
+    });
+    for (size_t s = 0; s + 1 < segmentKnots.size(); s++) {
+      const double segmentDuration = double(segmentKnots[s + 1] - segmentKnots[s]);
+      // The segments need not match getKnotsPerSecond(). Scaling the covariance with the actual sample density keeps the total weight of the constraint.
+      const Eigen::Matrix3d segmentCovariance = covariance * (tanConstraintPointsPerSegment / segmentDuration / sampleDensity);
+      TangencyErrorTermBlock::Samples block;
+      for (int i = 0; i < tanConstraintPointsPerSegment; i++) {
+        // midpoint rule
+        Timestamp timestamp = segmentKnots[s] + Timestamp((i + 0.5) / tanConstraintPointsPerSegment * segmentDuration);
+        if(timestamp < minTime || timestamp > maxTime){
+          continue;
+        }
+        block.push_back({getTangencyConstraint(timestamp), Eigen::Vector3d::Zero(), segmentCovariance});
+      }
+      if(!block.empty()){
+        statWPAP.add(segmentKnots[s], boost::shared_ptr<TangencyErrorTermBlock>(new TangencyErrorTermBlock(std::move(block), etgr)));
+      }
+    }
+  } else {
+    for (int i = 0; i < numSamples + 1 ; i++) {
+      Timestamp timestamp = minTime + Timestamp((double)i * elapsedTime / numSamples);
+      auto e_tan = boost::make_shared<ErrorTermTangency>(getTangencyConstraint(timestamp), covariance, etgr);
       statWPAP.add(timestamp, e_tan);
     }
-    statWPAP.printInto(LOG(INFO));
   }
+  statWPAP.printInto(LOG(INFO));
 }
 
 void BaseTrajectoryBatchState::writeToFile(const CalibratorI & calib, const std::string& pathPrefix) const {
-  So3R3Trajectory::writeToFile(calib, pathPrefix);
+  trajectory->writeToFile(calib, pathPrefix);
 }
 
 PoseTrajectory::~PoseTrajectory() {
@@ -346,85 +394,28 @@ PoseTrajectory::~PoseTrajectory() {
 
 const So3R3Trajectory& PoseTrajectory::getCurrentTrajectory() const {
   CHECK(state_);
-  return *state_;
+  return *state_->trajectory;
 }
 
 So3R3Trajectory& PoseTrajectory::getCurrentTrajectory() {
   CHECK(state_);
-  return *state_;
+  return *state_->trajectory;
 }
 
 
 
-constexpr int getVariability(BoundedTimeExpression*){
-  return 1;
-}
-constexpr int getVariability(Timestamp*){
-  return 0;
-}
-
-template <typename T>
-constexpr int addVariablitiy(int i){
-  return i + getVariability(static_cast<T*>(nullptr));
-}
-
-using namespace aslam::backend;
-
-template <typename A>
-RelativeKinematicExpression computeTrajectoryFrame(A expressionFactories, bool needGlobalPosition, int maximalDerivativeOrder){
-  return RelativeKinematicExpression(
-        //TODO O The adapter is a big waste of time. There are more direct ways (UnitQuaternion expressions ..)
-        Vector2RotationQuaternionExpressionAdapter::adapt(expressionFactories.rot.getValueExpression()),
-        needGlobalPosition ? expressionFactories.trans.getValueExpression(0) : EuclideanExpression(),
-            // the following two negations of the angular derivatives are necessary because the
-            // B-spline implementation assumes global to local usage while we use it local to global
-            // here.
-            // TODO: various usages should be supported by the splines physical values!
-        maximalDerivativeOrder >= 1 ? -EuclideanExpression(expressionFactories.rot.getAngularVelocityExpression()) : EuclideanExpression(),
-        maximalDerivativeOrder >= 1 ? EuclideanExpression(expressionFactories.trans.getValueExpression(1)) : EuclideanExpression(),
-        maximalDerivativeOrder >= 2 ? -EuclideanExpression(expressionFactories.rot.getAngularAccelerationExpression()) : EuclideanExpression(),
-        maximalDerivativeOrder >= 2 ? EuclideanExpression(expressionFactories.trans.getValueExpression(2)) : EuclideanExpression()
-      );
-}
-
-template <typename Time>
-RelativeKinematicExpression computeTrajectoryFrame(
-    const So3R3Trajectory & trajectory, Time timestamp,
-    bool needGlobalPosition, int maximalDerivativeOrder){
-
-  auto computeFrame = [&](auto expressionFactories){
-    return computeTrajectoryFrame(
-        expressionFactories,
-        needGlobalPosition, maximalDerivativeOrder
-      );
-  };
-  switch(addVariablitiy<Time>(maximalDerivativeOrder)){
-    case 0:
-    case 1:
-    case 2: //TODO O support maximalDerivativeOrder_ below 2 in getCoordinateFrame above properly (requires turning off accelerations in computeTrajectoryFrame for that case!
-      return computeFrame(trajectory.getExpressionFactoryPair<2>(timestamp));
-    case 3:
-      return computeFrame(trajectory.getExpressionFactoryPair<3>(timestamp));
-    case 4:
-      return computeFrame(trajectory.getExpressionFactoryPair<4>(timestamp));
-    default:
-      LOG(FATAL) << "Unsupported maximal derivative order " << maximalDerivativeOrder << " for time type " << typeid(Time).name();
-      throw 0; // dummy
-  }
-}
-
 RelativeKinematicExpression PoseTrajectory::calcRelativeKinematics(
     Timestamp at, const ModelSimplification& simplification,
     const size_t maximalDerivativeOrder) const
 {
-  return computeTrajectoryFrame(getCurrentTrajectory(), at, simplification.needGlobalOrientation, maximalDerivativeOrder);
+  return getCurrentTrajectory().calcRelativeKinematics(at, simplification.needGlobalOrientation, maximalDerivativeOrder);
 }
 
 RelativeKinematicExpression PoseTrajectory::calcRelativeKinematics(
     const BoundedTimeExpression& at, const ModelSimplification& simplification,
     const size_t maximalDerivativeOrder) const
 {
-  return computeTrajectoryFrame(getCurrentTrajectory(), at, simplification.needGlobalOrientation, maximalDerivativeOrder);
+  return getCurrentTrajectory().calcRelativeKinematics(at, simplification.needGlobalOrientation, maximalDerivativeOrder);
 }
 } /* namespace calibration */
 } /* namespace aslam */
@@ -34,7 +34,8 @@ Sensor::Sensor(Model & model, std::string name, ValueStoreRef config) :
     CalibratableMinimal(this),
     id(isUsed()? model.createNewSensorId() : NoSensorId),
     maximalExpectedGap(config.getDouble(name + "/maximalExpectedGap", -1.0)), //TODO C RENAME maximalExpectedGap to expectedMaximalGap
-    mEstimator(getMestimator(name, getMyConfig().getChild("mestimator"), 1))
+    mEstimator(getMestimator(name, getMyConfig().getChild("mestimator"), 1)),
+    measurementSelector(getMyConfig().getChild("measurementSelection"))
 {
 }
 
@@ -47,6 +48,10 @@ void Sensor::writeConfig(std::ostream& out) const {
   MODULE_WRITE_PARAM(hasTranslation());
   MODULE_WRITE_PARAM(hasRotation());
   MODULE_WRITE_PARAM(hasDelay());
+  if(measurementSelector.isUsed()){
+    MODULE_WRITE_PARAM(measurementSelector.getMaxMeasurements());
+    MODULE_WRITE_PARAM(measurementSelector.getWindowDuration());
+  }
 }
 
 void Sensor::registerWithModel() {
@@ -82,7 +87,7 @@ aslam::backend::TransformationExpression Sensor::getTransformationExpressionToAt
   if(hasDelay()){
     if (!ignoreBounds && (!calib.getCurrentEffectiveBatchInterval().contains(t, *this)))
       return aslam::backend::TransformationExpression();
-    return getTransformationExpressionTo(calib.getModelAt(getBoundedTimestampExpression(calib, t), 0, {true}), to);
+    return getTransformationExpressionTo(calib.getModelAt(*this, t, 0, {true}), to);
   } else {
     if (!ignoreBounds && !calib.getCurrentEffectiveBatchInterval().contains(t))
       return aslam::backend::TransformationExpression();
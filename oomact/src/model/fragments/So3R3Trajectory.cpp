@@ -1,15 +1,30 @@
 #include <aslam/calibration/model/fragments/So3R3Trajectory.h>
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <type_traits>
+
+#include <aslam/backend/EuclideanExpression.hpp>
 #include <aslam/backend/QuadraticIntegralError.hpp>
+#include <aslam/backend/RotationExpression.hpp>
+#include <aslam/backend/Vector2RotationQuaternionExpressionAdapter.hpp>
 #include <aslam/backend/VectorExpression.hpp>
 #include <bsplines/BSplineFitter.hpp>
 #include <glog/logging.h>
 
+#include <aslam/calibration/algo/BSplineGramMatrix.h>
+#include <aslam/calibration/algo/KnotPlacement.h>
 #include "aslam/calibration/calibrator/CalibratorI.h"
+#include <aslam/calibration/model/FrameLinkI.h>
 #include <aslam/calibration/model/fragments/So3R3TrajectoryCarrier.h>
 #include <aslam/calibration/tools/SplineWriter.h>
 #include <aslam/calibration/DesignVariableReceiver.h>
+#include <aslam/calibration/error-terms/ErrorTermSplineDerivativeIntegral.h>
 #include <aslam/calibration/tools/ErrorTermStatistics.h>
+#include <aslam/calibration/tools/SplineSegmentBracket.h>
+#include <aslam/calibration/tools/ThreadPool.h>
+#include <aslam/calibration/tools/UnitQuaternionRotationExpression.h>
 
 using aslam::backend::VectorExpression;
 using aslam::backend::ErrorTermReceiver;
@@ -17,13 +32,34 @@ using aslam::backend::ErrorTermReceiver;
 namespace aslam {
 namespace calibration {
 
-So3R3Trajectory::So3R3Trajectory(const So3R3TrajectoryCarrier & carrier) :
+So3R3Trajectory::~So3R3Trajectory() {
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::So3R3TrajectoryT(const So3R3TrajectoryCarrier & carrier) :
+  So3R3Trajectory(carrier),
   rotationSpline(carrier.getRotSplineOrder()),
-  translationSpline(carrier.getTransSplineOrder()),
-  carrier(carrier)
+  translationSpline(carrier.getTransSplineOrder())
 {
 	static_assert(std::is_same<sm::timing::NsecTime, Timestamp::Integer>::value, "");
 	static_assert(1e9 == Timestamp::getDivider(), "");
+	CHECK_EQ(carrier.getRotSplineOrder(), rotationSpline.getSplineOrder());
+	CHECK_EQ(carrier.getTransSplineOrder(), translationSpline.getSplineOrder());
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+sm::timing::NsecTime So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::getMinTime() const {
+  return rotationSpline.getMinTime();
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+sm::timing::NsecTime So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::getMaxTime() const {
+  return rotationSpline.getMaxTime();
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+size_t So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::numDesignVariables() const {
+  return rotationSpline.numDesignVariables() + translationSpline.numDesignVariables();
 }
 
 
@@ -72,53 +108,250 @@ void addWhiteNoiseModelErrorTerms(ErrorTermReceiver & errorTermReceiver, const S
   LOG(INFO) << "Total initial cost " << name << ": " << integrationFunctor.calcIntegral();
 }
 
-void So3R3Trajectory::addWhiteNoiseModelErrorTerms(ErrorTermReceiver & errorTermReceiver, std::string name, const double invSigma) const {
-  calibration::addWhiteNoiseModelErrorTerms(errorTermReceiver, getTranslationSpline(), [&](const TranslationSpline & bspline, typename TranslationSpline::time_t time){ return bspline.getExpressionFactoryAt<2>(time).getValueExpression(2);}, name + "WhiteNoiseAcceleration", Eigen::Matrix3d::Identity() * invSigma);
-  calibration::addWhiteNoiseModelErrorTerms(errorTermReceiver, getRotationSpline(), [&](const RotationSpline & bspline, typename RotationSpline::time_t time){ return bspline.getExpressionFactoryAt<2>(time).getAngularAccelerationExpression();}, name + "WhiteNoiseAngularAcceleration", Eigen::Matrix3d::Identity() * invSigma);
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::addWhiteNoiseModelErrorTerms(ErrorTermReceiver & errorTermReceiver, std::string name, const double invSigma) const {
+  // The acceleration is linear in the translation spline's coefficients. Its squared integral is therefore exact per segment.
+  LOG(INFO) << "Adding " << getTranslationSpline().getAbsoluteNumberOfSegments() << " " << name << "WhiteNoiseAcceleration error terms";
+  const double translationCost = addSplineDerivativeIntegralErrorTerms(errorTermReceiver, getTranslationSpline(), 2, Eigen::Matrix3d::Identity() * invSigma);
+  LOG(INFO) << "Total initial cost " << name << "WhiteNoiseAcceleration: " << translationCost;
+  calibration::addWhiteNoiseModelErrorTerms(errorTermReceiver, getRotationSpline(), [&](const RotationSpline & bspline, typename RotationSpline::time_t time){ return bspline.template getExpressionFactoryAt<2>(time).getAngularAccelerationExpression();}, name + "WhiteNoiseAngularAcceleration", Eigen::Matrix3d::Identity() * invSigma);
 }
 
 
-void So3R3Trajectory::addToProblem(const bool stateActive, DesignVariableReceiver & problem) {
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::addToProblem(const bool stateActive, DesignVariableReceiver & problem) {
   problem.addSplineDesignVariables(rotationSpline, stateActive);
   problem.addSplineDesignVariables(translationSpline, stateActive);
 }
 
 
-void So3R3Trajectory::writeToFile(const CalibratorI& calib, const std::string& pathPrefix) const {
-  writeSpline(translationSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + "trans");
-  writeSpline(rotationSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + "rot");
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::writeToFile(const CalibratorI& calib, const std::string& pathPrefix) const {
+  ThreadPool & pool = calib.getThreadPool();
+  TaskGroup group;
+  pool.run(group, [&](){
+    writeEuclideanSpline(translationSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + "trans", pool);
+  });
+  pool.run(group, [&](){
+    writeSpline(rotationSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + "rot", pool);
+  });
+  pool.wait(group);
 }
 
-void So3R3Trajectory::fitSplines(const Interval& effectiveBatchInterval, const size_t numMeasurements, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses) {
-  const double elapsedTime = effectiveBatchInterval.getElapsedTime();
-  const int measPerSec = std::round(numMeasurements / elapsedTime);
-  int numSegments;
-  double splineKnotsPerSecond = getCarrier().getKnotsPerSecond();
-  if (measPerSec > splineKnotsPerSecond)
-    numSegments = std::ceil(splineKnotsPerSecond * elapsedTime);
-  else
-    numSegments = numMeasurements;
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::sample(const std::vector<sm::timing::NsecTime> & times, So3R3TrajectorySamples & samples) const {
+  const size_t n = times.size();
+  samples.times = times;
+  samples.positions.resize(3, n);
+  samples.velocities.resize(3, n);
+  samples.accelerations.resize(3, n);
+  samples.orientations.resize(4, n);
+  samples.angularVelocities.resize(3, n);
+  samples.angularAccelerations.resize(3, n);
+  EuclideanSplineSampler<TranslationSplineT> translationSampler(translationSpline);
+  for(size_t i = 0; i < n; i++){
+    DCHECK(i == 0 || times[i - 1] <= times[i]) << "The times must be sorted!";
+    translationSampler.moveTo(times[i]);
+    samples.positions.col(i) = translationSampler.evalD(0);
+    samples.velocities.col(i) = translationSampler.evalD(1);
+    samples.accelerations.col(i) = translationSampler.evalD(2);
+
+    // The rotation spline is not linear in its control vertices. Hence, it uses the spline's own evaluator.
+    const auto rotEvaluator = rotationSpline.template getEvaluatorAt<2>(times[i]);
+    samples.orientations.col(i) = rotEvaluator.eval();
+    // The splines assume global to local usage (see computeTrajectoryFrame in PoseTrajectory.cpp).
+    samples.angularVelocities.col(i) = -rotEvaluator.evalAngularVelocity();
+    samples.angularAccelerations.col(i) = -rotEvaluator.evalAngularAcceleration();
+  }
+}
 
+/**
+ * Fit spline with numSegments uniform segments on interval to points.
+ * With options.chunkSegments > 0 the spline is fitted in chunks of that many segments, each extended by options.overlapSegments on both sides.
+ * Every chunk only contributes the control vertices centered in its own (not extended) part. Because neighboring chunks agree on the control vertices
+ * around their boundary up to the influence of the far away data, the stitched spline is continuous and close to the global fit, while
+ * memory and time grow linearly with numSegments. A chunk with less than order measurements gets extended further until it has enough.
+ */
+template <typename Spline, typename Point>
+void fitUniformSpline(Spline & spline, const Interval & interval, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Point> & points, const int numSegments, const double lambda, const SplineFittingOptions & options, ThreadPool & pool) {
+  const sm::timing::NsecTime start = interval.start.getNumerator(), end = interval.end.getNumerator();
+  if(options.chunkSegments <= 0 || numSegments <= options.chunkSegments){
+    bsplines::BSplineFitter<Spline>::initUniformSpline(spline, start, end, timestamps, points, numSegments, lambda);
+    return;
+  }
+
+  CHECK(!points.empty());
+  spline.initConstantUniformSpline(start, end, numSegments, points.front());
+  const int order = spline.getSplineOrder();
+  const int numControlVertices = spline.numDesignVariables();
+  CHECK_EQ(numSegments + order - 1, numControlVertices) << "Unexpected knot layout!";
+
+  const int overlap = std::max(options.overlapSegments, order);
+  const int numChunks = (numSegments + options.chunkSegments - 1) / options.chunkSegments;
+  auto getSegmentStart = [&](int segment){
+    return start + sm::timing::NsecTime(std::llround(double(end - start) * segment / numSegments));
+  };
+  // Control vertex i has its support centered on segment i - (order - 1) / 2.
+  auto getFirstOwnedControlVertex = [&](int chunk){
+    return chunk == 0 ? 0 : (chunk == numChunks ? numControlVertices : chunk * options.chunkSegments + (order - 1) / 2);
+  };
+  LOG(INFO) << "Fitting " << numSegments << " segments in " << numChunks << " chunks of " << options.chunkSegments << " segments overlapping by " << overlap << ".";
+
+  pool.parallelFor(0, numChunks, [&](size_t chunk){
+    const int coreBegin = chunk * options.chunkSegments, coreEnd = std::min(numSegments, coreBegin + options.chunkSegments);
+    int fitBegin = std::max(0, coreBegin - overlap), fitEnd = std::min(numSegments, coreEnd + overlap);
+    sm::timing::NsecTime fitStart, fitStop;
+    std::ptrdiff_t b, e;
+    auto findSamples = [&](){
+      fitStart = getSegmentStart(fitBegin);
+      fitStop = getSegmentStart(fitEnd);
+      b = std::lower_bound(timestamps.begin(), timestamps.end(), fitStart) - timestamps.begin();
+      e = std::upper_bound(timestamps.begin(), timestamps.end(), fitStop) - timestamps.begin();
+    };
+    findSamples();
+    // A chunk within a gap of the data gets widened until it reaches the data around the gap, which determines its control vertices.
+    while(e - b < order && (fitBegin > 0 || fitEnd < numSegments)){
+      fitBegin = std::max(0, fitBegin - overlap);
+      fitEnd = std::min(numSegments, fitEnd + overlap);
+      findSamples();
+    }
+    if(e - b < 2){
+      LOG(WARNING) << "Not enough measurements to fit the spline on [" << fitStart << ", " << fitStop << "]. Keeping it constant.";
+      return;
+    }
+    const std::vector<sm::timing::NsecTime> chunkTimestamps(timestamps.begin() + b, timestamps.begin() + e);
+    const std::vector<Point> chunkPoints(points.begin() + b, points.begin() + e);
+
+    Spline chunkSpline(order);
+    bsplines::BSplineFitter<Spline>::initUniformSpline(chunkSpline, fitStart, fitStop, chunkTimestamps, chunkPoints, fitEnd - fitBegin, lambda * double(fitStop - fitStart) / double(end - start));
+    Eigen::MatrixXd controlVertex;
+    for(int i = getFirstOwnedControlVertex(chunk); i < getFirstOwnedControlVertex(chunk + 1); i++){
+      chunkSpline.designVariable(i - fitBegin)->getParameters(controlVertex);
+      spline.designVariable(i)->setParameters(controlVertex);
+    }
+  }, 1);
+}
+
+namespace {
+Eigen::MatrixXd toFittingPoints(const std::vector<Eigen::Vector3d> & points) {
+  Eigen::MatrixXd m(3, points.size());
+  for(size_t i = 0; i < points.size(); i++){
+    m.col(i) = points[i];
+  }
+  return m;
+}
+/// The quaternions' signs get aligned with their predecessors to make the components continuous.
+Eigen::MatrixXd toFittingPoints(const std::vector<Eigen::Vector4d> & quaternions) {
+  Eigen::MatrixXd m(4, quaternions.size());
+  for(size_t i = 0; i < quaternions.size(); i++){
+    m.col(i) = quaternions[i];
+    if(i > 0 && m.col(i).dot(m.col(i - 1)) < 0){
+      m.col(i) *= -1;
+    }
+  }
+  return m;
+}
+void toControlVertex(const Eigen::VectorXd & c, Eigen::Vector3d & cv) {
+  cv = c;
+}
+void toControlVertex(const Eigen::VectorXd & c, Eigen::Vector4d & cv) {
+  cv = c.normalized();
+}
+}
+
+/**
+ * Fit spline to points with the segment boundaries segmentKnots (ascending, at least two) by fitBSplineControlVertices.
+ * The knots beyond both ends continue the first and last segment's length.
+ * A unit quaternion spline gets fitted component wise with normalized control vertices, which is close enough to its least squares fit to initialize the trajectory.
+ */
+template <typename Spline, typename Point>
+void fitNonUniformSpline(Spline & spline, const std::vector<sm::timing::NsecTime> & segmentKnots, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Point> & points, const double lambda) {
+  CHECK_GE(segmentKnots.size(), 2u);
+  const int order = spline.getSplineOrder();
+  const sm::timing::NsecTime firstLength = segmentKnots[1] - segmentKnots[0], lastLength = segmentKnots.back() - segmentKnots[segmentKnots.size() - 2];
+  std::vector<sm::timing::NsecTime> knots;
+  for(int i = order - 1; i > 0; i--){
+    knots.push_back(segmentKnots.front() - i * firstLength);
+  }
+  knots.insert(knots.end(), segmentKnots.begin(), segmentKnots.end());
+  for(int i = 1; i < order; i++){
+    knots.push_back(segmentKnots.back() + i * lastLength);
+  }
+
+  // In seconds since the first segment to keep the precision of the nanosecond timestamps.
+  auto toSeconds = [&](sm::timing::NsecTime t){ return (t - segmentKnots.front()) * 1e-9; };
+  std::vector<double> knotSeconds(knots.size()), timeSeconds(timestamps.size());
+  std::transform(knots.begin(), knots.end(), knotSeconds.begin(), toSeconds);
+  std::transform(timestamps.begin(), timestamps.end(), timeSeconds.begin(), toSeconds);
+
+  const Eigen::MatrixXd fit = fitBSplineControlVertices(knotSeconds, order, timeSeconds, toFittingPoints(points), lambda);
+  std::vector<Point> controlVertices(fit.cols());
+  for(int i = 0; i < fit.cols(); i++){
+    toControlVertex(fit.col(i), controlVertices[i]);
+  }
+  spline.initWithKnotsAndControlVertices(knots, controlVertices);
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::fitSplines(const Interval& effectiveBatchInterval, const size_t numMeasurements, const std::vector<sm::timing::NsecTime> & timestamps, const std::vector<Eigen::Vector3d> & transPoses, const std::vector<Eigen::Vector4d> & rotPoses, ThreadPool & pool) {
+  const double elapsedTime = effectiveBatchInterval.getElapsedTime();
   const double rotSplineLambda = getCarrier().getRotFittingLambda() * elapsedTime;
   const double transSplineLambda = getCarrier().getTransFittingLambda() * elapsedTime;
-  LOG(INFO)<< "Using for the " << getCarrier().getName() << " splines numSegments=" << numSegments << ", because the batch is " << elapsedTime << "s long and splineKnotsPerSecond=" << splineKnotsPerSecond << ", rotFittingLambda=" << getCarrier().getRotFittingLambda() << ", transFittingLambda=" << getCarrier().getTransFittingLambda();
 
-  bsplines::BSplineFitter<TranslationSpline>::initUniformSpline(getTranslationSpline(), effectiveBatchInterval.start, effectiveBatchInterval.end, timestamps, transPoses, numSegments, transSplineLambda);
-  bsplines::BSplineFitter<RotationSpline>::initUniformSpline(getRotationSpline(), effectiveBatchInterval.start, effectiveBatchInterval.end, timestamps, rotPoses, numSegments, rotSplineLambda);
+  if (getCarrier().isUsingAdaptiveKnots() && timestamps.size() >= 2) {
+    // The knot rate is the budget for the whole batch. Within it the knots follow the local dynamics of the motion.
+    const int maxSegments = std::max<int>(1, std::ceil(getCarrier().getKnotsPerSecond() * elapsedTime));
+    std::vector<sm::timing::NsecTime> knots = placeKnots(timestamps, computeLocalKnotsPerSecond(timestamps, transPoses, rotPoses, getCarrier().getAdaptiveKnotOptions()), maxSegments);
+    // The splines must cover the whole batch.
+    knots.front() = std::min(knots.front(), effectiveBatchInterval.start.getNumerator());
+    knots.back() = std::max(knots.back(), effectiveBatchInterval.end.getNumerator());
+    LOG(INFO)<< "Using for the " << getCarrier().getName() << " splines " << knots.size() - 1 << " segments placed by the motion's dynamics (at most " << maxSegments << " for knotsPerSecond=" << getCarrier().getKnotsPerSecond() << "), rotFittingLambda=" << getCarrier().getRotFittingLambda() << ", transFittingLambda=" << getCarrier().getTransFittingLambda();
+
+    TaskGroup group;
+    pool.run(group, [&](){
+      fitNonUniformSpline(getTranslationSpline(), knots, timestamps, transPoses, transSplineLambda);
+    });
+    pool.run(group, [&](){
+      fitNonUniformSpline(getRotationSpline(), knots, timestamps, rotPoses, rotSplineLambda);
+    });
+    pool.wait(group);
+  } else {
+    const int measPerSec = std::round(numMeasurements / elapsedTime);
+    int numSegments;
+    const double splineKnotsPerSecond = getCarrier().getKnotsPerSecond();
+    if (measPerSec > splineKnotsPerSecond)
+      numSegments = std::max<int>(1, std::ceil(splineKnotsPerSecond * elapsedTime));
+    else
+      numSegments = numMeasurements;
+    LOG(INFO)<< "Using for the " << getCarrier().getName() << " splines numSegments=" << numSegments << ", because the batch is " << elapsedTime << "s long and splineKnotsPerSecond=" << splineKnotsPerSecond << ", rotFittingLambda=" << getCarrier().getRotFittingLambda() << ", transFittingLambda=" << getCarrier().getTransFittingLambda();
+
+    // The two fits are independent.
+    const SplineFittingOptions & fittingOptions = getCarrier().getFittingOptions();
+    TaskGroup group;
+    pool.run(group, [&](){
+      fitUniformSpline(getTranslationSpline(), effectiveBatchInterval, timestamps, transPoses, numSegments, transSplineLambda, fittingOptions, pool);
+    });
+    pool.run(group, [&](){
+      fitUniformSpline(getRotationSpline(), effectiveBatchInterval, timestamps, rotPoses, numSegments, rotSplineLambda, fittingOptions, pool);
+    });
+    pool.wait(group);
+  }
+  updateKnotTable();
 
   if(VLOG_IS_ON(1)){
     LOG(INFO) << "Computing initial offset statistics.";
     ErrorTermStatistics statRot(getCarrier().getName() + "_rot[deg]"), statTrans(getCarrier().getName() + "_trans[1]");
     for(size_t i = 0; i < timestamps.size(); i++){
-      statTrans.add(pow((getTranslationSpline().getEvaluatorAt<0>(timestamps[i]).eval() - transPoses[i]).norm(), 2));
-      statRot.add(sm::kinematics::rad2deg(pow(sm::kinematics::quat2AxisAngle(sm::kinematics::qplus(getRotationSpline().getEvaluatorAt<0>(timestamps[i]).eval(), sm::kinematics::quatInv(rotPoses[i]))).norm(), 2)));
+      statTrans.add(pow((getTranslationSpline().template getEvaluatorAt<0>(timestamps[i]).eval() - transPoses[i]).norm(), 2));
+      statRot.add(sm::kinematics::rad2deg(pow(sm::kinematics::quat2AxisAngle(sm::kinematics::qplus(getRotationSpline().template getEvaluatorAt<0>(timestamps[i]).eval(), sm::kinematics::quatInv(rotPoses[i]))).norm(), 2)));
     }
     statTrans.printInto(LOG(INFO));
     statRot.printInto(LOG(INFO));
   }
 }
 
-void So3R3Trajectory::initSplinesConstant(const Interval& effectiveBatchInterval, const size_t numMeasurements, const Eigen::Vector3d & transPose, const Eigen::Vector4d & rotPose) {
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::initSplinesConstant(const Interval& effectiveBatchInterval, const size_t numMeasurements, const Eigen::Vector3d & transPose, const Eigen::Vector4d & rotPose) {
   const double elapsedTime = effectiveBatchInterval.getElapsedTime();
   const int measPerSec = std::round(numMeasurements / elapsedTime);
   int numSegments;
@@ -132,8 +365,124 @@ void So3R3Trajectory::initSplinesConstant(const Interval& effectiveBatchInterval
 
   getTranslationSpline().initConstantUniformSpline(effectiveBatchInterval.start, effectiveBatchInterval.end, numSegments, transPose);
   getRotationSpline().initConstantUniformSpline(effectiveBatchInterval.start, effectiveBatchInterval.end, numSegments, rotPose);
+  updateKnotTable();
 }
 
+template <typename RotationSplineT, typename TranslationSplineT>
+void So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::updateKnotTable() {
+  translationKnots.update(getTranslationSpline());
+}
+
+
+backend::RotationExpression getRotationExpression(const So3R3TrajectoryCarrier & carrier, const backend::VectorExpression<4> & q){
+  if(carrier.isUsingDirectRotationExpression()){
+    return toUnitQuaternionRotationExpression(q);
+  }
+  return backend::Vector2RotationQuaternionExpressionAdapter::adapt(q);
+}
+
+constexpr int getVariability(BoundedTimeExpression*){
+  return 1;
+}
+constexpr int getVariability(Timestamp*){
+  return 0;
+}
+
+template <typename T>
+constexpr int addVariablitiy(int i){
+  return i + getVariability(static_cast<T*>(nullptr));
+}
+
+template <typename A>
+RelativeKinematicExpression computeTrajectoryFrame(const So3R3TrajectoryCarrier & carrier, A expressionFactories, bool needGlobalPosition, int maximalDerivativeOrder){
+  return RelativeKinematicExpression(
+        getRotationExpression(carrier, expressionFactories.rot.getValueExpression()),
+        needGlobalPosition ? expressionFactories.trans.getValueExpression(0) : backend::EuclideanExpression(),
+            // the following two negations of the angular derivatives are necessary because the
+            // B-spline implementation assumes global to local usage while we use it local to global
+            // here.
+            // TODO: various usages should be supported by the splines physical values!
+        maximalDerivativeOrder >= 1 ? -backend::EuclideanExpression(expressionFactories.rot.getAngularVelocityExpression()) : backend::EuclideanExpression(),
+        maximalDerivativeOrder >= 1 ? backend::EuclideanExpression(expressionFactories.trans.getValueExpression(1)) : backend::EuclideanExpression(),
+        maximalDerivativeOrder >= 2 ? -backend::EuclideanExpression(expressionFactories.rot.getAngularAccelerationExpression()) : backend::EuclideanExpression(),
+        maximalDerivativeOrder >= 2 ? backend::EuclideanExpression(expressionFactories.trans.getValueExpression(2)) : backend::EuclideanExpression()
+      );
+}
+
+/**
+ * A translation expression factory for a bounded time expression.
+ * Its expressions locate the spline segment within a SplineSegmentBracket instead of searching the whole knot sequence on every evaluation.
+ */
+struct BracketedTranslationExpressionFactory {
+  std::shared_ptr<const SplineSegmentBracket> bracket;
+  backend::GenericScalarExpression<Timestamp> t;
+
+  backend::EuclideanExpression getValueExpression(int derivative) const {
+    return createEuclideanSplineExpression(bracket, t, derivative);
+  }
+};
+
+/// getExpressionFactories(std::integral_constant<int, MaxDerivative>()) must return the expression factory pair for MaxDerivative.
+template <typename Trajectory, typename Time, typename GetExpressionFactories>
+RelativeKinematicExpression computeTrajectoryFrame(
+    const Trajectory & trajectory, bool needGlobalPosition, int maximalDerivativeOrder,
+    GetExpressionFactories getExpressionFactories){
+
+  auto computeFrame = [&](auto expressionFactories){
+    return computeTrajectoryFrame(
+        trajectory.getCarrier(),
+        expressionFactories,
+        needGlobalPosition, maximalDerivativeOrder
+      );
+  };
+  switch(addVariablitiy<Time>(maximalDerivativeOrder)){
+    case 0:
+    case 1:
+    case 2: //TODO O support maximalDerivativeOrder_ below 2 in getCoordinateFrame above properly (requires turning off accelerations in computeTrajectoryFrame for that case!
+      return computeFrame(getExpressionFactories(std::integral_constant<int, 2>()));
+    case 3:
+      return computeFrame(getExpressionFactories(std::integral_constant<int, 3>()));
+    case 4:
+      return computeFrame(getExpressionFactories(std::integral_constant<int, 4>()));
+    default:
+      LOG(FATAL) << "Unsupported maximal derivative order " << maximalDerivativeOrder << " for time type " << typeid(Time).name();
+      throw 0; // dummy
+  }
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+RelativeKinematicExpression So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::calcRelativeKinematics(Timestamp at, bool needGlobalPosition, int maximalDerivativeOrder) const {
+  return computeTrajectoryFrame<So3R3TrajectoryT, Timestamp>(*this, needGlobalPosition, maximalDerivativeOrder, [&](auto maxDerivative){
+    return this->template getExpressionFactoryPair<decltype(maxDerivative)::value>(at);
+  });
+}
+
+template <typename RotationSplineT, typename TranslationSplineT>
+RelativeKinematicExpression So3R3TrajectoryT<RotationSplineT, TranslationSplineT>::calcRelativeKinematics(const BoundedTimeExpression & at, bool needGlobalPosition, int maximalDerivativeOrder) const {
+  CHECK(translationKnots.matches(getTranslationSpline())) << "The knot table of " << getCarrier().getName() << " is out of date. The splines must only get initialized by fitSplines or initSplinesConstant.";
+  // The rotation spline is not linear in its control vertices. Hence, it keeps using its own expression factory.
+  const BracketedTranslationExpressionFactory trans{translationKnots.createBracket(at.lBound, at.uBound), at.timestampExpresion};
+  return computeTrajectoryFrame<So3R3TrajectoryT, BoundedTimeExpression>(*this, needGlobalPosition, maximalDerivativeOrder, [&](auto maxDerivative){
+    auto rot = getEF<decltype(maxDerivative)::value>(getRotationSpline(), at);
+    return ExpressionFactoryPair<decltype(rot), BracketedTranslationExpressionFactory>{rot, trans};
+  });
+}
+
+template class So3R3TrajectoryT<So3R3Splines<Eigen::Dynamic>::RotationSpline, So3R3Splines<Eigen::Dynamic>::TranslationSpline>;
+template class So3R3TrajectoryT<So3R3Splines<4>::RotationSpline, So3R3Splines<4>::TranslationSpline>;
+template class So3R3TrajectoryT<So3R3Splines<6>::RotationSpline, So3R3Splines<6>::TranslationSpline>;
+
+std::unique_ptr<So3R3Trajectory> createSo3R3Trajectory(const So3R3TrajectoryCarrier & carrier) {
+  const int rotOrder = carrier.getRotSplineOrder(), transOrder = carrier.getTransSplineOrder();
+  if(rotOrder == 4 && transOrder == 4){
+    return std::unique_ptr<So3R3Trajectory>(new Order4So3R3Trajectory(carrier));
+  }
+  if(rotOrder == 6 && transOrder == 6){
+    return std::unique_ptr<So3R3Trajectory>(new Order6So3R3Trajectory(carrier));
+  }
+  VLOG(1) << "Using dynamic order splines for " << carrier.getName() << " (rotSplineOrder=" << rotOrder << ", transSplineOrder=" << transOrder << ").";
+  return std::unique_ptr<So3R3Trajectory>(new DynamicOrderSo3R3Trajectory(carrier));
+}
 
 } /* namespace calibration */
 } /* namespace aslam */
@@ -1,6 +1,8 @@
 #include <aslam/calibration/model/fragments/TrajectoryCarrier.h>
 
 #include <ostream>
+#include <stdexcept>
+#include <string>
 
 #include "aslam/calibration/model/Model.h"
 #include <aslam/calibration/model/ModuleTools.h>
@@ -14,8 +16,24 @@ So3R3TrajectoryCarrier::So3R3TrajectoryCarrier(sm::value_store::ValueStoreRef co
   rotSplineOrder(config.getInt("rotSplineOrder")),
   transSplineOrder(config.getInt("transSplineOrder")),
   rotFittingLambda(config.getDouble("rotFittingLambda")),
-  transFittingLambda(config.getDouble("transFittingLambda"))
+  transFittingLambda(config.getDouble("transFittingLambda")),
+  directRotationExpression(config.getBool("directRotationExpression", true))
 {
+  const std::string knotPlacement = config.getString("knotPlacement", "uniform");
+  if(knotPlacement != "uniform" && knotPlacement != "adaptive"){
+    throw std::runtime_error("Unsupported knotPlacement '" + knotPlacement + "' (uniform or adaptive expected)!");
+  }
+  adaptiveKnots = knotPlacement == "adaptive";
+
+  auto adaptiveConfig = config.getChild("adaptiveKnots");
+  adaptiveKnotOptions.positionTolerance = adaptiveConfig.getDouble("positionTolerance", adaptiveKnotOptions.positionTolerance);
+  adaptiveKnotOptions.rotationTolerance = adaptiveConfig.getDouble("rotationTolerance", adaptiveKnotOptions.rotationTolerance);
+  adaptiveKnotOptions.smoothingDuration = adaptiveConfig.getDouble("smoothingDuration", adaptiveKnotOptions.smoothingDuration);
+  adaptiveKnotOptions.minKnotsPerSecond = adaptiveConfig.getDouble("minKnotsPerSecond", adaptiveKnotOptions.minKnotsPerSecond);
+
+  auto fittingConfig = config.getChild("fitting");
+  fittingOptions.chunkSegments = fittingConfig.getInt("chunkSegments", fittingOptions.chunkSegments);
+  fittingOptions.overlapSegments = fittingConfig.getInt("overlapSegments", fittingOptions.overlapSegments);
 }
 
 void So3R3TrajectoryCarrier::writeConfig(std::ostream& out) const {
@@ -24,6 +42,18 @@ void So3R3TrajectoryCarrier::writeConfig(std::ostream& out) const {
   MODULE_WRITE_PARAM(rotFittingLambda);
   MODULE_WRITE_PARAM(transSplineOrder);
   MODULE_WRITE_PARAM(transFittingLambda);
+  MODULE_WRITE_PARAM(directRotationExpression);
+  MODULE_WRITE_PARAM(adaptiveKnots);
+  if(adaptiveKnots){
+    writeParam(out, "adaptiveKnots/positionTolerance", adaptiveKnotOptions.positionTolerance);
+    writeParam(out, "adaptiveKnots/rotationTolerance", adaptiveKnotOptions.rotationTolerance);
+    writeParam(out, "adaptiveKnots/smoothingDuration", adaptiveKnotOptions.smoothingDuration);
+    writeParam(out, "adaptiveKnots/minKnotsPerSecond", adaptiveKnotOptions.minKnotsPerSecond);
+  }
+  if(fittingOptions.chunkSegments > 0){
+    writeParam(out, "fitting/chunkSegments", fittingOptions.chunkSegments);
+    writeParam(out, "fitting/overlapSegments", fittingOptions.overlapSegments);
+  }
 }
 
 TrajectoryCarrier::TrajectoryCarrier(sm::value_store::ValueStoreRef config) :
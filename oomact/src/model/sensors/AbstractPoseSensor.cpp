@@ -1,5 +1,7 @@
 #include <aslam/calibration/model/sensors/AbstractPoseSensor.h>
 
+#include <algorithm>
+
 #include <aslam/calibration/data/MeasurementsContainer.h>
 #include <aslam/calibration/data/PoseMeasurement.h>
 #include <aslam/calibration/data/StorageI.h>
@@ -40,6 +42,23 @@ PoseMeasurements& AbstractPoseSensor::getMeasurementsMutable(ModuleStorage & sto
   return storageConnector_.getDataFrom(storage);
 }
 
+size_t AbstractPoseSensor::getNumMeasurements(const ModuleStorage & storage) const {
+  return hasMeasurements(storage) ? getAllMeasurements(storage).size() : 0;
+}
+
+void AbstractPoseSensor::carryOverMeasurements(ModuleStorage & storage, ModuleStorage & nextStorage, Timestamp nextWindowStart) {
+  if(!hasMeasurements(storage)){
+    return;
+  }
+  const PoseMeasurements & measurements = getAllMeasurements(storage);
+  PoseMeasurements & next = getMeasurementsMutable(nextStorage);
+  auto it = std::lower_bound(measurements.begin(), measurements.end(), nextWindowStart, [](const PoseMeasurements::value_type & m, Timestamp t){ return m.first < t; });
+  for(; it != measurements.end(); ++it){
+    next.emplace_back(it->first, it->second);
+  }
+  storage.remove(this);
+}
+
 } /* namespace calibration */
 } /* namespace aslam */
 
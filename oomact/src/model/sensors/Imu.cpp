@@ -1,11 +1,13 @@
 #include <aslam/calibration/model/sensors/Imu.h>
 
+#include <algorithm>
+#include <vector>
+
 #include <glog/logging.h>
 
 #include <boost/make_shared.hpp>
 #include <bsplines/NsecTimePolicy.hpp>
 #include <bsplines/EuclideanBSpline.hpp>
-#include <aslam/backend/QuadraticIntegralError.hpp>
 #include <aslam/backend/Vector2RotationQuaternionExpressionAdapter.hpp>
 #include <aslam/splines/OPTBSpline.hpp>
 
@@ -18,9 +20,13 @@
 #include <aslam/calibration/model/fragments/TrajectoryCarrier.h>
 #include <aslam/calibration/model/ModuleTools.h>
 #include <aslam/calibration/calibrator/StateCarrier.h>
+#include "aslam/calibration/error-terms/BlockedMeasurementErrorTerm.h"
 #include "aslam/calibration/error-terms/ErrorTermAccelerometer.h"
 #include "aslam/calibration/error-terms/ErrorTermGyroscope.h"
+#include "aslam/calibration/error-terms/ErrorTermImuPreintegration.h"
+#include "aslam/calibration/error-terms/ErrorTermSplineDerivativeIntegral.h"
 #include "aslam/calibration/tools/ErrorTermStatisticsWithProblemAndPredictor.h"
+#include "aslam/calibration/tools/SplineSegmentBracket.h"
 #include "aslam/calibration/tools/SplineWriter.h"
 
 
@@ -32,6 +38,9 @@ Imu::Imu(Model& model, const std::string& name, sm::value_store::ValueStoreRef c
     measurements_(std::make_shared<Measurements>()),
     useAcc_(getMyConfig().getBool("acc/used", true)),
     useGyro_(getMyConfig().getBool("gyro/used", true)),
+    usePreintegration_(getMyConfig().getBool("preintegration/used", false)),
+    keyframeInterval_(getMyConfig().getDouble("preintegration/keyframeInterval", 0.1)),
+    maxSamplesPerBlock_(getMyConfig().getBool("errorTermBlocks/used", false) ? std::max(1, int(getMyConfig().getInt("errorTermBlocks/maxSamples", 32))) : 0),
     covAcc_{getMyConfig().getChild("acc/noise/cov"), 3, useAcc_},
     covGyro_{getMyConfig().getChild("gyro/noise/cov"), 3, useGyro_},
     enforceAccCovariance_(getMyConfig().getBool("acc/enforceCovariance", false)),
@@ -49,6 +58,11 @@ Imu::Imu(Model& model, const std::string& name, sm::value_store::ValueStoreRef c
     if(useGyro_){
       gyroRandomWalk = getMyConfig().getDouble("gyro/noise/biasRandomWalk");
     }
+    if(usePreintegration_){
+      SM_ASSERT_TRUE(std::runtime_error, useAcc_ && useGyro_, "IMU preintegration requires the accelerometer and the gyroscope to be used!");
+      SM_ASSERT_GT(std::runtime_error, keyframeInterval_, 0.0, "");
+      SM_ASSERT_EQ(std::runtime_error, maxSamplesPerBlock_, size_t(0), "IMU preintegration and error term blocks are alternatives!");
+    }
   }
 
 //TODO C support MESTIMATORS:  setMEstimator(boost::shared_ptr<aslam::backend::MEstimator>(new aslam::backend::CauchyMEstimator(10)));
@@ -78,6 +92,12 @@ void Imu::writeConfig(std::ostream& out) const {
     }
   }
 
+  MODULE_WRITE_PARAM(maxSamplesPerBlock_);
+  MODULE_WRITE_PARAM(usePreintegration_);
+  if(usePreintegration_){
+    MODULE_WRITE_PARAM(keyframeInterval_);
+  }
+
   MODULE_WRITE_PARAM(minimalMeasurementsPerBatch);
 }
 
@@ -102,6 +122,8 @@ class BiasBatchState : public BatchState {
  private:
   std::string name_;
   BiasSpline biasSpline;
+  /// The bias spline's knots and control vertices to build the segment brackets of the blocked error terms from.
+  SplineKnotTable biasSplineKnots;
   friend Bias;
   friend Imu;
 };
@@ -141,6 +163,7 @@ void Bias::initState(CalibratorI & calib){
     //TODO D make bias initial guess based on IMU measurements!
 
     state_->biasSpline.initConstantUniformSpline(interval.start, interval.end, numSegments, Eigen::Vector3d::Zero());
+    state_->biasSplineKnots.update(state_->biasSpline);
   }
 }
 
@@ -180,7 +203,7 @@ BiasBatchState::BiasBatchState(const TrajectoryCarrier & carrier, const std::str
 }
 
 void BiasBatchState::writeToFile(const CalibratorI & calib, const std::string& pathPrefix) const {
-  writeSpline(biasSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + name_);
+  writeEuclideanSpline(biasSpline, calib.getOptions().getSplineOutputSamplePeriod(), pathPrefix + name_, calib.getThreadPool());
 }
 
 
@@ -207,51 +230,85 @@ void Imu::clearMeasurements() {
   measurements_->gyroscope.clear();
 }
 
+size_t Imu::getNumMeasurements(const ModuleStorage& /*storage*/) const {
+  return measurements_ ? measurements_->accelerometer.size() + measurements_->gyroscope.size() : 0;
+}
 
-using namespace aslam::backend;
-
-template<typename BSpline_>
-struct BiasModelIntegrationErrorExpressionFactory {
-  typedef BSpline_ BSplineT;
-  typedef typename BSplineT::time_t TimeT;
-  enum { PointSize = 3 };
-  typedef VectorExpression<PointSize> value_expression_t;
-  typedef Eigen::Matrix<double, 1, 1>  value_t;
-
-  const BSplineT & _bspline;
-  const Eigen::Matrix<double, PointSize, PointSize> _sqrtInvR;
+void Imu::carryOverMeasurements(ModuleStorage& /*storage*/, ModuleStorage& /*nextStorage*/, Timestamp nextWindowStart) {
+  measurements_->accelerometer.removeBefore(nextWindowStart);
+  measurements_->gyroscope.removeBefore(nextWindowStart);
+}
 
-  BiasModelIntegrationErrorExpressionFactory(const BSplineT & bspline, Eigen::Matrix<double, PointSize, PointSize> sqrtInvR) : _bspline(bspline), _sqrtInvR(sqrtInvR) {}
 
-  inline value_expression_t operator()(TimeT time) const {
-    return _bspline.template getExpressionFactoryAt<1>(time).getValueExpression(1);
-  }
-};
+using namespace aslam::backend;
 
+/// The bias random walk: The integral of |sqrtInvR * d/dt bias(t)|^2, one exact error term per bias spline segment.
 template <typename SplineT>
-void addBiasModelErrorTerms(CalibratorI & calib, std::string name, ErrorTermReceiver & errorTermReceiver, const SplineT & spline, const Eigen::MatrixXd & sqrtInvR, bool observeOnly, int numberOfIntegrationPoints = -1){
-  BiasModelIntegrationErrorExpressionFactory<SplineT> integrationFunctor(spline, sqrtInvR);
-  if(numberOfIntegrationPoints < 0){
-    numberOfIntegrationPoints = (spline.getAbsoluteNumberOfSegments() + spline.getSplineOrder()) * 2;
-  }
-
+void addBiasModelErrorTerms(CalibratorI & calib, std::string name, ErrorTermReceiver & errorTermReceiver, const SplineT & spline, const Eigen::MatrixXd & sqrtInvR, bool observeOnly){
   ErrorTermStatisticsWithProblemAndPredictor stat(calib, name + "Bias", errorTermReceiver, observeOnly);
 
-  aslam::backend::integration::addQuadraticIntegralExpressionErrorTerms<aslam::backend::integration::DefaultAlgorithm>(stat, spline.getMinTime(), spline.getMaxTime(), numberOfIntegrationPoints, integrationFunctor, sqrtInvR);
+  addSplineDerivativeIntegralErrorTerms(stat, spline, 1, sqrtInvR);
 
   stat.printInto(LOG(INFO));
 }
 
-template <typename T, typename ErrorTermFactory>
-void addImuErrorTerms(CalibratorI & calib, const Imu & imu, std::string name, const MeasurementsContainer<T>& measurements, ErrorTermFactory etFactory, ErrorTermReceiver & errorTermReceiver, bool observeOnly) {
-  LOG(INFO) << "Adding " << measurements.size() << " " << name << " error terms";
+typedef MeasurementErrorTerm<3, EuclideanExpression> ImuErrorTerm;
+typedef BlockedMeasurementErrorTerm<3, EuclideanExpression> ImuErrorTermBlock;
+
+/**
+ * predict(timestamp, measurement) must return the ImuErrorTermBlock::Sample of a measurement.
+ * With maxSamplesPerBlock > 0 consecutive samples depending on the same design variables (i.e. within the same spline segments) get combined into ImuErrorTermBlocks.
+ * Otherwise every sample becomes an ImuErrorTerm.
+ */
+template <typename T, typename Predict>
+void addImuErrorTerms(CalibratorI & calib, const Imu & imu, std::string name, const MeasurementsContainer<T>& measurements, Predict predict, const ErrorTermGroupReference & etgr, ErrorTermReceiver & errorTermReceiver, bool observeOnly, size_t maxSamplesPerBlock) {
+  LOG(INFO) << "Adding " << measurements.size() << " " << name << " error terms" << (maxSamplesPerBlock > 0 ? " in blocks" : "");
 
   ErrorTermStatisticsWithProblemAndPredictor statWPAP(calib, name, errorTermReceiver, observeOnly);
   const Interval & interval = calib.getCurrentEffectiveBatchInterval();
 
   Timestamp minTime = interval.end, maxTime = interval.start;
 
-  for (auto & m : measurements) {
+  auto createErrorTerm = [&](const ImuErrorTermBlock::Sample & s){
+    return boost::make_shared<ImuErrorTerm>(s.prediction, s.measurement, s.cov, etgr);
+  };
+
+  ImuErrorTermBlock::Samples block;
+  DesignVariable::set_t blockDesignVariables;
+  Timestamp blockStart = interval.start;
+  auto addBlock = [&](){
+    if(block.empty()){
+      return;
+    }
+    boost::shared_ptr<ImuErrorTermBlock> e(new ImuErrorTermBlock(std::move(block), etgr));
+    block.clear();
+    blockDesignVariables.clear();
+    if(imu.getMEstimator()){
+      e->setMEstimatorPolicy(imu.getMEstimator());
+    }
+    statWPAP.add(blockStart, e);
+  };
+
+  std::vector<bool> selected;
+  if(imu.getMeasurementSelector().isUsed()){
+    std::vector<Timestamp> timestamps;
+    timestamps.reserve(measurements.size());
+    for (auto & m : measurements) {
+      timestamps.push_back(m.first);
+    }
+    selected = imu.getMeasurementSelector().select(calib.getModel(), timestamps, [&](size_t i) -> boost::shared_ptr<ErrorTerm> {
+      if (!interval.contains(measurements[i].first, imu)){
+        return nullptr;
+      }
+      return createErrorTerm(predict(measurements[i].first, measurements[i].second));
+    });
+  }
+
+  for (size_t i = 0; i < measurements.size(); i++) {
+    if(!selected.empty() && !selected[i]){
+      continue;
+    }
+    auto & m = measurements[i];
     Timestamp timestamp = m.first;
     if (!interval.contains(timestamp, imu)){
       LOG(INFO) << name << " measurement out of spline range at " << calib.secsSinceStart(timestamp) << "s.";
@@ -261,8 +318,23 @@ void addImuErrorTerms(CalibratorI & calib, const Imu & imu, std::string name, co
     if(minTime > timestamp) minTime = timestamp;
     if(maxTime < timestamp) maxTime = timestamp;
 
-    auto e = etFactory(timestamp, m.second);
+    ImuErrorTermBlock::Sample sample = predict(timestamp, m.second);
+
+    if(maxSamplesPerBlock > 0){
+      DesignVariable::set_t designVariables;
+      sample.prediction.getDesignVariables(designVariables);
+      if(block.size() >= maxSamplesPerBlock || designVariables != blockDesignVariables){
+        addBlock();
+      }
+      if(block.empty()){
+        blockStart = timestamp;
+        blockDesignVariables = std::move(designVariables);
+      }
+      block.push_back(std::move(sample));
+      continue;
+    }
 
+    auto e = createErrorTerm(sample);
     if(imu.getMEstimator()){
       e->setMEstimatorPolicy(imu.getMEstimator());
     }
@@ -270,6 +342,7 @@ void addImuErrorTerms(CalibratorI & calib, const Imu & imu, std::string name, co
     VLOG(2) << "Cost function " << name << " : " << e->evaluateError() << " count: " << statWPAP.getCounter() << " timestamp: " << calib.secsSinceStart(timestamp) << "s,";
     statWPAP.add(timestamp, e);
   }
+  addBlock();
   statWPAP.printInto(LOG(INFO)) << " Between " << calib.secsSinceStart(minTime) << "s and " << calib.secsSinceStart(maxTime) << "s.";
 }
 
@@ -279,58 +352,136 @@ bool isCovarianceAvailable(T&t){
 }
 
 void Imu::addMeasurementErrorTerms(CalibratorI & calib, const CalibrationConfI & /*ec*/, ErrorTermReceiver & errorTermReceiver, bool observeOnly) const {
-  if(useAcc_){
-    const std::string accelerometerName = getName() + "Accelerometer";
-    if(accBias.isUsingSpline()){
-      addBiasModelErrorTerms(calib, accelerometerName, errorTermReceiver, accBias.state_->biasSpline, Eigen::Matrix3d::Identity() / accRandomWalk, observeOnly);
-    }
+  const std::string accelerometerName = getName() + "Accelerometer";
+  const std::string gyroscopeName = getName() + "Gyroscope";
+  if(useAcc_ && accBias.isUsingSpline()){
+    addBiasModelErrorTerms(calib, accelerometerName, errorTermReceiver, accBias.state_->biasSpline, Eigen::Matrix3d::Identity() / accRandomWalk, observeOnly);
+  }
+  if(useGyro_ && gyroBias.isUsingSpline()){
+    addBiasModelErrorTerms(calib, gyroscopeName, errorTermReceiver, gyroBias.state_->biasSpline, Eigen::Matrix3d::Identity() / gyroRandomWalk, observeOnly);
+  }
+  if(usePreintegration_){
+    addPreintegratedErrorTerms(calib, errorTermReceiver, observeOnly);
+    return;
+  }
 
+  if(useAcc_){
     //TODO C solve gravity vector problem. Each model has a gravity vector?
     auto g_m = calib.getModel().getGravity().getVectorExpression();
     Eigen::Matrix3d covarianceMatrix = covAcc_.getValue();
-    ErrorTermGroupReference etgr(getName() + "Acc");
+    // The blocks share the bias spline's basis functions between the samples of a bias segment.
+    std::shared_ptr<const SplineSegmentBracket> biasSegment;
     addImuErrorTerms(
         calib, *this, accelerometerName, measurements_->accelerometer,
         [&, this](const Timestamp timestamp, const AccelerometerMeasurement & m){
           auto modelAt = calib.getModelAt(*this, timestamp, 2, {false});
-          return boost::make_shared<ErrorTermAccelerometer>(
-              modelAt.getAcceleration(getFrame(), inertiaFrame),
-              getTransformationExpressionTo(modelAt, inertiaFrame).toRotationExpression().inverse(),
-              g_m,
-              accBias.getBiasExpression(timestamp),
+          return ImuErrorTermBlock::Sample{
+              ErrorTermAccelerometer::createPrediction(
+                  modelAt.getAcceleration(getFrame(), inertiaFrame),
+                  getTransformationExpressionTo(modelAt, inertiaFrame).toRotationExpression().inverse(),
+                  g_m,
+                  maxSamplesPerBlock_ > 0 ? accBias.getBiasExpression(timestamp, biasSegment) : accBias.getBiasExpression(timestamp)),
               m.a,
-              isCovarianceAvailable(m) && !enforceAccCovariance_ ? m.cov : covarianceMatrix,
-              etgr);
+              isCovarianceAvailable(m) && !enforceAccCovariance_ ? m.cov : covarianceMatrix};
         },
+        ErrorTermGroupReference(getName() + "Acc"),
         errorTermReceiver,
-        observeOnly
+        observeOnly,
+        maxSamplesPerBlock_
       );
   }
   if(useGyro_){
-    const std::string gyroscopeName = getName() + "Gyroscope";
-    if(gyroBias.isUsingSpline()){
-      addBiasModelErrorTerms(calib, gyroscopeName, errorTermReceiver, gyroBias.state_->biasSpline, Eigen::Matrix3d::Identity() / gyroRandomWalk, observeOnly);
-    }
     Eigen::Matrix3d covarianceMatrix = covGyro_.getValue();
-    ErrorTermGroupReference etgr(getName() + "Gyro");
+    std::shared_ptr<const SplineSegmentBracket> biasSegment;
     addImuErrorTerms(
         calib, *this, gyroscopeName, measurements_->gyroscope,
         [&, this](const Timestamp timestamp, const GyroscopeMeasurement & m){
           auto modelAt = calib.getModelAt(*this,  timestamp, 1, {false});
-          return boost::make_shared<ErrorTermGyroscope>(
-              getTransformationExpressionTo(modelAt, inertiaFrame).toRotationExpression().inverse() * modelAt.getAngularVelocity(getReferenceFrame(), inertiaFrame),
-              gyroBias.getBiasExpression(timestamp),
+          return ImuErrorTermBlock::Sample{
+              ErrorTermGyroscope::createPrediction(
+                  getTransformationExpressionTo(modelAt, inertiaFrame).toRotationExpression().inverse() * modelAt.getAngularVelocity(getReferenceFrame(), inertiaFrame),
+                  maxSamplesPerBlock_ > 0 ? gyroBias.getBiasExpression(timestamp, biasSegment) : gyroBias.getBiasExpression(timestamp)),
               m.w,
-              isCovarianceAvailable(m) && !enforceGyroCovariance_ ? m.cov : covarianceMatrix,
-              etgr
-            );
+              isCovarianceAvailable(m) && !enforceGyroCovariance_ ? m.cov : covarianceMatrix};
         },
+        ErrorTermGroupReference(getName() + "Gyro"),
         errorTermReceiver,
-        observeOnly
+        observeOnly,
+        maxSamplesPerBlock_
       );
   }
 }
 
+void Imu::addPreintegratedErrorTerms(CalibratorI & calib, ErrorTermReceiver & errorTermReceiver, bool observeOnly) const {
+  const auto & accs = measurements_->accelerometer;
+  const auto & gyros = measurements_->gyroscope;
+  const std::string name = getName() + "Preintegrated";
+  LOG(INFO) << "Preintegrating " << gyros.size() << " gyroscope and " << accs.size() << " accelerometer measurements with keyframeInterval=" << keyframeInterval_ << "s";
+  if(accs.empty()){
+    return;
+  }
+
+  ErrorTermStatisticsWithProblemAndPredictor statWPAP(calib, name, errorTermReceiver, observeOnly);
+  const Interval & interval = calib.getCurrentEffectiveBatchInterval();
+  auto g_m = calib.getModel().getGravity().getVectorExpression();
+  const Eigen::Matrix3d accCovariance = covAcc_.getValue(), gyroCovariance = covGyro_.getValue();
+  ErrorTermGroupReference etgr(getName() + "Preintegrated");
+
+  auto getState = [&](Timestamp t){
+    auto modelAt = calib.getModelAt(*this, t, 1, {});
+    auto T_m_i = getTransformationExpressionTo(modelAt, inertiaFrame);
+    return ErrorTermImuPreintegration::State{T_m_i.toRotationExpression(), T_m_i.toEuclideanExpression(), modelAt.getVelocity(getFrame(), inertiaFrame)};
+  };
+
+  // The accelerometer linearly interpolated at t. Only walks forward, as the gyroscope's timestamps ascend.
+  size_t a = 0;
+  auto getAccAt = [&](Timestamp t) -> Eigen::Vector3d {
+    while(a + 1 < accs.size() && accs[a + 1].first <= t){
+      a++;
+    }
+    if(a + 1 >= accs.size() || t <= accs[a].first){
+      return accs[a].second.a;
+    }
+    const double alpha = double(t - accs[a].first) / double(accs[a + 1].first - accs[a].first);
+    return (1 - alpha) * accs[a].second.a + alpha * accs[a + 1].second.a;
+  };
+
+  // The gyroscope clocks the integration. Every step integrates from one gyroscope sample to the next with the midpoint rule.
+  std::unique_ptr<ImuPreintegration> preintegration;
+  Timestamp keyframe = interval.start;
+  for (size_t k = 0; k + 1 < gyros.size(); k++) {
+    const Timestamp t = gyros[k].first, tNext = gyros[k + 1].first;
+    if (!interval.contains(t, *this) || !interval.contains(tNext, *this)){
+      VLOG(1) << name << " measurement out of spline range at " << calib.secsSinceStart(t) << "s.";
+      continue;
+    }
+    if (tNext == t){
+      continue;
+    }
+    if(!preintegration){
+      keyframe = t;
+      preintegration.reset(new ImuPreintegration(accBias.getBiasExpression(t).toEuclidean(), gyroBias.getBiasExpression(t).toEuclidean()));
+    }
+    const Eigen::Vector3d acc = getAccAt(t), accNext = getAccAt(tNext);
+    const AccelerometerMeasurement & accSample = accs[a].second;
+    const GyroscopeMeasurement & gyro = gyros[k].second;
+    preintegration->integrate(acc, gyro.w, accNext, gyros[k + 1].second.w, double(tNext - t),
+                              isCovarianceAvailable(accSample) && !enforceAccCovariance_ ? accSample.cov : accCovariance,
+                              isCovarianceAvailable(gyro) && !enforceGyroCovariance_ ? gyro.cov : gyroCovariance);
+
+    const bool isLast = k + 2 >= gyros.size() || !interval.contains(gyros[k + 2].first, *this);
+    if(double(tNext - keyframe) >= keyframeInterval_ || isLast){
+      boost::shared_ptr<ErrorTermImuPreintegration> e(new ErrorTermImuPreintegration(getState(keyframe), getState(tNext), g_m, accBias.getBiasExpression(keyframe), gyroBias.getBiasExpression(keyframe), *preintegration, etgr));
+      if(getMEstimator()){
+        e->setMEstimatorPolicy(getMEstimator());
+      }
+      statWPAP.add(keyframe, e);
+      preintegration.reset();
+    }
+  }
+  statWPAP.printInto(LOG(INFO));
+}
+
 double Imu::getMaximalTimeGap() const {
   if(measurements_){
     Timestamp gGap(measurements_->gyroscope.getMaximalTimeGap());
@@ -354,6 +505,24 @@ aslam::backend::EuclideanExpression Bias::getBiasExpression(Timestamp t) const {
   }
 }
 
+aslam::backend::EuclideanExpression Bias::getBiasExpression(Timestamp t, std::shared_ptr<const SplineSegmentBracket> & segment) const {
+  if(!isUsingSpline()){
+    return biasVectorExpression;
+  }
+  SM_ASSERT_NOTNULL(std::runtime_error, state_, "");
+  if(!segment || t < segment->getLowerBound() || segment->getUpperBound() < t){
+    const SplineKnotTable & table = state_->biasSplineKnots;
+    const auto & knots = table.getKnots();
+    const int p = table.getOrder() - 1, numControlVertices = table.getControlVertices().size();
+    int span = int(std::upper_bound(knots.begin() + p, knots.begin() + numControlVertices, t.getNumerator()) - knots.begin()) - 1;
+    span = std::max(p, std::min(numControlVertices - 1, span));
+    // Only the last span contains its end. Otherwise the bracket would reach into the next span and depend on its control vertex, too.
+    const sm::timing::NsecTime end = span + 1 < numControlVertices ? knots[span + 1] - 1 : knots[span + 1];
+    segment = table.createBracket(Timestamp::fromNumerator(knots[span]), Timestamp::fromNumerator(end));
+  }
+  return createEuclideanSplineExpression(segment, backend::GenericScalarExpression<Timestamp>(t), 0);
+}
+
 void Imu::addPriorFactors(CalibratorI & calib, ErrorTermReceiver & errorTermReceiver, double priorFactor) const {
   const double invSigma = 1e-2 * priorFactor;
   Timestamp startTime = calib.getCurrentEffectiveBatchInterval().start;
@@ -1,5 +1,7 @@
 #include <aslam/calibration/model/sensors/MotionCaptureSensor.h>
 
+#include <vector>
+
 #include <boost/make_shared.hpp>
 #include <glog/logging.h>
 
@@ -130,7 +132,29 @@ void MotionCaptureSensor::addMeasurementErrorTerms(CalibratorI& calib, const Cal
   const Eigen::Matrix3d cov_t = getCovPosition().getValue();
   const Eigen::Matrix3d cov_r = getCovOrientation().getValue();
 
-  for (auto & m : getAllMeasurements(storage)) {
+  const auto & measurements = getAllMeasurements(storage);
+  std::vector<bool> selected;
+  if(getMeasurementSelector().isUsed()){
+    std::vector<Timestamp> timestamps;
+    timestamps.reserve(measurements.size());
+    for (auto & m : measurements) {
+      timestamps.push_back(m.first);
+    }
+    selected = getMeasurementSelector().select(getModel(), timestamps, [&](size_t i) -> boost::shared_ptr<aslam::backend::ErrorTerm> {
+      const Timestamp timestamp = measurements[i].first;
+      if(uLow > timestamp || uUpp < timestamp){
+        return nullptr;
+      }
+      aslam::backend::TransformationExpression T_m_s = getTransformationExpressionToAtMeasurementTimestamp(calib, timestamp, motionCaptureSystem.getReferenceFrame(), true);
+      return boost::make_shared<ErrorTermPose>(aslam::backend::TransformationExpression(mCSFromGlobalTransformation * T_m_s), measurements[i].second, cov_t, cov_r, etgr);
+    });
+  }
+
+  for (size_t i = 0; i < measurements.size(); i++) {
+    if(!selected.empty() && !selected[i]){
+      continue;
+    }
+    auto & m = measurements[i];
     const Timestamp timestamp = m.first;
     const bool timestampIsPossiblyOutOfBounds = uLow > timestamp || uUpp < timestamp;
     if(timestampIsPossiblyOutOfBounds && !hasDelay()){
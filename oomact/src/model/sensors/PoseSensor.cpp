@@ -2,6 +2,7 @@
 
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include <aslam/backend/TransformationExpression.hpp>
 #include <boost/make_shared.hpp>
@@ -81,10 +82,35 @@ void PoseSensor::addMeasurementErrorTerms(CalibratorI& calib, const CalibrationC
     throw std::runtime_error("Delay already out of bounds!");
   }
 
+  const auto & measurements = getAllMeasurements(storage);
+  std::vector<bool> selected;
+  if(getMeasurementSelector().isUsed()){
+    if(absoluteMeasurements_){
+      std::vector<Timestamp> timestamps;
+      timestamps.reserve(measurements.size());
+      for (auto & m : measurements) {
+        timestamps.push_back(m.first);
+      }
+      selected = getMeasurementSelector().select(getModel(), timestamps, [&](size_t i) -> boost::shared_ptr<aslam::backend::ErrorTerm> {
+        const Timestamp timestamp = measurements[i].first;
+        if(conditionalLowerBound > timestamp || conditionalUpperBound < timestamp || isOutlier(measurements[i].second)){
+          return nullptr;
+        }
+        return boost::make_shared<ErrorTermPose>(getTransformationExpressionToAtMeasurementTimestamp(calib, timestamp, targetFrame_, true), measurements[i].second, getCovPosition().getValue(), getCovOrientation().getValue(), etgr);
+      });
+    } else {
+      LOG(WARNING) << "Measurement selection is not supported for relative measurements (" << getName() << ")!";
+    }
+  }
+
   const PoseMeasurement * lastPoseMeasurement = nullptr;
   auto lastTimestamp = Timestamp::Zero();
   aslam::backend::TransformationExpression last_T_m_s;
-  for (auto & m : getAllMeasurements(storage)) {
+  for (size_t i = 0; i < measurements.size(); i++) {
+    if(!selected.empty() && !selected[i]){
+      continue;
+    }
+    auto & m = measurements[i];
     Timestamp timestamp = m.first;
     auto & poseMeasurement = m.second;
     if(certainLowerBound > timestamp || certainUpperBound < timestamp){
@@ -112,6 +112,16 @@ void PositionSensor::clearMeasurements() {
   measurements.reset();
 }
 
+size_t PositionSensor::getNumMeasurements(const ModuleStorage& /*storage*/) const {
+  return measurements ? measurements->size() : 0;
+}
+
+void PositionSensor::carryOverMeasurements(ModuleStorage& /*storage*/, ModuleStorage& /*nextStorage*/, Timestamp nextWindowStart) {
+  if(measurements){
+    measurements->removeBefore(nextWindowStart);
+  }
+}
+
 } /* namespace calibration */
 } /* namespace aslam */
 
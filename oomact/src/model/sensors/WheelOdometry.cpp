@@ -14,7 +14,7 @@
 #include "aslam/calibration/data/WheelSpeedsMeasurement.h"
 #include <aslam/calibration/model/Model.h>
 #include <aslam/calibration/model/ModuleTools.h>
-#include "aslam/calibration/error-terms/ErrorTermWheel.h"
+#include "aslam/calibration/error-terms/ErrorTermWheelPair.h"
 #include <aslam/calibration/tools/ErrorTermStatistics.h>
 #include <aslam/calibration/tools/Interval.h>
 
@@ -83,7 +83,7 @@ void WheelOdometry::addMeasurement(CalibratorI & calib, const Timestamp t, const
 }
 
 void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const CalibrationConfI & /*ec*/, ErrorTermReceiver & problem, bool observeOnly) const {
-  LOG(INFO) << "Adding " << 2 * measurements_.size() << " wheels error terms";
+  LOG(INFO) << "Adding " << measurements_.size() << " wheel pair error terms";
 
   Timestamp minTime = Timestamp::Numerator(std::numeric_limits<Timestamp::Integer>::max()), maxTime = InvalidTimestamp();
 
@@ -91,9 +91,7 @@ void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const Calibrat
   auto R_r = getWheelRadiusR()->toExpression();
   auto L = getL()->toExpression();
 
-  ErrorTermStatistics
-    lwES(getName() + ".lw" + (observeOnly  ? " (OBSERVER)" : "")),
-    rwES(getName() + ".rw" + (observeOnly  ? " (OBSERVER)" : ""));
+  ErrorTermStatistics wheelsES(getName() + ".wheels" + (observeOnly  ? " (OBSERVER)" : ""));
 
   auto predictions = calib.createPredictionCollector(getName());
 
@@ -103,8 +101,6 @@ void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const Calibrat
 
   Timestamp prevTimestamp = validRange.start;
 
-  const auto lHalf = (L * 0.5);
-
   for (auto & m : measurements_) {
     if(Timestamp(m.first) <= validRange.start){
       VLOG(1) << "Skipping out of bounds wheel measurement at " << calib.secsSinceStart(m.first) << ".";
@@ -128,10 +124,7 @@ void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const Calibrat
     if(minTime > timestamp) minTime = timestamp;
     if(maxTime < timestamp) maxTime = timestamp;
 
-    auto robot = calib.getModelAt({timestampDelayed, lBound, uBound}, 1, {});
-
-    EuclideanExpression v_r_mwl, v_r_mwr;
-    RotationExpression R_m_r;
+    auto robot = isDelayActive() ? calib.getModelAt({timestampDelayed, lBound, uBound}, 1, {}) : calib.getModelAt(*this, timestamp, 1, {});
 
     /*else{// if(_options.useBaseSpeed){ TODO C check this out ?
       auto R_m_r = Vector2RotationQuaternionExpressionAdapter::adapt(
@@ -166,22 +159,9 @@ void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const Calibrat
         DLOG(ERROR) << "Cost function Speed: Linear " << e_v->evaluateError() << " Angular: "
         << e_w->evaluateError() <<  " count: " << count << " timestamp: " << timestamp;
     }*/
-    {
-      auto R_m_r = getTransformationExpressionTo(robot, groundFrame_).toRotationExpression();
-      auto v_m_mr = robot.getVelocity(groundFrame_, getReferenceFrame());
-      auto v_r_mr = R_m_r.inverse() * v_m_mr;
-
-      auto w_m_mr = robot.getAngularVelocity(groundFrame_, getReferenceFrame());
-      auto w_r_mr = R_m_r.inverse() * w_m_mr;
-
-      // Computing the velocity in the wheel frame:
-      // v_r_mwl = v_wl_mwl, since the two frames are aligned
-      auto t_r_rwl = EuclideanExpression(Eigen::Vector3d(0.0, 1.0, 0.0)) * lHalf;
-      auto t_r_rwr = EuclideanExpression(Eigen::Vector3d(0.0, -1.0, 0.0)) * lHalf;
-
-      v_r_mwl = v_r_mr + w_r_mr.cross(t_r_rwl);
-      v_r_mwr = v_r_mr + w_r_mr.cross(t_r_rwr);
-    }
+    auto R_m_r = getTransformationExpressionTo(robot, groundFrame_).toRotationExpression();
+    auto v_r_mr = R_m_r.inverse() * robot.getVelocity(groundFrame_, getReferenceFrame());
+    auto w_r_mr = R_m_r.inverse() * robot.getAngularVelocity(groundFrame_, getReferenceFrame());
 
     // TODO B improve Odometry error model (this is basically a different elliptic distribution) and make thresholds parameters or use self-tuning
     auto motionBasedFactor = [&](double v){
@@ -191,34 +171,34 @@ void WheelOdometry::addMeasurementErrorTerms(CalibratorI & calib, const Calibrat
       return 1.;
     };
 
-    auto e_rlw = boost::make_shared<ErrorTermWheel>(v_r_mwl, R_l, m.second.left, motionBasedFactor(m.second.left) * lwVariance);
-    auto e_rrw = boost::make_shared<ErrorTermWheel>(v_r_mwr, R_r, m.second.right, motionBasedFactor(m.second.right) * rwVariance);
+    boost::shared_ptr<ErrorTermWheelPair> e(new ErrorTermWheelPair(
+        v_r_mr, w_r_mr, L, R_l, R_r,
+        Eigen::Vector2d(m.second.left, m.second.right),
+        Eigen::Vector2d(motionBasedFactor(m.second.left) * lwVariance, motionBasedFactor(m.second.right) * rwVariance)));
 
     if(!observeOnly){
-      problem.addErrorTerm(e_rlw);
-      problem.addErrorTerm(e_rrw);
+      problem.addErrorTerm(e);
     }
-    lwES.add(e_rlw);
-    rwES.add(e_rrw);
+    wheelsES.add(e);
 
     if(calib.getOptions().getPredictResults()){
-      predictions->add([=](std::ostream &outPred, std::ostream &outMeasure, std::ostream &outErr, std::ostream & outNormalizedErr){
-        e_rlw->evaluateError();
-        e_rrw->evaluateError(); //TODO C cleanup wheel error term (using MeasurementErrorTerm) !
-        outPred << timestamp << " " << (double)(e_rlw->error()(0) + e_rlw->getMeasurement()) << " " << (double)(e_rrw->error()(0) + e_rrw->getMeasurement()) <<std::endl;
-        outMeasure << timestamp << " " << (double)(e_rlw->getMeasurement()) << " " << (double)(e_rrw->getMeasurement()) <<std::endl;
-        outErr << timestamp << " " << (double) e_rlw->error()(0) << " "  << (double) e_rrw->error()(0) <<std::endl;
-        outNormalizedErr << timestamp << " " << (double) (e_rlw->sqrtInvR() * e_rlw->error())(0) << " "  << (double) (e_rlw->sqrtInvR() * e_rlw->error())(0) << std::endl;
-      });
+      predictions->add(timestamp, e);
     }
   }
-  lwES.printInto(LOG(INFO));
-  rwES.printInto(LOG(INFO));
+  wheelsES.printInto(LOG(INFO));
 }
 
 void WheelOdometry::clearMeasurements() {
   measurements_.clear();
 }
+
+size_t WheelOdometry::getNumMeasurements(const ModuleStorage& /*storage*/) const {
+  return measurements_.size();
+}
+
+void WheelOdometry::carryOverMeasurements(ModuleStorage& /*storage*/, ModuleStorage& /*nextStorage*/, Timestamp nextWindowStart) {
+  measurements_.removeBefore(nextWindowStart);
+}
 //TODO C deduplicate hasTooFewMeasurements (WheelOdometry, Imu)
 bool WheelOdometry::hasTooFewMeasurements() const {
   return measurements_.size() < size_t(minimalMeasurementsPerBatch);
@@ -12,7 +12,8 @@ namespace calibration {
 MockCalibrator::MockCalibrator(Model& model, Interval initialInverval)
     : AbstractCalibrator(model.getConfig(), std::shared_ptr<Model>(&model, sm::null_deleter()),
                          false),
-      storage_(*this)
+      storage_(*this),
+      options_(model.getConfig())
 {
   _currentEffectiveBatchInterval = initialInverval;
   LOG(INFO) << "Initialized mock calibrator with batch interval = ["
@@ -43,7 +44,7 @@ bool MockCalibrator::isMeasurementRelevant(const Sensor &, Timestamp) const
 }
 const CalibratorOptionsI & MockCalibrator::getOptions() const
 {
-  throw std::runtime_error(std::string(__func__) + " not implemented!");
+  return options_;
 }
 bool MockCalibrator::handleNewTimeBaseTimestamp(Timestamp)
 {
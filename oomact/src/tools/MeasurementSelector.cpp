@@ -0,0 +1,149 @@
+#include <aslam/calibration/tools/MeasurementSelector.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include <aslam/backend/JacobianContainer.hpp>
+#include <glog/logging.h>
+
+#include <aslam/calibration/algo/MeasurementSelection.h>
+#include <aslam/calibration/model/CalibrationVariable.h>
+#include <aslam/calibration/model/Model.h>
+#include <aslam/calibration/model/PoseTrajectory.h>
+#include <aslam/calibration/model/fragments/So3R3Trajectory.h>
+
+namespace aslam {
+namespace calibration {
+
+MeasurementSelector::MeasurementSelector(sm::value_store::ValueStoreRef config) :
+  used_(config.getBool("used", false)),
+  maxMeasurements_(std::max(1, int(config.getInt("maxMeasurements", 1000)))),
+  windowDuration_(config.getDouble("windowDuration", 0.1))
+{
+}
+
+namespace {
+/// The sorted knots of all current trajectory splines of model.
+std::vector<sm::timing::NsecTime> getTrajectoryKnots(const Model & model) {
+  std::vector<sm::timing::NsecTime> knots;
+  for(const Module & m : model.getModules()){
+    auto trajectory = m.ptrAs<PoseTrajectory>();
+    if(!trajectory || !trajectory->isUsed() || !trajectory->hasCurrentTrajectory()){
+      continue;
+    }
+    trajectory->getCurrentTrajectory().visitSplines([&](const auto & rotationSpline, const auto & translationSpline){
+      for(const auto & k : rotationSpline.getKnotsVector()) knots.push_back(k);
+      for(const auto & k : translationSpline.getKnotsVector()) knots.push_back(k);
+    });
+  }
+  std::sort(knots.begin(), knots.end());
+  knots.erase(std::unique(knots.begin(), knots.end()), knots.end());
+  return knots;
+}
+}
+
+std::vector<bool> MeasurementSelector::select(const Model & model, const std::vector<Timestamp> & timestamps, const ErrorTermFactory & createErrorTerm) const {
+  std::vector<bool> keep(timestamps.size(), true);
+  if(!used_ || timestamps.size() <= maxMeasurements_){
+    return keep;
+  }
+
+  // [begin, end) of consecutive measurements within one segment, i.e. between the same knots
+  const std::vector<sm::timing::NsecTime> knots = getTrajectoryKnots(model);
+  std::vector<std::pair<size_t, size_t>> windows;
+  std::vector<size_t> windowSegments;
+  size_t segment = 0; // the number of knots up to the current timestamp
+  for(size_t i = 0; i < timestamps.size(); i++){
+    const size_t lastSegment = segment;
+    while(segment < knots.size() && knots[segment] <= timestamps[i].getNumerator()){
+      segment++;
+    }
+    if(windows.empty() || segment != lastSegment || double(timestamps[i] - timestamps[windows.back().first]) >= windowDuration_){
+      windows.emplace_back(i, i + 1);
+      windowSegments.push_back(segment);
+    } else {
+      windows.back().second = i + 1;
+    }
+  }
+
+  std::unordered_map<const aslam::backend::DesignVariable*, int> offsets;
+  int dim = 0;
+  for(auto & cv : model.getCalibrationVariables()){
+    const auto & dv = cv->getDesignVariable();
+    if(dv.isActive()){
+      offsets[&dv] = dim;
+      dim += dv.minimalDimensions();
+    }
+  }
+
+  std::vector<Eigen::MatrixXd> jacobians;
+  std::vector<double> weights;
+  jacobians.reserve(windows.size());
+  weights.reserve(windows.size());
+  for(auto & w : windows){
+    weights.push_back(w.second - w.first);
+    auto e = createErrorTerm((w.first + w.second - 1) / 2);
+    if(!e){
+      jacobians.emplace_back(0, dim);
+      continue;
+    }
+    e->evaluateError();
+    aslam::backend::JacobianContainer jc(e->dimension());
+    e->getWeightedJacobians(jc, false);
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(e->dimension(), dim);
+    for(auto it = jc.begin(); it != jc.end(); ++it){
+      auto o = offsets.find(it->first);
+      if(o != offsets.end()){
+        J.middleCols(o->second, it->second.cols()) = it->second;
+      }
+    }
+    jacobians.push_back(std::move(J));
+  }
+
+  const size_t budget = std::max<size_t>(1, maxMeasurements_ * windows.size() / timestamps.size());
+
+  // The middle window with an error term of every segment gets kept first. These coverage windows count against the budget.
+  std::vector<size_t> coverage;
+  for(size_t begin = 0, end; begin < windows.size(); begin = end){
+    std::vector<size_t> candidates;
+    for(end = begin; end < windows.size() && windowSegments[end] == windowSegments[begin]; end++){
+      if(jacobians[end].rows() > 0){
+        candidates.push_back(end);
+      }
+    }
+    if(!candidates.empty()){
+      coverage.push_back(candidates[candidates.size() / 2]);
+    }
+  }
+  const size_t numSegments = coverage.size();
+  if(coverage.size() > budget){
+    LOG(WARNING) << "The budget of " << budget << " windows cannot cover all " << coverage.size() << " spline segments with measurements. Covering evenly spaced segments only.";
+    std::vector<size_t> evenlySpaced;
+    for(size_t k = 0; k < budget; k++){
+      evenlySpaced.push_back(coverage[(2 * k + 1) * coverage.size() / (2 * budget)]);
+    }
+    coverage.swap(evenlySpaced);
+  }
+
+  std::vector<bool> keepWindow(windows.size(), false);
+  for(size_t w : selectMostInformative(jacobians, weights, budget, coverage)){
+    keepWindow[w] = true;
+  }
+
+  std::fill(keep.begin(), keep.end(), false);
+  size_t numKept = 0;
+  for(size_t w = 0; w < windows.size(); w++){
+    if(keepWindow[w]){
+      for(size_t i = windows[w].first; i < windows[w].second; i++){
+        keep[i] = true;
+        numKept++;
+      }
+    }
+  }
+  LOG(INFO) << "Selected " << numKept << " of " << timestamps.size() << " measurements (" << std::min(budget, windows.size()) << " of " << windows.size() << " windows, " << coverage.size() << " of them to cover " << numSegments << " spline segments, " << dim << " calibration parameters).";
+  return keep;
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -0,0 +1,136 @@
+#include <aslam/calibration/tools/SplineSegmentBracket.h>
+
+#include <algorithm>
+
+#include <boost/make_shared.hpp>
+#include <glog/logging.h>
+
+#include <aslam/backend/EuclideanExpressionNode.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+
+#include <aslam/calibration/algo/BSplineGramMatrix.h>
+
+namespace aslam {
+namespace calibration {
+
+SplineSegmentBracket::SplineSegmentBracket(const std::vector<sm::timing::NsecTime> & knots, int order, const std::vector<backend::DesignVariable*> & controlVertices, Timestamp lBound, Timestamp uBound) :
+  order_(order),
+  lBound_(lBound),
+  uBound_(uBound)
+{
+  const int p = order - 1, numControlVertices = controlVertices.size();
+  CHECK_GT(order, 0);
+  CHECK_EQ(knots.size(), controlVertices.size() + order) << "Unexpected knot layout!";
+  CHECK_LE(lBound, uBound);
+
+  // The span s covers [knots[s], knots[s + 1]) and is valid for s in [p, numControlVertices - 1].
+  auto findSpan = [&](Timestamp t){
+    const int span = int(std::upper_bound(knots.begin() + p, knots.begin() + numControlVertices, t.getNumerator()) - knots.begin()) - 1;
+    return std::max(p, std::min(numControlVertices - 1, span));
+  };
+  const int firstSpan = findSpan(lBound), lastSpan = findSpan(uBound);
+
+  spanStarts_.assign(knots.begin() + firstSpan, knots.begin() + lastSpan + 2);
+  controlVertices_.assign(controlVertices.begin() + firstSpan - p, controlVertices.begin() + lastSpan + 1);
+
+  // The basis functions of the spans depend on the knots [firstSpan - p, lastSpan + p] only.
+  std::vector<double> knotSeconds;
+  knotSeconds.reserve(lastSpan - firstSpan + 2 * p + 1);
+  for (int i = firstSpan - p; i <= lastSpan + p; ++i) {
+    knotSeconds.push_back(sm::timing::nsecToSec(knots[i] - knots[firstSpan]));
+  }
+  basisDerivatives_.reserve(getNumSpans());
+  for (int s = firstSpan; s <= lastSpan; ++s) {
+    basisDerivatives_.push_back(computeBSplineBasisDerivativesAtSpanStart(knotSeconds, order, s - firstSpan + p));
+  }
+}
+
+int SplineSegmentBracket::getSpan(Timestamp t) const {
+  const sm::timing::NsecTime tn = std::max(lBound_, std::min(uBound_, t)).getNumerator();
+  int span = 0;
+  while (span + 1 < getNumSpans() && spanStarts_[span + 1] <= tn) {
+    ++span;
+  }
+  return span;
+}
+
+Eigen::VectorXd SplineSegmentBracket::getBasisWeights(int span, Timestamp t, int derivative) const {
+  DCHECK(span >= 0 && span < getNumSpans());
+  const Eigen::MatrixXd & D = basisDerivatives_[span];
+  const double x = sm::timing::nsecToSec(std::max(lBound_, std::min(uBound_, t)).getNumerator() - spanStarts_[span]);
+  Eigen::VectorXd weights = Eigen::VectorXd::Zero(order_);
+  double factor = 1; // x^(k - derivative) / (k - derivative)!
+  for (int k = derivative; k < order_; ++k) {
+    weights += D.row(k).transpose() * factor;
+    factor *= x / (k - derivative + 1);
+  }
+  return weights;
+}
+
+namespace {
+class EuclideanSplineExpressionNode : public backend::EuclideanExpressionNode {
+ public:
+  EuclideanSplineExpressionNode(const std::shared_ptr<const SplineSegmentBracket> & bracket, const backend::GenericScalarExpression<Timestamp> & t, int derivative) :
+    bracket_(bracket), t_(t), derivative_(derivative)
+  {
+    for (auto cv : bracket_->getControlVertices()) {
+      CHECK_EQ(3, cv->minimalDimensions()) << "Only three dimensional Euclidean control vertices are supported!";
+    }
+  }
+  virtual ~EuclideanSplineExpressionNode() {}
+
+ protected:
+  Eigen::Vector3d toEuclideanImplementation() const override {
+    const Timestamp t = t_.evaluate();
+    return evaluate(bracket_->getSpan(t), t, derivative_);
+  }
+
+  void evaluateJacobiansImplementation(backend::JacobianContainer & outJacobians) const override {
+    evaluateJacobiansImplementation(outJacobians, Eigen::Matrix3d::Identity());
+  }
+
+  void evaluateJacobiansImplementation(backend::JacobianContainer & outJacobians, const Eigen::MatrixXd & applyChainRule) const override {
+    const Timestamp t = t_.evaluate();
+    const int span = bracket_->getSpan(t);
+    const Eigen::VectorXd weights = bracket_->getBasisWeights(span, t, derivative_);
+    for (int r = 0; r < bracket_->getOrder(); ++r) {
+      outJacobians.add(bracket_->getControlVertex(span, r), applyChainRule * weights[r]);
+    }
+    // Outside the bounds the time is clamped and hence has no effect.
+    if (derivative_ + 1 < bracket_->getOrder() && bracket_->getLowerBound() <= t && t <= bracket_->getUpperBound()) {
+      const Eigen::MatrixXd dValue_dt = evaluate(span, t, derivative_ + 1);
+      t_.evaluateJacobians(outJacobians, applyChainRule * dValue_dt);
+    }
+  }
+
+  void getDesignVariablesImplementation(backend::DesignVariable::set_t & designVariables) const override {
+    designVariables.insert(bracket_->getControlVertices().begin(), bracket_->getControlVertices().end());
+    t_.getDesignVariables(designVariables);
+  }
+
+ private:
+  Eigen::Vector3d evaluate(int span, Timestamp t, int derivative) const {
+    const Eigen::VectorXd weights = bracket_->getBasisWeights(span, t, derivative);
+    Eigen::Vector3d value = Eigen::Vector3d::Zero();
+    Eigen::MatrixXd cv;
+    for (int r = 0; r < bracket_->getOrder(); ++r) {
+      bracket_->getControlVertex(span, r)->getParameters(cv);
+      value += weights[r] * cv.col(0);
+    }
+    return value;
+  }
+
+  std::shared_ptr<const SplineSegmentBracket> bracket_;
+  backend::GenericScalarExpression<Timestamp> t_;
+  int derivative_;
+};
+}
+
+backend::EuclideanExpression createEuclideanSplineExpression(const std::shared_ptr<const SplineSegmentBracket> & bracket, const backend::GenericScalarExpression<Timestamp> & t, int derivative) {
+  CHECK(bracket);
+  CHECK_GE(derivative, 0);
+  return backend::EuclideanExpression(boost::make_shared<EuclideanSplineExpressionNode>(bracket, t, derivative));
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
@@ -0,0 +1,206 @@
+#include <aslam/calibration/tools/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace aslam {
+namespace calibration {
+
+namespace {
+constexpr size_t NoWorker = std::numeric_limits<size_t>::max();
+thread_local const ThreadPool * currentPool = nullptr;
+thread_local size_t currentWorker = NoWorker;
+}
+
+void TaskGroup::taskDone(std::exception_ptr e) {
+  std::lock_guard<std::mutex> lk(m_);
+  if(e && !exception_){
+    exception_ = e;
+  }
+  // Decrement under the lock such that a waiting thread can't miss the notification.
+  if(--pending_ == 0){
+    cv_.notify_all();
+  }
+}
+
+std::ostream & operator << (std::ostream & out, const ThreadPoolStatistics & stats) {
+  return out << "ThreadPoolStatistics(tasksExecuted=" << stats.tasksExecuted << ", tasksStolen=" << stats.tasksStolen << ", taskSeconds=" << stats.taskSeconds << ")";
+}
+
+ThreadPool::ThreadPool(size_t numThreads) {
+  if(numThreads <= 1){
+    return;
+  }
+  for(size_t i = 0; i < numThreads; i++){
+    workers_.emplace_back(new Worker);
+  }
+  for(size_t i = 0; i < numThreads; i++){
+    workers_[i]->thread = std::thread([this, i](){ workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lk(sleepMutex_);
+    stop_ = true;
+  }
+  sleepCv_.notify_all();
+  for(auto & w : workers_){
+    w->thread.join();
+  }
+}
+
+void ThreadPool::run(TaskGroup & group, std::function<void()> task) {
+  group.pending_++;
+  Task t{std::move(task), &group};
+  if(workers_.empty()){
+    execute(t);
+    return;
+  }
+
+  const size_t index = currentPool == this ? currentWorker : nextQueue_++ % workers_.size();
+  {
+    Worker & w = *workers_[index];
+    std::lock_guard<std::mutex> lk(w.m);
+    w.queue.push_back(std::move(t));
+  }
+  {
+    std::lock_guard<std::mutex> lk(sleepMutex_);
+    numQueued_++;
+  }
+  sleepCv_.notify_one();
+}
+
+void ThreadPool::wait(TaskGroup & group) {
+  const size_t index = currentPool == this ? currentWorker : NoWorker;
+  Task task;
+  while(!group.isDone()){
+    if(tryGetTask(index, task)){
+      execute(task);
+    } else {
+      std::unique_lock<std::mutex> lk(group.m_);
+      // Wake up regularly to help with tasks scheduled meanwhile.
+      group.cv_.wait_for(lk, std::chrono::milliseconds(1), [&group](){ return group.isDone(); });
+    }
+  }
+
+  // Synchronize with the last taskDone before the group may get destroyed.
+  std::exception_ptr e;
+  {
+    std::lock_guard<std::mutex> lk(group.m_);
+    std::swap(e, group.exception_);
+  }
+  if(e){
+    std::rethrow_exception(e);
+  }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, const std::function<void(size_t)> & f, size_t grainSize) {
+  if(end <= begin){
+    return;
+  }
+  if(grainSize == 0){
+    grainSize = std::max<size_t>(1, (end - begin) / (4 * getNumThreads()));
+  }
+
+  TaskGroup group;
+  for(size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize){
+    const size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+    run(group, [&f, chunkBegin, chunkEnd](){
+      for(size_t i = chunkBegin; i < chunkEnd; i++){
+        f(i);
+      }
+    });
+  }
+  wait(group);
+}
+
+ThreadPoolStatistics ThreadPool::getStatistics() const {
+  ThreadPoolStatistics stats;
+  stats.tasksExecuted = tasksExecuted_;
+  stats.tasksStolen = tasksStolen_;
+  stats.taskSeconds = taskNanoSeconds_ * 1e-9;
+  return stats;
+}
+
+void ThreadPool::resetStatistics() {
+  tasksExecuted_ = 0;
+  tasksStolen_ = 0;
+  taskNanoSeconds_ = 0;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+  currentPool = this;
+  currentWorker = index;
+  Task task;
+  while(true){
+    if(tryGetTask(index, task)){
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(sleepMutex_);
+    if(stop_ && numQueued_ == 0){
+      break;
+    }
+    sleepCv_.wait(lk, [this](){ return stop_ || numQueued_ > 0; });
+  }
+}
+
+bool ThreadPool::tryPop(size_t index, Task & task) {
+  Worker & w = *workers_[index];
+  std::lock_guard<std::mutex> lk(w.m);
+  if(w.queue.empty()){
+    return false;
+  }
+  task = std::move(w.queue.back());
+  w.queue.pop_back();
+  numQueued_--;
+  return true;
+}
+
+bool ThreadPool::trySteal(size_t thiefIndex, Task & task) {
+  const size_t n = workers_.size();
+  const size_t first = thiefIndex == NoWorker ? 0 : thiefIndex + 1;
+  for(size_t k = 0; k < n; k++){
+    const size_t victim = (first + k) % n;
+    if(victim == thiefIndex){
+      continue;
+    }
+    Worker & w = *workers_[victim];
+    std::lock_guard<std::mutex> lk(w.m);
+    if(!w.queue.empty()){
+      task = std::move(w.queue.front());
+      w.queue.pop_front();
+      numQueued_--;
+      tasksStolen_++;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::tryGetTask(size_t index, Task & task) {
+  if(workers_.empty() || numQueued_ == 0){
+    return false;
+  }
+  return (index != NoWorker && tryPop(index, task)) || trySteal(index, task);
+}
+
+void ThreadPool::execute(Task & task) {
+  const auto start = std::chrono::steady_clock::now();
+  std::exception_ptr e;
+  try {
+    task.f();
+  } catch (...) {
+    e = std::current_exception();
+  }
+  taskNanoSeconds_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  tasksExecuted_++;
+  TaskGroup * group = task.group;
+  task.f = nullptr;
+  group->taskDone(e);
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
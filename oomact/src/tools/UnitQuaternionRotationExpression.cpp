@@ -0,0 +1,51 @@
+#include <aslam/calibration/tools/UnitQuaternionRotationExpression.h>
+
+#include <boost/make_shared.hpp>
+
+#include <aslam/backend/JacobianContainer.hpp>
+#include <aslam/backend/RotationExpressionNodes.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
+
+namespace aslam {
+namespace calibration {
+
+Eigen::Matrix<double, 3, 4> calcUnitQuaternionRotationJacobian(const Eigen::Vector4d & q) {
+  // A rotation update dp changes q to quatPlus(axisAngle2quat(dp)) * q = quatOPlus(q) * axisAngle2quat(dp).
+  // Hence dq = 0.5 * quatOPlus(q).leftCols<3>() * dp and quatOPlus(q) is orthogonal for unit q.
+  return 2.0 * sm::kinematics::quatOPlus(q).transpose().topRows<3>();
+}
+
+namespace {
+class UnitQuaternionRotationExpressionNode : public backend::RotationExpressionNode {
+ public:
+  UnitQuaternionRotationExpressionNode(const backend::VectorExpression<4> & q) : q_(q) {}
+  virtual ~UnitQuaternionRotationExpressionNode() {}
+
+ protected:
+  Eigen::Matrix3d toRotationMatrixImplementation() const override {
+    return sm::kinematics::quat2r(q_.evaluate());
+  }
+
+  void evaluateJacobiansImplementation(backend::JacobianContainer & outJacobians) const override {
+    q_.evaluateJacobians(outJacobians, calcUnitQuaternionRotationJacobian(q_.evaluate()));
+  }
+
+  void evaluateJacobiansImplementation(backend::JacobianContainer & outJacobians, const Eigen::MatrixXd & applyChainRule) const override {
+    q_.evaluateJacobians(outJacobians, applyChainRule * calcUnitQuaternionRotationJacobian(q_.evaluate()));
+  }
+
+  void getDesignVariablesImplementation(backend::DesignVariable::set_t & designVariables) const override {
+    q_.getDesignVariables(designVariables);
+  }
+
+ private:
+  backend::VectorExpression<4> q_;
+};
+}
+
+backend::RotationExpression toUnitQuaternionRotationExpression(const backend::VectorExpression<4> & q) {
+  return backend::RotationExpression(boost::make_shared<UnitQuaternionRotationExpressionNode>(q));
+}
+
+} /* namespace calibration */
+} /* namespace aslam */
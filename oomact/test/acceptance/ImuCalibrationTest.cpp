@@ -1,8 +1,11 @@
+#include <chrono>
 #include <memory>
+#include <string>
 
 #include <gtest/gtest.h>
 
 #include <aslam/calibration/calibrator/CalibratorI.h>
+#include <aslam/calibration/calibrator/ModelAtTimeCache.h>
 #include <aslam/calibration/data/AccelerometerMeasurement.h>
 #include <aslam/calibration/data/GyroscopeMeasurement.h>
 #include <aslam/calibration/model/FrameGraphModel.h>
@@ -79,3 +82,122 @@ TEST(CalibrationTestSuite, testImuCalibrationCircle) {
   EXPECT_NEAR(0, imu.getRotationQuaternionToParent()[1], 0.01);
 }
 
+
+namespace {
+struct ImuCircleResult {
+  double translationError, rotationError;
+  /// Only measured with timeBuildAndSolve. buildSeconds is the time spent for the problem beyond its optimization.
+  double buildSeconds = 0, solveSeconds = 0;
+  ModelAtTimeCacheStatistics modelAtTimeCacheStatistics;
+};
+
+double timeCalibration(BatchCalibratorI & c) {
+  const auto start = std::chrono::steady_clock::now();
+  c.calibrate();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// With timeBuildAndSolve the calibration runs twice on a reused problem. The second run restores the initial values and only optimizes again.
+ImuCircleResult calibrateImuOnCircle(const std::string & imuErrorTermConfig, const std::string & calibratorConfig = "", bool timeBuildAndSolve = false, const std::string & biasConfig = "hasBias=false") {
+  auto vs = ValueStoreRef::fromString(
+      "model{"
+        "Gravity{used=true,magnitude=9.81}"
+        "frames=body:world,"
+        "pose{referenceFrame=body,targetFrame=world,covPosition/sigma=0.01,covOrientation/sigma=0.01,absoluteMeasurements=true,rotation/used=false,translation/used=false,delay/used=false}"
+        "imu{used=true,referenceFrame=body,inertiaFrame=world,"
+          "acc{" + biasConfig + ",noise{cov/sigma=1,biasRandomWalk=4e-3}}"
+          "gyro{" + biasConfig + ",noise{cov/sigma=1,biasRandomWalk=4e-3}}"
+          "rotation{yaw=0,pitch=0,roll=0}"
+          "translation{x=0,y=0,z=0}"
+          "delay/used=false"
+          + (imuErrorTermConfig.empty() ? "" : "," + imuErrorTermConfig) +
+        "}"
+        "traj{frame=body,referenceFrame=world,initWithPoseMeasurements=true,McSensor=pose,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0000001,transSplineOrder=4,transFittingLambda=0.0000001}}"
+      "}"
+      "calibrator{" + calibratorConfig + (timeBuildAndSolve ? "reuseProblem=true," : "") + "verbose=true,timeBaseSensor=pose,estimator/optimizer/maxIterations=150}"
+    );
+
+  FrameGraphModel m(vs.getChild("model"));
+  PoseSensor psA(m, "pose");
+  Imu imu(m, "imu");
+  PoseTrajectory traj(m, "traj");
+  m.addModulesAndInit(psA, imu, traj);
+
+  imu.getTranslationVariable().set({0, 1., 0.0});
+  const double rotUpdate[] = {0., 0.1, 0.};
+  imu.getRotationVariable().update(rotUpdate, 3);
+
+  auto spModel = aslam::to_local_shared_ptr(m);
+  auto c = createBatchCalibrator(vs.getChild("calibrator"), spModel);
+
+  for (auto& p : MmcsCircle.getPoses(1.0)) {
+    psA.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    c->addMeasurementTimestamp(p.time, psA);
+    sm::kinematics::Transformation T(p.q, p.p);
+    imu.addGyroscopeMeasurement(*c, GyroscopeMeasurement(Eigen::Vector3d::UnitZ()), p.time);
+    imu.addAccelerometerMeasurement(*c, AccelerometerMeasurement(T.C().transpose() * (Eigen::Vector3d::UnitZ() * 9.81 - p.p).eval()), p.time);
+  }
+
+  ImuCircleResult result;
+  const double buildAndSolveSeconds = timeCalibration(*c);
+  if (timeBuildAndSolve) {
+    result.solveSeconds = timeCalibration(*c);
+    result.buildSeconds = buildAndSolveSeconds - result.solveSeconds;
+  }
+  result.translationError = imu.getTranslationToParent().norm();
+  result.rotationError = imu.getRotationQuaternionToParent().head<3>().norm();
+  result.modelAtTimeCacheStatistics = c->getModelAtTimeCacheStatistics();
+  return result;
+}
+
+void recordTimes(const std::string & name, const ImuCircleResult & result) {
+  ::testing::Test::RecordProperty(name + "BuildMicroseconds", std::to_string(int(result.buildSeconds * 1e6)));
+  ::testing::Test::RecordProperty(name + "SolveMicroseconds", std::to_string(int(result.solveSeconds * 1e6)));
+}
+}
+
+TEST(CalibrationTestSuite, testImuCalibrationCirclePreintegratedVersusPerSample) {
+  const ImuCircleResult perSample = calibrateImuOnCircle("", "", true);
+  const ImuCircleResult preintegrated = calibrateImuOnCircle("preintegration{used=true,keyframeInterval=0.1}", "", true);
+  recordTimes("perSample", perSample);
+  recordTimes("preintegrated", preintegrated);
+
+  EXPECT_NEAR(0, perSample.translationError, 0.0001);
+  EXPECT_NEAR(0, perSample.rotationError, 0.01);
+  EXPECT_NEAR(0, preintegrated.translationError, 0.0001);
+  EXPECT_NEAR(0, preintegrated.rotationError, 0.01);
+}
+
+TEST(CalibrationTestSuite, testImuCalibrationCircleBlockedVersusPerSample) {
+  const ImuCircleResult perSample = calibrateImuOnCircle("", "", true);
+  const ImuCircleResult blocked = calibrateImuOnCircle("errorTermBlocks{used=true,maxSamples=32}", "", true);
+  recordTimes("perSample", perSample);
+  recordTimes("blocked", blocked);
+
+  // The blocks represent the same cost function.
+  EXPECT_NEAR(perSample.translationError, blocked.translationError, 1e-6);
+  EXPECT_NEAR(perSample.rotationError, blocked.rotationError, 1e-6);
+}
+
+TEST(CalibrationTestSuite, testImuCalibrationCircleBlockedVersusPerSampleWithBiasSplines) {
+  const std::string biasConfig = "biasSpline{knotsPerSecond=2,splineOrder=3,fittingLambda=0.0000001}";
+  const ImuCircleResult perSample = calibrateImuOnCircle("", "", false, biasConfig);
+  const ImuCircleResult blocked = calibrateImuOnCircle("errorTermBlocks{used=true,maxSamples=32}", "", false, biasConfig);
+
+  // The blocks evaluate the bias splines per segment instead of with the splines' expressions.
+  EXPECT_NEAR(perSample.translationError, blocked.translationError, 1e-6);
+  EXPECT_NEAR(perSample.rotationError, blocked.rotationError, 1e-6);
+}
+
+TEST(CalibrationTestSuite, testImuCalibrationCircleWithModelAtTimeCache) {
+  const ImuCircleResult perSample = calibrateImuOnCircle("");
+  const ImuCircleResult cached = calibrateImuOnCircle("", "cacheModelAtTime=true,");
+
+  EXPECT_EQ(0u, perSample.modelAtTimeCacheStatistics.hits + perSample.modelAtTimeCacheStatistics.misses);
+  // Both IMU streams share the clock. Every gyroscope sample (first order) is served by the accelerometer sample's (second order) model.
+  const ModelAtTimeCacheStatistics & stats = cached.modelAtTimeCacheStatistics;
+  EXPECT_GT(stats.hits, 0u);
+  EXPECT_GT(stats.getHitRate(), 0.3);
+  EXPECT_NEAR(perSample.translationError, cached.translationError, 1e-9);
+  EXPECT_NEAR(perSample.rotationError, cached.rotationError, 1e-9);
+}
@@ -0,0 +1,152 @@
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "aslam/calibration/calibrator/CalibratorI.h"
+#include <aslam/calibration/model/FrameGraphModel.h>
+#include <aslam/calibration/model/ModuleList.h>
+#include <aslam/calibration/model/PoseTrajectory.h>
+#include <aslam/calibration/model/sensors/PoseSensor.h>
+#include <aslam/calibration/tools/Interval.h>
+#include <aslam/calibration/test/MockMotionCaptureSource.h>
+#include <aslam/calibration/tools/SmartPointerTools.h>
+
+using namespace aslam::calibration;
+using namespace aslam::calibration::test;
+
+TEST(CalibrationTestSuite, testIncrementalEstimateTwoPoseSensors) {
+  auto vs = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "b{referenceFrame=body,targetFrame=world,rotation{used=true,yaw=0.1,pitch=0.,roll=0.},translation{used=true,x=0,y=5,z=0},delay/used=false}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=5,rotSplineOrder=4,rotFittingLambda=0.001,transSplineOrder=4,transFittingLambda=0.001}}"
+    );
+
+  FrameGraphModel m(vs);
+  PoseSensor mcSensorA(m, "a", vs);
+  PoseSensor mcSensorB(m, "b", vs);
+  PoseTrajectory traj(m, "traj", vs);
+  m.addModulesAndInit(mcSensorA, mcSensorB, traj);
+
+  auto vsCalib = ValueStoreRef::fromString(
+      "acceptConstantErrorTerms=true\n"
+      "timeBaseSensor=a\n"
+      "windowDuration=0.5\n"
+    );
+  auto c = createIncrementalCalibrator(vsCalib, aslam::to_local_shared_ptr(m));
+
+  int numWindows = 0;
+  c->setWindowFullHandler([&](IncrementalCalibratorI & calib){
+    numWindows++;
+    calib.addMeasurementsAsNewBatch();
+  });
+
+  for (auto& p : MmcsRotatingStraightLine.getPoses(0.0, 1.5)) {
+    mcSensorA.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    c->addMeasurementTimestamp(p.time, mcSensorA);
+    mcSensorB.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    c->invokeWindowFullHanlderIfNecessary();
+  }
+  EXPECT_EQ(2, numWindows);
+  EXPECT_TRUE(c->invokeWindowFullHanlderIfNecessary(true));
+  EXPECT_EQ(3, numWindows);
+  EXPECT_FALSE(c->isNextWindowScheduled());
+  EXPECT_EQ(0u, c->getCurrentStorage().size());
+
+  EXPECT_NEAR(0, mcSensorB.getTranslationToParent()[1], 0.0001);
+  EXPECT_NEAR(0, sm::kinematics::quat2AxisAngle(mcSensorB.getRotationQuaternionToParent())[2], 0.0001);
+}
+
+TEST(CalibrationTestSuite, testIncrementalEstimateTwoPoseSensorsWithOverlappingWindows) {
+  auto vs = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "b{referenceFrame=body,targetFrame=world,rotation{used=true,yaw=0.1,pitch=0.,roll=0.},translation{used=true,x=0,y=5,z=0},delay/used=false}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=5,rotSplineOrder=4,rotFittingLambda=0.001,transSplineOrder=4,transFittingLambda=0.001}}"
+    );
+
+  FrameGraphModel m(vs);
+  PoseSensor mcSensorA(m, "a", vs);
+  PoseSensor mcSensorB(m, "b", vs);
+  PoseTrajectory traj(m, "traj", vs);
+  m.addModulesAndInit(mcSensorA, mcSensorB, traj);
+
+  auto vsCalib = ValueStoreRef::fromString(
+      "acceptConstantErrorTerms=true\n"
+      "timeBaseSensor=a\n"
+      "windowDuration=0.5\n"
+      "windowOverlap=0.25\n"
+    );
+  auto c = createIncrementalCalibrator(vsCalib, aslam::to_local_shared_ptr(m));
+
+  std::vector<Interval> windows;
+  c->setWindowFullHandler([&](IncrementalCalibratorI & calib){
+    windows.push_back(calib.getCurrentEffectiveBatchInterval());
+    calib.addMeasurementsAsNewBatch();
+  });
+
+  for (auto& p : MmcsRotatingStraightLine.getPoses(0.0, 1.5)) {
+    mcSensorA.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    c->addMeasurementTimestamp(p.time, mcSensorA);
+    mcSensorB.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    const size_t numWindows = windows.size();
+    if(c->invokeWindowFullHanlderIfNecessary()){
+      ASSERT_EQ(numWindows + 1, windows.size());
+      // The next window's storage already holds the overlap's measurements of both sensors.
+      EXPECT_EQ(2u, c->getCurrentStorage().size());
+      EXPECT_TRUE(c->getCurrentEffectiveBatchInterval());
+      EXPECT_FALSE(c->isNextWindowScheduled());
+    }
+  }
+  ASSERT_GT(windows.size(), 2u);
+  for(size_t i = 1; i < windows.size(); i++){
+    EXPECT_LT(windows[i].start, windows[i - 1].end) << i;
+    EXPECT_GE(windows[i].start, windows[i - 1].end - Duration(0.25)) << i;
+    EXPECT_GE(static_cast<double>(windows[i].getElapsedTime()), 0.5) << i;
+  }
+
+  const size_t numWindows = windows.size();
+  if(c->isNextWindowScheduled()){
+    EXPECT_TRUE(c->invokeWindowFullHanlderIfNecessary(true));
+    EXPECT_EQ(numWindows + 1, windows.size());
+  }
+  // Only the overlap is left, which isn't worth another window.
+  EXPECT_FALSE(c->isNextWindowScheduled());
+  EXPECT_FALSE(c->invokeWindowFullHanlderIfNecessary(true));
+
+  EXPECT_NEAR(0, mcSensorB.getTranslationToParent()[1], 0.0001);
+  EXPECT_NEAR(0, sm::kinematics::quat2AxisAngle(mcSensorB.getRotationQuaternionToParent())[2], 0.0001);
+}
+
+TEST(CalibrationTestSuite, testIncrementalCalibratorDataCollection) {
+  auto vs = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "b{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+    );
+
+  FrameGraphModel m(vs);
+  PoseSensor mcSensorA(m, "a", vs);
+  PoseSensor mcSensorB(m, "b", vs);
+  m.addModulesAndInit(mcSensorA, mcSensorB);
+
+  auto c = createIncrementalCalibrator(ValueStoreRef::fromString("timeBaseSensor=a\n"), aslam::to_local_shared_ptr(m));
+
+  EXPECT_EQ(0u, c->getNumModulesDataCollecting());
+  EXPECT_TRUE(c->isMeasurementRelevant(mcSensorB, Timestamp(0.5)));
+
+  c->startCollectingDataFrom(ModuleList{mcSensorB}, Timestamp(1.0));
+  EXPECT_EQ(1u, c->getNumModulesDataCollecting());
+  EXPECT_FALSE(c->isMeasurementRelevant(mcSensorB, Timestamp(0.5)));
+  EXPECT_TRUE(c->isMeasurementRelevant(mcSensorB, Timestamp(1.5)));
+  EXPECT_TRUE(c->isMeasurementRelevant(mcSensorA, Timestamp(0.5)));
+
+  c->stopCollectingDataFrom(ModuleList{mcSensorB}, Timestamp(2.0));
+  EXPECT_EQ(0u, c->getNumModulesDataCollecting());
+  EXPECT_TRUE(c->isMeasurementRelevant(mcSensorB, Timestamp(1.5)));
+  EXPECT_FALSE(c->isMeasurementRelevant(mcSensorB, Timestamp(2.5)));
+}
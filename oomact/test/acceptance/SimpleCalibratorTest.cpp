@@ -1,9 +1,13 @@
 #include <cmath>
+#include <memory>
+#include <string>
 
 #include <gtest/gtest.h>
 
 #include "aslam/calibration/calibrator/CalibratorI.h"
+#include <aslam/calibration/calibrator/ModelAtTimeCache.h>
 #include <aslam/calibration/data/PositionMeasurement.h>
+#include <aslam/calibration/model/CalibrationVariable.h>
 #include <aslam/calibration/model/FrameGraphModel.h>
 #include <aslam/calibration/model/PoseTrajectory.h>
 #include <aslam/calibration/model/sensors/PoseSensor.h>
@@ -15,43 +19,211 @@
 using namespace aslam::calibration;
 using namespace aslam::calibration::test;
 
-TEST(CalibrationTestSuite, testEstimateTwoPoseSensors) {
-  auto vs = ValueStoreRef::fromString(
+namespace {
+/// Two pose sensors observing the same body. b's initial calibration is off by 5m in y and 0.1rad in yaw.
+struct TwoPoseSensorsProblem {
+  ValueStoreRef vs;
+  FrameGraphModel m;
+  PoseSensor a, b;
+  PoseTrajectory traj;
+  std::unique_ptr<BatchCalibratorI> c;
+
+  TwoPoseSensorsProblem(const std::string & extraCalibratorConfig, const std::string & delayConfigB = "delay/used=false") :
+    vs(ValueStoreRef::fromString(
       "Gravity{used=false}"
       "frames=body:world,"
       "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
-      "b{referenceFrame=body,targetFrame=world,rotation{used=true,yaw=0.1,pitch=0.,roll=0.},translation{used=true,x=0,y=5,z=0},delay/used=false}"
+      "b{referenceFrame=body,targetFrame=world,rotation{used=true,yaw=0.1,pitch=0.,roll=0.},translation{used=true,x=0,y=5,z=0}," + delayConfigB + "}"
       "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=5,rotSplineOrder=4,rotFittingLambda=0.001,transSplineOrder=4,transFittingLambda=0.001}}"
-    );
+    )),
+    m(vs),
+    a(m, "a", vs),
+    b(m, "b", vs),
+    traj(m, "traj", vs)
+  {
+    m.addModulesAndInit(a, b, traj);
 
-  FrameGraphModel m(vs);
-  PoseSensor mcSensorA(m, "a", vs);
-  PoseSensor mcSensorB(m, "b", vs);
-  PoseTrajectory traj(m, "traj", vs);
-  m.addModulesAndInit(mcSensorA, mcSensorB, traj);
+    c = createBatchCalibrator(ValueStoreRef::fromString(
+        "verbose=true\n"
+        "acceptConstantErrorTerms=true\n"
+        "timeBaseSensor=a\n"
+        + extraCalibratorConfig
+      ), m);
 
-  EXPECT_EQ(2u, m.getCalibrationVariables().size());
-  EXPECT_DOUBLE_EQ(5.0, mcSensorB.getTranslationToParent()[1]);
-  EXPECT_NEAR(0.1, std::abs(sm::kinematics::quat2AxisAngle(mcSensorB.getRotationQuaternionToParent())[2]), 1e-6); // abs for conventional neutrality
+    for (auto& p : MmcsRotatingStraightLine.getPoses(0.0, 1.0)) {
+      a.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+      c->addMeasurementTimestamp(p.time, a);
+      b.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    }
+  }
 
-  auto vsCalib = ValueStoreRef::fromString(
-      "verbose=true\n"
-      "acceptConstantErrorTerms=true\n"
-      "timeBaseSensor=a\n"
-    );
-  auto c = createBatchCalibrator(vsCalib, std::shared_ptr<Model>(&m, sm::null_deleter()));
+  void expectInitialCalibration() const {
+    EXPECT_DOUBLE_EQ(5.0, b.getTranslationToParent()[1]);
+    EXPECT_NEAR(0.1, std::abs(sm::kinematics::quat2AxisAngle(b.getRotationQuaternionToParent())[2]), 1e-6); // abs for conventional neutrality
+  }
 
-  const double startTime = 0.0, endTime = 1.0;
+  void expectConverged() const {
+    EXPECT_NEAR(0, b.getTranslationToParent()[1], 0.0001);
+    EXPECT_NEAR(0, sm::kinematics::quat2AxisAngle(b.getRotationQuaternionToParent())[2], 0.0001);
+  }
 
-  for (auto& p : MmcsRotatingStraightLine.getPoses(startTime, endTime)) {
-    mcSensorA.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
-    c->addMeasurementTimestamp(p.time, mcSensorA);
-    mcSensorB.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+  /// b's translation followed by its rotation quaternion.
+  Eigen::VectorXd getCalibration() const {
+    Eigen::VectorXd v(7);
+    v << b.getTranslationToParent(), b.getRotationQuaternionToParent();
+    return v;
   }
-  c->calibrate();
+};
+
+/// The calibration of b resulting from the plain default configuration.
+Eigen::VectorXd calibrateWithDefaults() {
+  TwoPoseSensorsProblem p("");
+  p.c->calibrate();
+  return p.getCalibration();
+}
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensors) {
+  TwoPoseSensorsProblem p("");
+  EXPECT_EQ(2u, p.m.getCalibrationVariables().size());
+  p.expectInitialCalibration();
+
+  p.c->calibrate();
+  p.expectConverged();
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithParallelFactorCreation) {
+  TwoPoseSensorsProblem p("numThreads=3\n");
+  p.c->calibrate();
+  p.expectConverged();
+
+  // The error terms get merged in module order. Hence, the problem and its solution must not depend on the thread scheduling.
+  EXPECT_TRUE(p.getCalibration().isApprox(calibrateWithDefaults(), 1e-12));
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithModelAtTimeCache) {
+  TwoPoseSensorsProblem p("cacheModelAtTime=true\nnumThreads=2\n");
+  p.c->calibrate();
+  p.expectConverged();
+
+  // Both sensors measure at the same times and have no delay. Hence, the second sensor's models come from the cache.
+  const ModelAtTimeCacheStatistics stats = p.c->getModelAtTimeCacheStatistics();
+  EXPECT_GT(stats.models, 0u);
+  EXPECT_GT(stats.getHitRate(), 0.4);
+
+  EXPECT_TRUE(p.getCalibration().isApprox(calibrateWithDefaults(), 1e-12));
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithSchurComplementSolver) {
+  TwoPoseSensorsProblem p("estimator/solver=schurComplement\n");
+  p.c->calibrate();
+  p.expectConverged();
+
+  const Eigen::VectorXd expected = calibrateWithDefaults();
+  for(int i = 0; i < expected.size(); i++){
+    EXPECT_NEAR(expected[i], p.getCalibration()[i], 1e-6) << i;
+  }
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithTimeSortedOrdering) {
+  TwoPoseSensorsProblem p("estimator/timeSortedOrdering=true\n");
+  p.c->calibrate();
+  p.expectConverged();
+
+  // The rotation spline's variables get inserted before the translation spline's. Sorting them by time interleaves them.
+  const auto bandwidths = p.c->getStateBandwidths();
+  EXPECT_GT(bandwidths.second, 0u);
+  EXPECT_LT(2 * bandwidths.second, bandwidths.first);
+
+  const Eigen::VectorXd expected = calibrateWithDefaults();
+  for(int i = 0; i < expected.size(); i++){
+    EXPECT_NEAR(expected[i], p.getCalibration()[i], 1e-6) << i;
+  }
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithTimeSortedOrderingAndCalibPriors) {
+  TwoPoseSensorsProblem p("estimator/timeSortedOrdering=true\nuseCalibPriors=true\n");
+  p.c->calibrate();
+  EXPECT_LT(p.c->getStateBandwidths().second, p.c->getStateBandwidths().first);
+
+  TwoPoseSensorsProblem q("useCalibPriors=true\n");
+  q.c->calibrate();
+  // Without the time sorted ordering the bandwidths don't get computed.
+  EXPECT_EQ(std::make_pair(size_t(0), size_t(0)), q.c->getStateBandwidths());
+
+  // The priors pull towards the initial values. The ordering must not matter.
+  EXPECT_LT(std::abs(p.b.getTranslationToParent()[1]), 5.0);
+  for(int i = 0; i < 7; i++){
+    EXPECT_NEAR(q.getCalibration()[i], p.getCalibration()[i], 1e-6) << i;
+  }
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsTwiceReusingTheProblem) {
+  TwoPoseSensorsProblem p("reuseProblem=true\n");
+  p.c->calibrate();
+  p.expectConverged();
+  const Eigen::VectorXd first = p.getCalibration();
+
+  // The reused problem starts again from the initial values and must therefore yield the same solution.
+  p.c->calibrate();
+  p.expectConverged();
+  EXPECT_TRUE(p.getCalibration().isApprox(first, 1e-12));
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsReusingTheProblemAfterActivityChange) {
+  TwoPoseSensorsProblem p("reuseProblem=true\n");
+  p.b.setObserveOnly(true);
+  p.c->calibrate();
+  p.expectInitialCalibration();
+
+  // b's error terms were not part of the first problem. Hence, it must be rebuilt.
+  p.b.setObserveOnly(false);
+  p.c->calibrate();
+  p.expectConverged();
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithCovariances) {
+  TwoPoseSensorsProblem p("estimator/computeCovariances=true\n");
+  for(auto & cv : p.m.getCalibrationVariables()){
+    EXPECT_EQ(0, p.c->getMarginalCovariance(*cv).size()) << cv->getName();
+  }
+
+  p.c->calibrate();
+  p.expectConverged();
+
+  for(auto & cv : p.m.getCalibrationVariables()){
+    const Eigen::MatrixXd cov = p.c->getMarginalCovariance(*cv);
+    ASSERT_EQ(cv->getDimension(), cov.rows()) << cv->getName();
+    ASSERT_EQ(cov.rows(), cov.cols()) << cv->getName();
+    EXPECT_TRUE(cov.isApprox(cov.transpose())) << cv->getName();
+    EXPECT_GT(cov.diagonal().minCoeff(), 0) << cv->getName();
+  }
+}
+
+TEST(CalibrationTestSuite, testEstimateTwoPoseSensorsWithFixedDelay) {
+  TwoPoseSensorsProblem p("cacheModelAtTime=true\n", "delay{used=true,estimate=false,lowerBound=-0.01,upperBound=0.01}");
+  EXPECT_EQ(3u, p.m.getCalibrationVariables().size());
+
+  p.c->calibrate();
+  p.expectConverged();
+  EXPECT_TRUE(p.b.hasDelay());
+  EXPECT_FALSE(p.b.isDelayActive());
+
+  // The fixed delay yields the constant time model, which depends neither on the delay nor on a time search.
+  const Timestamp t = 0.5;
+  const auto & delay = static_cast<const CalibrationVariable &>(p.b.getDelayVariable()).getDesignVariable();
+  aslam::backend::DesignVariable::set_t designVariables, movingTimeDesignVariables;
+  p.b.getTransformationExpressionToAtMeasurementTimestamp(*p.c, t, p.b.getTargetFrame(), true).getDesignVariables(designVariables);
+  EXPECT_FALSE(designVariables.empty());
+  EXPECT_EQ(0u, designVariables.count(const_cast<aslam::backend::DesignVariable*>(&delay)));
+  EXPECT_TRUE(p.c->getModelAt(p.b, t, 0, {true}).getTransformationToFrom(p.b.getTargetFrame(), p.b.getReferenceFrame()).toTransformationMatrix().isApprox(
+      p.c->getModelAt(t - p.b.getDelay(), 0, {true}).getTransformationToFrom(p.b.getTargetFrame(), p.b.getReferenceFrame()).toTransformationMatrix(), 1e-12));
+  // In contrast, the moving time model depends on the delay.
+  p.c->getModelAt(p.b.getBoundedTimestampExpression(*p.c, t), 0, {true}).getTransformationToFrom(p.b.getTargetFrame(), p.b.getReferenceFrame()).getDesignVariables(movingTimeDesignVariables);
+  EXPECT_EQ(1u, movingTimeDesignVariables.count(const_cast<aslam::backend::DesignVariable*>(&delay)));
 
-  EXPECT_NEAR(0, mcSensorB.getTranslationToParent()[1], 0.0001);
-  EXPECT_NEAR(0, sm::kinematics::quat2AxisAngle(mcSensorB.getRotationQuaternionToParent())[2], 0.0001);
+  // A zero fixed delay must not change anything.
+  EXPECT_TRUE(p.getCalibration().isApprox(calibrateWithDefaults(), 1e-12));
 }
 
 
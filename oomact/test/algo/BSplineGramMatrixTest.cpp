@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aslam/calibration/algo/BSplineGramMatrix.h>
+
+using namespace aslam::calibration;
+
+namespace {
+/// The uniform B-spline basis function of the given order with support [0, order), by the Cox-de Boor recursion.
+double coxDeBoor(int order, double t) {
+  if(order == 1){
+    return t >= 0 && t < 1 ? 1 : 0;
+  }
+  return (t * coxDeBoor(order - 1, t) + (order - t) * coxDeBoor(order - 1, t - 1)) / (order - 1);
+}
+
+/// The i-th basis function being nonzero on the segment [0, 1].
+double basis(int order, int i, double u) {
+  return coxDeBoor(order, u + order - 1 - i);
+}
+
+/// The derivative-th derivative of basis by central finite differences.
+double basisDerivative(int order, int i, int derivative, double u, double h = 1e-3) {
+  if(derivative == 0){
+    return basis(order, i, u);
+  }
+  return (basisDerivative(order, i, derivative - 1, u + h / 2, h) - basisDerivative(order, i, derivative - 1, u - h / 2, h)) / h;
+}
+}
+
+TEST(BSplineGramMatrix, basisMatrixMatchesCoxDeBoor) {
+  for(int order = 1; order <= 6; order++){
+    const Eigen::MatrixXd M = computeUniformBSplineBasisMatrix(order);
+    for(double u = 0.05; u < 1; u += 0.1){
+      for(int i = 0; i < order; i++){
+        double value = 0;
+        for(int p = 0; p < order; p++){
+          value += M(p, i) * std::pow(u, p);
+        }
+        EXPECT_NEAR(basis(order, i, u), value, 1e-12) << "order=" << order << ", i=" << i << ", u=" << u;
+      }
+    }
+  }
+}
+
+TEST(BSplineGramMatrix, gramMatrixMatchesNumericIntegration) {
+  const int numSamples = 2000;
+  for(int order = 2; order <= 6; order++){
+    for(int derivative = 0; derivative < order - 1; derivative++){
+      const Eigen::MatrixXd G = computeUniformBSplineGramMatrix(order, derivative);
+      Eigen::MatrixXd numericG = Eigen::MatrixXd::Zero(order, order);
+      for(int s = 0; s < numSamples; s++){
+        const double u = (s + 0.5) / numSamples;
+        Eigen::VectorXd b(order);
+        for(int i = 0; i < order; i++){
+          b[i] = basisDerivative(order, i, derivative, u);
+        }
+        numericG += b * b.transpose() / numSamples;
+      }
+      EXPECT_NEAR(0, (G - numericG).norm() / G.norm(), 1e-4) << "order=" << order << ", derivative=" << derivative;
+    }
+  }
+}
+
+TEST(BSplineGramMatrix, gramMatrixSqrt) {
+  for(int order = 1; order <= 6; order++){
+    for(int derivative = 0; derivative <= order; derivative++){
+      const Eigen::MatrixXd G = computeUniformBSplineGramMatrix(order, derivative);
+      const Eigen::MatrixXd U = computeUniformBSplineGramMatrixSqrt(order, derivative);
+      EXPECT_EQ(std::max(0, order - derivative), U.rows());
+      EXPECT_EQ(order, U.cols());
+      EXPECT_NEAR(0, (U.transpose() * U - G).norm(), 1e-12) << "order=" << order << ", derivative=" << derivative;
+    }
+  }
+  // Constant splines have no derivative.
+  const Eigen::MatrixXd G = computeUniformBSplineGramMatrix(4, 1);
+  EXPECT_NEAR(0, (G * Eigen::VectorXd::Ones(4)).norm(), 1e-12);
+}
+
+TEST(BSplineGramMatrix, basisDerivativesMatchUniformBasisMatrix) {
+  const double h = 0.25;
+  for(int order = 1; order <= 6; order++){
+    std::vector<double> knots;
+    for(int i = 0; i < 2 * order + 2; i++){
+      knots.push_back(1 + i * h);
+    }
+    const Eigen::MatrixXd M = computeUniformBSplineBasisMatrix(order);
+    for(int span = order - 1; span + order - 1 < int(knots.size()); span++){
+      const Eigen::MatrixXd D = computeBSplineBasisDerivativesAtSpanStart(knots, order, span);
+      // The monomial coefficient of u^k with t = knots[span] + u h is the k-th derivative times h^k / k!.
+      double factorial = 1;
+      for(int k = 0; k < order; k++){
+        factorial *= std::max(1, k);
+        EXPECT_NEAR(0, (D.row(k) * std::pow(h, k) / factorial - M.row(k)).norm(), 1e-9) << "order=" << order << ", span=" << span << ", k=" << k;
+      }
+    }
+  }
+}
+
+TEST(BSplineGramMatrix, basisDerivativesOnNonUniformKnots) {
+  const std::vector<double> knots = {0, 0.1, 0.3, 0.35, 0.8, 1.0, 1.7, 1.9};
+  const int order = 4, span = 3;
+  const Eigen::MatrixXd D = computeBSplineBasisDerivativesAtSpanStart(knots, order, span);
+  // The basis functions form a partition of unity.
+  EXPECT_NEAR(1, D.row(0).sum(), 1e-12);
+  for(int k = 1; k < order; k++){
+    EXPECT_NEAR(0, D.row(k).sum(), 1e-9) << "k=" << k;
+  }
+  // The Taylor polynomial matches the Cox-de Boor recursion anywhere on the span.
+  std::function<double(int, int, double)> coxDeBoor = [&](int i, int o, double t) -> double {
+    if(o == 1){
+      return knots[i] <= t && t < knots[i + 1] ? 1 : 0;
+    }
+    double v = 0;
+    if(knots[i + o - 1] > knots[i]) v += (t - knots[i]) / (knots[i + o - 1] - knots[i]) * coxDeBoor(i, o - 1, t);
+    if(knots[i + o] > knots[i + 1]) v += (knots[i + o] - t) / (knots[i + o] - knots[i + 1]) * coxDeBoor(i + 1, o - 1, t);
+    return v;
+  };
+  for(double t = knots[span]; t < knots[span + 1]; t += 0.01){
+    for(int r = 0; r < order; r++){
+      double value = 0, factorial = 1;
+      for(int k = 0; k < order; k++){
+        factorial *= std::max(1, k);
+        value += D(k, r) / factorial * std::pow(t - knots[span], k);
+      }
+      EXPECT_NEAR(coxDeBoor(span - order + 1 + r, order, t), value, 1e-9) << "t=" << t << ", r=" << r;
+    }
+  }
+}
+
+TEST(BSplineGramMatrix, fitOnNonUniformKnots) {
+  const std::vector<double> knots = {-0.3, -0.2, -0.1, 0, 0.1, 0.15, 0.4, 0.45, 0.5, 1.0, 1.5, 2.0, 2.5};
+  const int order = 4, numControlVertices = knots.size() - order;
+  auto basisAt = [&](double t, int & span){
+    span = order - 1;
+    while(span < numControlVertices - 1 && knots[span + 1] <= t){
+      span++;
+    }
+    const Eigen::MatrixXd D = computeBSplineBasisDerivativesAtSpanStart(knots, order, span);
+    Eigen::RowVectorXd b = D.row(0);
+    double factorial = 1;
+    for(int k = 1; k < order; k++){
+      factorial *= k;
+      b += D.row(k) / factorial * std::pow(t - knots[span], k);
+    }
+    return b;
+  };
+
+  // Points sampled from a spline yield its control vertices.
+  const Eigen::MatrixXd controlVertices = Eigen::MatrixXd::Random(2, numControlVertices);
+  std::vector<double> times;
+  Eigen::MatrixXd points(2, 200);
+  for(int i = 0; i < points.cols(); i++){
+    times.push_back(knots[order - 1] + (knots[numControlVertices] - knots[order - 1]) * i / (points.cols() - 1));
+    int span;
+    const Eigen::RowVectorXd b = basisAt(times.back(), span);
+    points.col(i) = controlVertices.middleCols(span - order + 1, order) * b.transpose();
+  }
+  EXPECT_NEAR(0, (fitBSplineControlVertices(knots, order, times, points, 0) - controlVertices).norm(), 1e-9);
+
+  // Without any points between 0.4 and 1.5 the regularization continues a linear motion through the gap.
+  std::vector<double> gapTimes;
+  std::vector<double> gapValues;
+  for(double t : times){
+    if(t < 0.4 || t > 1.5){
+      gapTimes.push_back(t);
+      gapValues.push_back(2 * t + 1);
+    }
+  }
+  const Eigen::MatrixXd linear = fitBSplineControlVertices(knots, order, gapTimes, Eigen::Map<Eigen::MatrixXd>(gapValues.data(), 1, gapValues.size()), 1e-3);
+  ASSERT_EQ(numControlVertices, linear.cols());
+  for(int i = 0; i < numControlVertices; i++){
+    // The control vertices of a linear function are its values at the Greville abscissae.
+    const double greville = (knots[i + 1] + knots[i + 2] + knots[i + 3]) / 3;
+    EXPECT_NEAR(2 * greville + 1, linear(0, i), 1e-9) << "i=" << i;
+  }
+}
@@ -0,0 +1,101 @@
+#include <aslam/calibration/algo/ImuPreintegration.h>
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+using namespace aslam::calibration;
+
+TEST(ImuPreintegration, testSO3Jacobians) {
+  for(double scale : {1e-7, 1e-2, 1.0, 3.0}){
+    const Eigen::Vector3d phi = Eigen::Vector3d(0.3, -0.5, 0.8).normalized() * scale;
+    EXPECT_TRUE(logSO3(expSO3(phi)).isApprox(phi, 1e-6)) << "scale=" << scale;
+
+    const Eigen::Vector3d d = Eigen::Vector3d(-0.2, 0.1, 0.4) * 1e-6;
+    const Eigen::Matrix3d Jr = rightJacobianSO3(phi);
+    EXPECT_TRUE(expSO3(phi + d).isApprox(expSO3(phi) * expSO3(Jr * d), 1e-11)) << "scale=" << scale;
+    EXPECT_TRUE((inverseRightJacobianSO3(phi) * Jr).isApprox(Eigen::Matrix3d::Identity(), 1e-9)) << "scale=" << scale;
+  }
+}
+
+TEST(ImuPreintegration, testConstantMotion) {
+  const double dt = 0.01;
+  const int n = 50;
+  const Eigen::Vector3d acc(0.1, -0.3, 9.81), gyro(0, 0, 0.5);
+  ImuPreintegration pi(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  for(int i = 0; i < n; i++){
+    pi.integrate(acc, gyro, dt, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Identity());
+  }
+  const double T = n * dt;
+  EXPECT_DOUBLE_EQ(T, pi.getDeltaT());
+  EXPECT_EQ(n, pi.getNumSamples());
+  EXPECT_TRUE(pi.getDeltaR().isApprox(expSO3(gyro * T), 1e-12));
+
+  ImuPreintegration straight(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  for(int i = 0; i < n; i++){
+    straight.integrate(acc, Eigen::Vector3d::Zero(), dt, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Zero());
+  }
+  EXPECT_TRUE(straight.getDeltaV().isApprox(acc * T, 1e-12));
+  EXPECT_TRUE(straight.getDeltaP().isApprox(0.5 * acc * T * T, 1e-12));
+  // Without rotation and gyroscope noise the velocity noise is the sum of the per sample noise.
+  EXPECT_TRUE((straight.getCovariance().block<3, 3>(3, 3)).isApprox(Eigen::Matrix3d::Identity() * n * dt * dt, 1e-12));
+
+  const auto & cov = pi.getCovariance();
+  EXPECT_TRUE(cov.isApprox(cov.transpose()));
+  EXPECT_GT(Eigen::SelfAdjointEigenSolver<ImuPreintegration::Covariance>(cov).eigenvalues().minCoeff(), 0);
+}
+
+TEST(ImuPreintegration, testBiasCorrection) {
+  const double dt = 0.005;
+  std::vector<Eigen::Vector3d> accs, gyros;
+  for(int i = 0; i < 100; i++){
+    const double t = i * dt;
+    accs.emplace_back(std::sin(t), std::cos(3 * t), 9.81 + t);
+    gyros.emplace_back(0.3 * std::cos(t), -0.2, std::sin(2 * t));
+  }
+  auto integrate = [&](const Eigen::Vector3d & ba, const Eigen::Vector3d & bg){
+    ImuPreintegration pi(ba, bg);
+    for(size_t i = 0; i < accs.size(); i++){
+      pi.integrate(accs[i], gyros[i], dt, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Identity());
+    }
+    return pi;
+  };
+
+  const Eigen::Vector3d ba(0.1, 0.2, -0.1), bg(0.01, -0.02, 0.03);
+  const ImuPreintegration linearized = integrate(ba, bg);
+
+  for(double scale : {1e-3, 1e-2}){
+    const Eigen::Vector3d ba2 = ba + Eigen::Vector3d(1, -2, 0.5) * scale, bg2 = bg + Eigen::Vector3d(-0.5, 1, 2) * scale * 0.1;
+    const ImuPreintegration reintegrated = integrate(ba2, bg2);
+    const double tolerance = 10 * scale * scale;
+    EXPECT_LT(logSO3(reintegrated.getDeltaR().transpose() * linearized.getDeltaR(bg2)).norm(), tolerance) << "scale=" << scale;
+    EXPECT_LT((reintegrated.getDeltaV() - linearized.getDeltaV(ba2, bg2)).norm(), tolerance) << "scale=" << scale;
+    EXPECT_LT((reintegrated.getDeltaP() - linearized.getDeltaP(ba2, bg2)).norm(), tolerance) << "scale=" << scale;
+    // The first order correction must be much better than none.
+    EXPECT_LT((reintegrated.getDeltaV() - linearized.getDeltaV(ba2, bg2)).norm(), 0.1 * (reintegrated.getDeltaV() - linearized.getDeltaV()).norm()) << "scale=" << scale;
+  }
+}
+
+TEST(ImuPreintegration, testMidpointRuleOnCircle) {
+  // Unit circle with angular velocity 1 and the body's x axis pointing outwards. There is no gravity.
+  auto R = [](double t){ return expSO3(Eigen::Vector3d(0, 0, t)); };
+  auto p = [](double t){ return Eigen::Vector3d(std::cos(t), std::sin(t), 0); };
+  auto v = [](double t){ return Eigen::Vector3d(-std::sin(t), std::cos(t), 0); };
+  auto acc = [&](double t){ return Eigen::Vector3d(R(t).transpose() * -p(t)); };
+  const Eigen::Vector3d gyro = Eigen::Vector3d::UnitZ();
+
+  const double dt = 0.01, T = 0.1, t0 = 0.3;
+  ImuPreintegration held(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero()), midpoint(Eigen::Vector3d::Zero(), Eigen::Vector3d::Zero());
+  for(int i = 0; i < 10; i++){
+    const double t = t0 + i * dt;
+    held.integrate(acc(t), gyro, dt, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Identity());
+    midpoint.integrate(acc(t), gyro, acc(t + dt), gyro, dt, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Identity());
+  }
+  const Eigen::Vector3d dv = R(t0).transpose() * (v(t0 + T) - v(t0)), dp = R(t0).transpose() * (p(t0 + T) - p(t0) - v(t0) * T);
+  EXPECT_TRUE(midpoint.getDeltaR().isApprox(R(t0).transpose() * R(t0 + T), 1e-12));
+  EXPECT_LT((midpoint.getDeltaV() - dv).norm(), 1e-5);
+  EXPECT_LT((midpoint.getDeltaP() - dp).norm(), 1e-6);
+  EXPECT_LT(10 * (midpoint.getDeltaV() - dv).norm(), (held.getDeltaV() - dv).norm());
+  EXPECT_LT(10 * (midpoint.getDeltaP() - dp).norm(), (held.getDeltaP() - dp).norm());
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <Eigen/Geometry>
+
+#include <aslam/calibration/algo/KnotPlacement.h>
+
+using namespace aslam::calibration;
+
+namespace {
+Eigen::Vector4d toVector(const Eigen::Quaterniond & q){
+  return Eigen::Vector4d(q.x(), q.y(), q.z(), q.w());
+}
+
+/// A circle with angular frequency omega, turning along (tangential yaw) for duration seconds sampled at 100Hz.
+void sampleCircle(double omega, double duration, std::vector<sm::timing::NsecTime> & timestamps, std::vector<Eigen::Vector3d> & transPoses, std::vector<Eigen::Vector4d> & rotPoses){
+  for(int i = 0; i * 0.01 <= duration; i++){
+    const double t = i * 0.01;
+    timestamps.push_back(sm::timing::NsecTime(i) * 10000000);
+    transPoses.emplace_back(std::cos(omega * t), std::sin(omega * t), 0);
+    rotPoses.push_back(toVector(Eigen::Quaterniond(Eigen::AngleAxisd(omega * t, Eigen::Vector3d::UnitZ()))));
+  }
+}
+}
+
+TEST(KnotPlacement, staticMotionNeedsMinimalKnots) {
+  std::vector<sm::timing::NsecTime> timestamps;
+  std::vector<Eigen::Vector3d> transPoses;
+  std::vector<Eigen::Vector4d> rotPoses;
+  sampleCircle(0, 10, timestamps, transPoses, rotPoses);
+  AdaptiveKnotOptions options;
+  options.minKnotsPerSecond = 2;
+  EXPECT_DOUBLE_EQ(2, computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options));
+}
+
+TEST(KnotPlacement, circleNeedsTheExpectedKnots) {
+  std::vector<sm::timing::NsecTime> timestamps;
+  std::vector<Eigen::Vector3d> transPoses;
+  std::vector<Eigen::Vector4d> rotPoses;
+  const double omega = 2;
+  sampleCircle(omega, 10, timestamps, transPoses, rotPoses);
+  AdaptiveKnotOptions options;
+  options.positionTolerance = 1e-3;
+  options.rotationTolerance = 1;
+  // |a| = omega^2 on a unit circle
+  EXPECT_NEAR(std::sqrt(omega * omega / (8 * options.positionTolerance)), computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options), 1e-2);
+
+  // The faster circle needs more knots.
+  std::vector<sm::timing::NsecTime> timestampsFast;
+  std::vector<Eigen::Vector3d> transPosesFast;
+  std::vector<Eigen::Vector4d> rotPosesFast;
+  sampleCircle(2 * omega, 10, timestampsFast, transPosesFast, rotPosesFast);
+  EXPECT_NEAR(2 * computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options), computeRequiredKnotsPerSecond(timestampsFast, transPosesFast, rotPosesFast, options), 1e-1);
+}
+
+TEST(KnotPlacement, smoothingDampsSingleSpikes) {
+  std::vector<sm::timing::NsecTime> timestamps;
+  std::vector<Eigen::Vector3d> transPoses;
+  std::vector<Eigen::Vector4d> rotPoses;
+  sampleCircle(0, 10, timestamps, transPoses, rotPoses);
+  transPoses[500] += 1e-3 * Eigen::Vector3d::UnitX();
+  AdaptiveKnotOptions options;
+  options.smoothingDuration = 0;
+  const double unsmoothed = computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options);
+  options.smoothingDuration = 1;
+  const double smoothed = computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options);
+  EXPECT_LT(smoothed, unsmoothed / 5);
+  EXPECT_GT(smoothed, options.minKnotsPerSecond); // The spike is damped but not ignored.
+}
+
+TEST(KnotPlacement, aggressiveManeuversGetDenseKnots) {
+  // Slow for 5s, then 1s ten times as fast, then slow again for 4s.
+  std::vector<sm::timing::NsecTime> timestamps;
+  std::vector<Eigen::Vector3d> transPoses;
+  std::vector<Eigen::Vector4d> rotPoses;
+  double angle = 0;
+  for(int i = 0; i <= 1000; i++){
+    const double t = i * 0.01;
+    angle += (t >= 5 && t < 6 ? 10 : 1) * 0.01;
+    timestamps.push_back(sm::timing::NsecTime(i) * 10000000);
+    transPoses.emplace_back(std::cos(angle), std::sin(angle), 0);
+    rotPoses.push_back(toVector(Eigen::Quaterniond::Identity()));
+  }
+  AdaptiveKnotOptions options;
+  options.positionTolerance = 1e-3;
+  options.smoothingDuration = 0.1;
+
+  // The uniform rate must satisfy the maneuver (and the velocity jumps around it), even though it only takes a tenth of the time.
+  const double slowRate = std::sqrt(1 / (8 * options.positionTolerance)), fastRate = std::sqrt(100 / (8 * options.positionTolerance));
+  EXPECT_LE(fastRate, computeRequiredKnotsPerSecond(timestamps, transPoses, rotPoses, options));
+
+  const std::vector<double> rates = computeLocalKnotsPerSecond(timestamps, transPoses, rotPoses, options);
+  ASSERT_EQ(timestamps.size(), rates.size());
+  EXPECT_NEAR(slowRate, rates[200], 1e-2 * slowRate);
+  EXPECT_NEAR(fastRate, rates[550], 1e-2 * fastRate);
+
+  const std::vector<sm::timing::NsecTime> knots = placeKnots(timestamps, rates);
+  ASSERT_GE(knots.size(), 2u);
+  EXPECT_EQ(timestamps.front(), knots.front());
+  EXPECT_EQ(timestamps.back(), knots.back());
+  // About slowRate * 9s + fastRate * 1s segments plus some for the velocity jumps, far fewer than a uniform spline with fastRate needs.
+  const double expectedSegments = slowRate * 9 + fastRate;
+  EXPECT_NEAR(expectedSegments, knots.size() - 1, 0.1 * expectedSegments);
+  EXPECT_LT(knots.size() - 1, fastRate * 10 / 2);
+
+  int numSlow = 0, numFast = 0;
+  for(size_t i = 1; i < knots.size(); i++){
+    ASSERT_LT(knots[i - 1], knots[i]);
+    const double spacing = (knots[i] - knots[i - 1]) * 1e-9, center = (knots[i] + knots[i - 1]) * 0.5e-9;
+    if(center > 1 && center < 4){
+      EXPECT_NEAR(1 / slowRate, spacing, 0.05 / slowRate);
+      numSlow++;
+    } else if(center > 5.2 && center < 5.8){
+      EXPECT_NEAR(1 / fastRate, spacing, 0.05 / fastRate);
+      numFast++;
+    }
+  }
+  EXPECT_GT(numSlow, 0);
+  EXPECT_GT(numFast, 0);
+
+  // A budget of half the segments keeps the relative density, i.e. the maneuver's knots are still ten times as dense.
+  const int budget = (knots.size() - 1) / 2;
+  const std::vector<sm::timing::NsecTime> budgetKnots = placeKnots(timestamps, rates, budget);
+  EXPECT_EQ(size_t(budget + 1), budgetKnots.size());
+  EXPECT_EQ(timestamps.front(), budgetKnots.front());
+  EXPECT_EQ(timestamps.back(), budgetKnots.back());
+  auto spacingAt = [&](double time){
+    const auto it = std::upper_bound(budgetKnots.begin(), budgetKnots.end(), sm::timing::NsecTime(time * 1e9));
+    return (*it - *(it - 1)) * 1e-9;
+  };
+  EXPECT_NEAR(fastRate / slowRate, spacingAt(2.5) / spacingAt(5.5), 0.1 * fastRate / slowRate);
+}
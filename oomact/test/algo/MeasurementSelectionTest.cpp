@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <Eigen/Dense>
+#include <gtest/gtest.h>
+
+#include <aslam/calibration/algo/MeasurementSelection.h>
+
+using namespace aslam::calibration;
+
+TEST(MeasurementSelection, keepsEverythingWithinBudget) {
+  std::vector<Eigen::MatrixXd> jacobians(3, Eigen::MatrixXd::Identity(2, 2));
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2}), selectMostInformative(jacobians, {1, 1, 1}, 3));
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2}), selectMostInformative(jacobians, {1, 1, 1}, 5));
+  EXPECT_TRUE(selectMostInformative(jacobians, {1, 1, 1}, 0).empty());
+}
+
+TEST(MeasurementSelection, prefersComplementaryInformation) {
+  // Many candidates observe only the first parameter. Few observe the second.
+  std::vector<Eigen::MatrixXd> jacobians;
+  for(int i = 0; i < 10; i++){
+    jacobians.push_back((Eigen::MatrixXd(1, 2) << 1, 0).finished());
+  }
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 0, 0.5).finished());
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 0, 0.4).finished());
+  const std::vector<double> weights(jacobians.size(), 1.);
+
+  const auto selected = selectMostInformative(jacobians, weights, 2);
+  ASSERT_EQ(2u, selected.size());
+  EXPECT_LT(selected[0], 10u);
+  EXPECT_EQ(10u, selected[1]);
+
+  // Weights scale the information.
+  std::vector<double> weighted = weights;
+  weighted[11] = 10;
+  EXPECT_EQ(11u, selectMostInformative(jacobians, weighted, 2)[1]);
+}
+
+TEST(MeasurementSelection, lazyGreedyMatchesGreedy) {
+  const int dim = 4, n = 60;
+  std::vector<Eigen::MatrixXd> jacobians;
+  std::vector<double> weights;
+  for(int i = 0; i < n; i++){
+    jacobians.push_back(Eigen::MatrixXd::Random(3, dim));
+    weights.push_back(1 + i % 3);
+  }
+  const size_t budget = 10;
+
+  // plain greedy
+  Eigen::MatrixXd information = Eigen::MatrixXd::Identity(dim, dim) * 1e-9;
+  std::vector<size_t> expected;
+  std::vector<bool> taken(n, false);
+  for(size_t k = 0; k < budget; k++){
+    double best = -std::numeric_limits<double>::infinity();
+    int bestIndex = -1;
+    for(int i = 0; i < n; i++){
+      if(taken[i]) continue;
+      const double logDet = std::log((information + weights[i] * jacobians[i].transpose() * jacobians[i]).determinant());
+      if(logDet > best){
+        best = logDet;
+        bestIndex = i;
+      }
+    }
+    taken[bestIndex] = true;
+    expected.push_back(bestIndex);
+    information += weights[bestIndex] * jacobians[bestIndex].transpose() * jacobians[bestIndex];
+  }
+  std::sort(expected.begin(), expected.end());
+
+  EXPECT_EQ(expected, selectMostInformative(jacobians, weights, budget));
+}
+
+TEST(MeasurementSelection, evenlySpacedWithoutParameters) {
+  std::vector<Eigen::MatrixXd> jacobians(10, Eigen::MatrixXd(3, 0));
+  EXPECT_EQ(std::vector<size_t>({2, 7}), selectMostInformative(jacobians, std::vector<double>(10, 1.), 2));
+}
+
+TEST(MeasurementSelection, preselectedCountAgainstTheBudget) {
+  std::vector<Eigen::MatrixXd> jacobians;
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 1, 0).finished());
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 0, 0.5).finished());
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 0, 0.4).finished());
+  jacobians.push_back((Eigen::MatrixXd(1, 2) << 1, 0).finished());
+  const std::vector<double> weights(jacobians.size(), 1.);
+
+  // The preselected candidate 2 already observes the second parameter. Hence, the remaining budget goes to the first one.
+  const auto selected = selectMostInformative(jacobians, weights, 2, {2});
+  ASSERT_EQ(2u, selected.size());
+  EXPECT_EQ(2u, selected[1]);
+  EXPECT_TRUE(selected[0] == 0u || selected[0] == 3u);
+
+  EXPECT_EQ(std::vector<size_t>({1, 2}), selectMostInformative(jacobians, weights, 1, {2, 1}));
+  // Without parameters the rest is picked evenly spaced among the other candidates.
+  EXPECT_EQ(std::vector<size_t>({1, 2}), selectMostInformative(std::vector<Eigen::MatrixXd>(4, Eigen::MatrixXd(1, 0)), weights, 2, {2}));
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <Eigen/Dense>
+
+#include <aslam/calibration/algo/SchurComplementSolver.h>
+
+using namespace aslam::calibration;
+
+namespace {
+/// Builds a random least squares problem where every error term touches two neighboring state blocks and one calibration block.
+void fillArrowHeadProblem(SchurComplementSolver & solver, Eigen::MatrixXd & J, Eigen::VectorXd & e, int numSegments, int stateBlockDim, int calibDim) {
+  const int errorDim = 4;
+  const int dimState = numSegments * stateBlockDim;
+  J.setZero((numSegments - 1) * errorDim + calibDim, dimState + calibDim);
+  e.setRandom(J.rows());
+  int row = 0;
+  for(int i = 0; i + 1 < numSegments; i++){
+    const int calibCol = dimState + (i % 2) * (calibDim / 2);
+    SchurComplementSolver::JacobianBlocks blocks{
+      {i * stateBlockDim, Eigen::MatrixXd::Random(errorDim, 2 * stateBlockDim)},
+      {calibCol, Eigen::MatrixXd::Random(errorDim, calibDim / 2)}
+    };
+    for(auto & b : blocks){
+      J.block(row, b.first, errorDim, b.second.cols()) = b.second;
+    }
+    solver.addErrorTerm(blocks, e.segment(row, errorDim));
+    row += errorDim;
+  }
+  // A prior on the calibration variables.
+  J.bottomRightCorner(calibDim, calibDim).setIdentity();
+  solver.addErrorTerm({{dimState, Eigen::MatrixXd::Identity(calibDim, calibDim)}}, e.tail(calibDim));
+}
+}
+
+TEST(SchurComplementSolverTestSuite, testSolveMatchesDenseSolution) {
+  const int numSegments = 20, stateBlockDim = 3, calibDim = 6;
+  SchurComplementSolver solver(numSegments * stateBlockDim, calibDim);
+  Eigen::MatrixXd J;
+  Eigen::VectorXd e;
+  fillArrowHeadProblem(solver, J, e, numSegments, stateBlockDim, calibDim);
+
+  const Eigen::MatrixXd H = J.transpose() * J;
+  const Eigen::VectorXd b = - J.transpose() * e;
+  EXPECT_TRUE(b.isApprox(solver.getRhs()));
+
+  for(double lambda : {0.0, 1e-3, 10.0}){
+    Eigen::VectorXd dx;
+    ASSERT_TRUE(solver.solve(lambda, dx));
+    const Eigen::MatrixXd Hd = H + lambda * Eigen::MatrixXd::Identity(H.rows(), H.cols());
+    const Eigen::VectorXd expected = Hd.ldlt().solve(b);
+    EXPECT_TRUE(expected.isApprox(dx, 1e-8)) << "lambda=" << lambda << "\nexpected=" << expected.transpose() << "\nactual=" << dx.transpose();
+  }
+
+  Eigen::MatrixXd covariance;
+  ASSERT_TRUE(solver.computeCalibrationCovariance(covariance));
+  const Eigen::MatrixXd expectedCovariance = H.inverse().bottomRightCorner(calibDim, calibDim);
+  EXPECT_TRUE(expectedCovariance.isApprox(covariance, 1e-8)) << "expected=\n" << expectedCovariance << "\nactual=\n" << covariance;
+
+  solver.clear();
+  EXPECT_TRUE(solver.getRhs().isZero());
+}
+
+TEST(SchurComplementSolverTestSuite, testSolveWithoutCalibrationVariables) {
+  SchurComplementSolver solver(4, 0);
+  solver.addErrorTerm({{0, Eigen::MatrixXd::Identity(4, 4)}}, Eigen::Vector4d(1, 2, 3, 4));
+  Eigen::VectorXd dx;
+  ASSERT_TRUE(solver.solve(0, dx));
+  EXPECT_TRUE(Eigen::Vector4d(-1, -2, -3, -4).isApprox(dx));
+}
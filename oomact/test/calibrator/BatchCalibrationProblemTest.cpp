@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <sm/value_store/ValueStore.hpp>
+
+#include <aslam/calibration/calibrator/BatchCalibrationProblem.h>
+#include <aslam/calibration/model/fragments/PoseCv.h>
+
+using namespace aslam::backend;
+using namespace aslam::calibration;
+
+TEST(BatchCalibrationProblemTestSuite, timeSortedOrdering) {
+  EuclideanPoint s0(Eigen::Vector3d::Zero()), s1(Eigen::Vector3d::Zero()), s2(Eigen::Vector3d::Zero()), untimed(Eigen::Vector3d::Zero());
+  EuclideanPointCv cv("cv", sm::value_store::ValueStoreRef::fromString("x=0,y=0,z=0"));
+
+  BatchCalibrationProblem problem(true);
+  problem.addCalibrationVariable(&cv);
+  problem.addStateVariable(&s2, 2.0);
+  problem.addStateVariable(&untimed);
+  problem.addStateVariable(&s0, 0.0);
+  problem.addStateVariable(&s1, 1.0);
+  EXPECT_EQ(0u, problem.getProblemSp()->numDesignVariables());
+
+  problem.arrangeDesignVariables();
+
+  const std::vector<DesignVariable*> expected = {&s0, &s1, &s2, &untimed, &static_cast<CalibrationVariable &>(cv).getDesignVariable()};
+  EXPECT_EQ(std::vector<DesignVariable*>(expected.begin(), expected.end() - 1), problem.getStateDesignVariables());
+  ASSERT_EQ(expected.size(), problem.getProblemSp()->numDesignVariables());
+  for(size_t i = 0; i < expected.size(); i++){
+    EXPECT_EQ(expected[i], problem.getProblemSp()->designVariable(i)) << i;
+  }
+
+  // Error terms, such as calibration priors, are accepted after the arrangement.
+  problem.addErrorTerm(cv.createPriorErrorTerm());
+  EXPECT_EQ(1u, problem.getNumErrorTerms());
+
+  // The prior only connects to the calibration variable.
+  const auto bandwidths = problem.getStateBandwidths();
+  EXPECT_EQ(0u, bandwidths.first);
+  EXPECT_EQ(0u, bandwidths.second);
+}
+
+TEST(BatchCalibrationProblemTestSuite, insertionOrdering) {
+  EuclideanPoint s0(Eigen::Vector3d::Zero()), s1(Eigen::Vector3d::Zero());
+  EuclideanPointCv cv("cv", sm::value_store::ValueStoreRef::fromString("x=0,y=0,z=0"));
+
+  BatchCalibrationProblem problem;
+  problem.addCalibrationVariable(&cv);
+  problem.addStateVariable(&s1, 1.0);
+  problem.addStateVariable(&s0, 0.0);
+  problem.arrangeDesignVariables();
+
+  const std::vector<DesignVariable*> expected = {&static_cast<CalibrationVariable &>(cv).getDesignVariable(), &s1, &s0};
+  ASSERT_EQ(expected.size(), problem.getProblemSp()->numDesignVariables());
+  for(size_t i = 0; i < expected.size(); i++){
+    EXPECT_EQ(expected[i], problem.getProblemSp()->designVariable(i)) << i;
+  }
+}
@@ -0,0 +1,50 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aslam/backend/test/ErrorTermTester.hpp>
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/backend/RotationQuaternion.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
+
+#include "aslam/calibration/error-terms/BlockedMeasurementErrorTerm.h"
+#include "aslam/calibration/error-terms/ErrorTermAccelerometer.h"
+
+using namespace aslam::backend;
+using namespace aslam::calibration;
+
+TEST(AslamCalibrationTestSuite, testBlockedMeasurementErrorTerm) {
+  RotationQuaternion q_i_m(sm::kinematics::quatRandom());
+  EuclideanPoint bias(Eigen::Vector3d::Random());
+  EuclideanPoint gravity(Eigen::Vector3d::Random());
+
+  std::vector<EuclideanPoint> accelerations;
+  accelerations.reserve(4);
+  for (int i = 0; i < 4; i++) {
+    accelerations.emplace_back(Eigen::Vector3d::Random());
+  }
+
+  typedef BlockedMeasurementErrorTerm<3, EuclideanExpression> Block;
+  Block::Samples samples;
+  double sumOfSquaredErrors = 0;
+  for (auto & a : accelerations) {
+    Eigen::Matrix3d cov = Eigen::Matrix3d::Random();
+    cov = cov * cov.transpose() + Eigen::Matrix3d::Identity();
+    ErrorTermAccelerometer single(a.toExpression(), q_i_m.toExpression(), gravity.toExpression(), bias.toExpression(), Eigen::Vector3d::Random(), cov);
+    sumOfSquaredErrors += single.evaluateError();
+    samples.push_back({single.getPredictionExpression(), single.getMeasurement(), single.getCovariance()});
+  }
+
+  Block block(samples);
+  EXPECT_EQ(12u, block.dimension());
+  EXPECT_EQ(4u, block.getNumSamples());
+  EXPECT_EQ(accelerations.size() + 3, block.numDesignVariables());
+  EXPECT_NEAR(sumOfSquaredErrors, block.evaluateError(), 1e-9 * sumOfSquaredErrors);
+
+  try {
+    testErrorTerm(block, 1e-5);
+  }
+  catch (const std::exception& e) {
+    FAIL() << e.what();
+  }
+}
@@ -0,0 +1,105 @@
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+#include <aslam/backend/RotationQuaternion.hpp>
+#include <aslam/backend/Scalar.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
+
+#include "aslam/calibration/error-terms/ErrorTermAccelerometer.h"
+#include "aslam/calibration/error-terms/ErrorTermAngularVelocity.h"
+#include "aslam/calibration/error-terms/ErrorTermGyroscope.h"
+#include "aslam/calibration/error-terms/ErrorTermLinearVelocity.h"
+#include "aslam/calibration/error-terms/ErrorTermPose.h"
+#include "aslam/calibration/error-terms/ErrorTermPosition.h"
+#include "aslam/calibration/error-terms/ErrorTermTangency.h"
+#include "aslam/calibration/error-terms/ErrorTermWheel.h"
+#include "aslam/calibration/error-terms/ErrorTermWheelPair.h"
+#include "aslam/calibration/error-terms/ErrorTermWheelsZ.h"
+#include "aslam/calibration/tools/ThreadPool.h"
+
+using namespace aslam::backend;
+using namespace aslam::calibration;
+
+namespace {
+
+struct Evaluation {
+  double squaredError;
+  Eigen::VectorXd error;
+  std::map<const DesignVariable*, Eigen::MatrixXd> jacobians;
+
+  bool operator == (const Evaluation & other) const {
+    if(squaredError != other.squaredError || error.size() != other.error.size() || error != other.error || jacobians.size() != other.jacobians.size()){
+      return false;
+    }
+    for(auto & j : jacobians){
+      auto o = other.jacobians.find(j.first);
+      if(o == other.jacobians.end() || o->second.rows() != j.second.rows() || o->second.cols() != j.second.cols() || o->second != j.second){
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+Evaluation evaluate(ErrorTerm & e){
+  Evaluation r;
+  r.squaredError = e.evaluateError();
+  e.getWeightedError(r.error, false);
+  JacobianContainer jc(e.dimension());
+  e.getWeightedJacobians(jc, false);
+  for(auto it = jc.begin(); it != jc.end(); ++it){
+    r.jacobians[it->first] = it->second;
+  }
+  return r;
+}
+
+}
+
+TEST(AslamCalibrationTestSuite, testErrorTermsConcurrentEvaluationIsDeterministic) {
+  // Shared design variables, as in a real problem.
+  RotationQuaternion q(sm::kinematics::quatRandom());
+  EuclideanPoint t(Eigen::Vector3d::Random()), v(Eigen::Vector3d::Random()), w(Eigen::Vector3d::Random()), a(Eigen::Vector3d::Random());
+  EuclideanPoint g(Eigen::Vector3d::Random()), accBias(Eigen::Vector3d::Random()), gyroBias(Eigen::Vector3d::Random());
+  Scalar L(0.6), R_l(0.2), R_r(0.21);
+
+  const Eigen::Matrix3d cov3 = Eigen::Matrix3d::Identity() * 0.5;
+  const Eigen::Matrix<double, 1, 1> cov1 = Eigen::Matrix<double, 1, 1>::Constant(0.3);
+
+  std::vector<boost::shared_ptr<ErrorTerm>> errorTerms;
+  for(int i = 0; i < 50; i++){
+    TransformationExpression T(q.toExpression(), t.toExpression());
+    errorTerms.emplace_back(new ErrorTermPose(T, Eigen::Vector3d::Random(), sm::kinematics::quatRandom(), Eigen::Matrix<double, 6, 6>::Identity(), ErrorTermGroupReference()));
+    errorTerms.emplace_back(new ErrorTermPosition(t.toExpression(), Eigen::Vector3d::Random(), cov3, ErrorTermGroupReference()));
+    errorTerms.emplace_back(new ErrorTermAccelerometer(a.toExpression(), q.toExpression(), g.toExpression(), accBias.toExpression(), Eigen::Vector3d::Random(), cov3));
+    errorTerms.emplace_back(new ErrorTermGyroscope(w.toExpression(), gyroBias.toExpression(), Eigen::Vector3d::Random(), cov3));
+    errorTerms.emplace_back(new ErrorTermWheel(v.toExpression(), R_l.toExpression(), i * 0.1, 0.4));
+    errorTerms.emplace_back(new ErrorTermWheelPair(v.toExpression(), w.toExpression(), L.toExpression(), R_l.toExpression(), R_r.toExpression(), Eigen::Vector2d::Random(), Eigen::Vector2d(0.4, 0.5)));
+    errorTerms.emplace_back(new ErrorTermWheelsZ(v.toExpression(), q.toExpression() * v.toExpression(), cov1));
+    errorTerms.emplace_back(new ErrorTermTangency(v.toExpression().cross(EuclideanExpression(Eigen::Vector3d::UnitX())), cov3, ErrorTermGroupReference()));
+    errorTerms.emplace_back(new ErrorTermLinearVelocity(v.toExpression(), q.toExpression() * v.toExpression(), cov3));
+    errorTerms.emplace_back(new ErrorTermAngularVelocity(w.toExpression(), q.toExpression() * w.toExpression(), cov1));
+  }
+
+  std::vector<Evaluation> expected;
+  for(auto & e : errorTerms){
+    expected.push_back(evaluate(*e));
+  }
+
+  ThreadPool pool(4);
+  for(int round = 0; round < 20; round++){
+    std::vector<Evaluation> actual(errorTerms.size());
+    // Odd rounds evaluate in reverse order to vary which terms run side by side.
+    pool.parallelFor(0, errorTerms.size(), [&](size_t i){
+      const size_t k = round % 2 ? errorTerms.size() - 1 - i : i;
+      actual[k] = evaluate(*errorTerms[k]);
+    }, 1);
+    for(size_t i = 0; i < errorTerms.size(); i++){
+      EXPECT_TRUE(expected[i] == actual[i]) << "error term " << i << " differs in round " << round;
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+
+#include <sm/kinematics/quaternion_algebra.hpp>
+
+#include <aslam/backend/test/ErrorTermTestHarness.hpp>
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/backend/RotationQuaternion.hpp>
+
+#include "aslam/calibration/error-terms/ErrorTermImuPreintegration.h"
+
+using namespace aslam::backend;
+using namespace aslam::calibration;
+
+TEST(AslamCalibrationTestSuite, testErrorTermImuPreintegration) {
+  ImuPreintegration preintegration(Eigen::Vector3d::Random() * 0.1, Eigen::Vector3d::Random() * 0.1);
+  for(int i = 0; i < 20; i++){
+    preintegration.integrate(Eigen::Vector3d::Random() + Eigen::Vector3d::UnitZ() * 9.81, Eigen::Vector3d::Random(), 0.01, Eigen::Matrix3d::Identity(), Eigen::Matrix3d::Identity());
+  }
+
+  RotationQuaternion q_m_i(sm::kinematics::quatRandom()), q_m_j(sm::kinematics::quatRandom());
+  EuclideanPoint p_i(Eigen::Vector3d::Random()), p_j(Eigen::Vector3d::Random());
+  EuclideanPoint v_i(Eigen::Vector3d::Random()), v_j(Eigen::Vector3d::Random());
+  EuclideanPoint gravity(Eigen::Vector3d::Random());
+  EuclideanPoint accBias(Eigen::Vector3d::Random() * 0.2), gyroBias(Eigen::Vector3d::Random() * 0.2);
+
+  ErrorTermImuPreintegration err(
+      {q_m_i.toExpression(), p_i.toExpression(), v_i.toExpression()},
+      {q_m_j.toExpression(), p_j.toExpression(), v_j.toExpression()},
+      gravity.toExpression(), accBias.toExpression(), gyroBias.toExpression(), preintegration);
+
+  try {
+    ErrorTermTestHarness<9> harness(&err);
+    harness.testAll(1e-5);
+  }
+  catch (const std::exception& e) {
+    FAIL() << e.what();
+  }
+}
@@ -1,3 +1,5 @@
+#include <map>
+
 #include <gtest/gtest.h>
 
 #include <sm/kinematics/EulerAnglesYawPitchRoll.hpp>
@@ -6,6 +8,7 @@
 
 #include <aslam/backend/test/ErrorTermTester.hpp>
 #include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
 #include <aslam/backend/RotationQuaternion.hpp>
 #include <aslam/backend/TransformationExpression.hpp>
 
@@ -47,3 +50,31 @@ TEST(AslamCalibrationTestSuite, testErrorTermPose) {
     FAIL() << e.what();
   }
 }
+
+namespace {
+std::map<DesignVariable*, Eigen::MatrixXd> getJacobians(ErrorTerm & e){
+  JacobianContainer jc(e.dimension());
+  e.getWeightedJacobians(jc, false);
+  std::map<DesignVariable*, Eigen::MatrixXd> jacobians;
+  for(auto it = jc.begin(); it != jc.end(); ++it){
+    jacobians[it->first] = it->second;
+  }
+  return jacobians;
+}
+}
+
+TEST(AslamCalibrationTestSuite, testErrorTermPoseJacobiansAtLastErrorEvaluation) {
+  EuclideanPoint t(Eigen::Vector3d::Random());
+  RotationQuaternion q(quatRandom());
+  ErrorTermPose e(TransformationExpression(q.toExpression(), t.toExpression()), Eigen::Vector3d::Random(), quatRandom(), Eigen::MatrixXd::Identity(6, 6), "TestET");
+
+  e.evaluateError();
+  const auto expected = getJacobians(e);
+
+  // The Jacobians refer to the last error evaluation's linearization point until the error gets evaluated again.
+  t.set(Eigen::Vector3d::Random());
+  EXPECT_TRUE(expected == getJacobians(e));
+
+  e.evaluateError();
+  EXPECT_FALSE(expected == getJacobians(e));
+}
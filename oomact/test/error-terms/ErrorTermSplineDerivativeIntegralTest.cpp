@@ -0,0 +1,95 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <aslam/backend/test/ErrorTermTester.hpp>
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/splines/OPTBSpline.hpp>
+#include <bsplines/EuclideanBSpline.hpp>
+#include <bsplines/NsecTimePolicy.hpp>
+
+#include "aslam/calibration/error-terms/ErrorTermSplineDerivativeIntegral.h"
+
+using namespace aslam::backend;
+using namespace aslam::calibration;
+
+TEST(AslamCalibrationTestSuite, testErrorTermSplineDerivativeIntegral) {
+  const int order = 4, derivative = 1;
+  const double segmentDuration = 0.3;
+  const Eigen::Matrix3d sqrtInvR = Eigen::Matrix3d::Random();
+
+  std::vector<EuclideanPoint> coefficients;
+  coefficients.reserve(order);
+  std::vector<DesignVariable*> dvs;
+  for (int i = 0; i < order; i++) {
+    coefficients.emplace_back(Eigen::Vector3d::Random());
+    dvs.push_back(&coefficients.back());
+  }
+
+  ErrorTermSplineDerivativeIntegral e(dvs, computeUniformBSplineGramMatrixSqrt(order, derivative), segmentDuration, derivative, sqrtInvR);
+  EXPECT_EQ(3u * (order - derivative), e.dimension());
+
+  const Eigen::MatrixXd G = computeUniformBSplineGramMatrix(order, derivative);
+  double expected = 0;
+  for (int i = 0; i < order; i++) {
+    for (int j = 0; j < order; j++) {
+      expected += G(i, j) * (sqrtInvR * coefficients[i].toEuclidean()).dot(sqrtInvR * coefficients[j].toEuclidean());
+    }
+  }
+  expected *= std::pow(segmentDuration, 1 - 2 * derivative);
+  EXPECT_NEAR(expected, e.evaluateError(), 1e-9 * expected);
+
+  try {
+    testErrorTerm(e, 1e-5);
+  }
+  catch (const std::exception& ex) {
+    FAIL() << ex.what();
+  }
+}
+
+namespace {
+struct ErrorTermCollector {
+  void addErrorTerm(boost::shared_ptr<ErrorTerm> e) {
+    errorTerms.push_back(e);
+  }
+  std::vector<boost::shared_ptr<ErrorTerm>> errorTerms;
+};
+}
+
+TEST(AslamCalibrationTestSuite, testSplineDerivativeIntegralErrorTermsOnSpline) {
+  typedef aslam::splines::OPTBSpline<bsplines::EuclideanBSpline<Eigen::Dynamic, 3, bsplines::NsecTimePolicy>::CONF>::BSpline Spline;
+  const int order = 4, derivative = 1, numSegments = 5;
+  // Not starting at 0 and a segment duration of 0.4s test the conversion from nanoseconds.
+  const sm::timing::NsecTime t0 = 1000000000, segmentDuration = 400000000;
+  const Eigen::Matrix3d sqrtInvR = Eigen::Matrix3d::Random();
+
+  Spline spline(order);
+  spline.initConstantUniformSpline(t0, t0 + numSegments * segmentDuration, numSegments, Eigen::Vector3d::Zero());
+  ASSERT_EQ(numSegments + order - 1, int(spline.numDesignVariables()));
+  for (size_t i = 0; i < spline.numDesignVariables(); i++) {
+    spline.designVariable(i)->setParameters(Eigen::Vector3d::Random());
+  }
+
+  ErrorTermCollector collector;
+  const double squaredError = addSplineDerivativeIntegralErrorTerms(collector, spline, derivative, sqrtInvR);
+  EXPECT_EQ(size_t(numSegments), collector.errorTerms.size());
+
+  // Simpson's rule with the segment boundaries on its nodes.
+  const int stepsPerSegment = 400;
+  const sm::timing::NsecTime h = segmentDuration / stepsPerSegment;
+  auto integrand = [&](sm::timing::NsecTime t) {
+    return (sqrtInvR * spline.getEvaluatorAt<derivative>(t).evalD(derivative)).squaredNorm();
+  };
+  double expected = 0;
+  for (int k = 0; k < numSegments * stepsPerSegment; k += 2) {
+    const sm::timing::NsecTime t = t0 + k * h;
+    expected += (integrand(t) + 4 * integrand(t + h) + integrand(t + 2 * h)) * sm::timing::nsecToSec(h) / 3;
+  }
+  EXPECT_NEAR(expected, squaredError, 1e-8 * expected);
+
+  double sum = 0;
+  for (auto & e : collector.errorTerms) {
+    sum += e->evaluateError();
+  }
+  EXPECT_NEAR(squaredError, sum, 1e-12 * squaredError);
+}
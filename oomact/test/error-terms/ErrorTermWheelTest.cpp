@@ -33,6 +33,7 @@
 #include <aslam/backend/ScalarExpression.hpp>
 
 #include "aslam/calibration/error-terms/ErrorTermWheel.h"
+#include "aslam/calibration/error-terms/ErrorTermWheelPair.h"
 
 using namespace aslam::backend;
 using namespace aslam::calibration;
@@ -64,3 +65,29 @@ TEST(AslamCalibrationTestSuite, testErrorTermWheel) {
   }
 
 }
+
+TEST(AslamCalibrationTestSuite, testErrorTermWheelPair) {
+  EuclideanPoint v(Eigen::Vector3d(1.5, 0.2, -0.1));
+  EuclideanPoint w(Eigen::Vector3d(0.1, -0.2, 0.8));
+  Scalar L(0.6), R_l(0.2), R_r(0.21);
+
+  const Eigen::Vector2d measurement(6.5, 8.2), variances(0.5, 0.7);
+  ErrorTermWheelPair e(v.toExpression(), w.toExpression(), L.toExpression(), R_l.toExpression(), R_r.toExpression(), measurement, variances);
+
+  // compare with two single wheel error terms
+  auto lHalf = L.toExpression() * 0.5;
+  ErrorTermWheel el(v.toExpression() + w.toExpression().cross(EuclideanExpression(Eigen::Vector3d(0.0, 1.0, 0.0)) * lHalf), R_l.toExpression(), measurement(0), variances(0));
+  ErrorTermWheel er(v.toExpression() + w.toExpression().cross(EuclideanExpression(Eigen::Vector3d(0.0, -1.0, 0.0)) * lHalf), R_r.toExpression(), measurement(1), variances(1));
+  const double expectedError = el.evaluateError() + er.evaluateError();
+  EXPECT_NEAR(expectedError, e.evaluateError(), 1e-12 * expectedError);
+  EXPECT_NEAR(el.error()(0), e.error()(0), 1e-12);
+  EXPECT_NEAR(er.error()(0), e.error()(1), 1e-12);
+
+  try {
+    ErrorTermTestHarness<2> harness(&e);
+    harness.testAll(1e-5);
+  }
+  catch (const std::exception& e) {
+    FAIL() << e.what();
+  }
+}
@@ -144,5 +144,7 @@ TEST(InputProviderSuite, testEasy) {
 
   c->calibrate();
   EXPECT_NEAR(5.0, mcSensorA.getTranslationToParent()[1], 0.0001);
-  EXPECT_NEAR(-5.0, traj.getCurrentTrajectory().getTranslationSpline().template getEvaluatorAt<0>(0).eval()[1], 0.1);
+  traj.getCurrentTrajectory().visitSplines([](const auto & /* rotationSpline */, const auto & translationSpline){
+    EXPECT_NEAR(-5.0, translationSpline.template getEvaluatorAt<0>(0).eval()[1], 0.1);
+  });
 }
@@ -101,3 +101,80 @@ TEST(FrameGraphModel, getTransformationAndGetDerivatives) {
                         SM_SOURCE_FILE_POS);
 
 }
+
+TEST(FrameGraphModel, constantLinksGetFolded) {
+  auto config = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "body{referenceFrame=world, rotation/used=false,translation/used=false,delay/used=false}"
+      "s1{referenceFrame=body, rotation{used=true,estimate=false,yaw=0.3,pitch=0.2,roll=0.1},translation{used=true,estimate=false,x=1,y=-2,z=3},delay/used=false}"
+    );
+  FrameGraphModel m(config);
+  Sensor s1(m, "s1", config);
+
+  Eigen::MatrixXd R_w_b(3, 3);
+  R_w_b << 0, -1, 0,  1, 0, 0,  0, 0, 1;
+  Eigen::Vector3d t_w_b(1, 2, 3);
+  MockFrameLink link(m, "body", config, {aslam::backend::RotationExpression(R_w_b), aslam::backend::EuclideanExpression(t_w_b)});
+  m.addModulesAndInit(link, s1);
+
+  const Frame & s1Frame = m.getFrame("s1");
+  const Frame & worldFrame = m.getFrame("world");
+
+  const auto T_w_s_expected = m.getAtTime(0.0, 2, {}).getTransformationToFrom(worldFrame, s1Frame).toTransformationMatrix();
+
+  s1.getRotationVariable().setActive(false);
+  s1.getTranslationVariable().setActive(false);
+  m.updateConstantLinks();
+  auto T_w_s = m.getAtTime(0.0, 2, {}).getTransformationToFrom(worldFrame, s1Frame);
+  sm::eigen::assertNear(T_w_s.toTransformationMatrix(), T_w_s_expected, 1e-9, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(T_w_s.toRotationExpression().toRotationMatrix(), R_w_b * s1.calcRotationToParentMatrix(), 1e-9, SM_SOURCE_FILE_POS);
+  aslam::backend::DesignVariable::set_t dvs;
+  T_w_s.getDesignVariables(dvs);
+  EXPECT_TRUE(dvs.empty());
+}
+
+TEST(FrameGraphModel, consecutiveConstantLinksGetFoldedWithCurrentValues) {
+  auto config = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "body{referenceFrame=world, rotation/used=false,translation/used=false,delay/used=false}"
+      "s1{referenceFrame=body, rotation{used=true,estimate=false,yaw=0.3,pitch=0.2,roll=0.1},translation{used=true,estimate=false,x=1,y=-2,z=3},delay/used=false}"
+      "s2{referenceFrame=s1, rotation{used=true,estimate=false,yaw=-0.1,pitch=0.4,roll=0.2},translation{used=true,estimate=false,x=-1,y=0.5,z=2},delay/used=false}"
+    );
+  FrameGraphModel m(config);
+  Sensor s1(m, "s1", config);
+  Sensor s2(m, "s2", config);
+
+  // The body link moves. Hence, only the two sensor links get folded (into one constant frame).
+  Eigen::MatrixXd R_w_b(3, 3);
+  R_w_b << 0, -1, 0,  1, 0, 0,  0, 0, 1;
+  Eigen::Vector3d t_w_b(1, 2, 3), omega_w_wb(0, 0, 1);
+  MockFrameLink link(m, "body", config, {aslam::backend::RotationExpression(R_w_b), aslam::backend::EuclideanExpression(t_w_b), aslam::backend::EuclideanExpression(omega_w_wb)});
+  m.addModulesAndInit(link, s1, s2);
+
+  const Frame & s2Frame = m.getFrame("s2");
+  const Frame & worldFrame = m.getFrame("world");
+  auto getT_w_s2 = [&](){
+    return m.getAtTime(0.0, 2, {}).getTransformationToFrom(worldFrame, s2Frame);
+  };
+
+  for(Sensor * s : {&s1, &s2}){
+    s->getRotationVariable().setActive(false);
+    s->getTranslationVariable().setActive(false);
+  }
+  EXPECT_EQ(0, m.getConstantLinkValues().size());
+  const auto T_w_s2_unfolded = getT_w_s2().toTransformationMatrix();
+  m.updateConstantLinks();
+  EXPECT_EQ(2 * 12, m.getConstantLinkValues().size());
+  auto T_w_s2 = getT_w_s2();
+  sm::eigen::assertNear(T_w_s2.toTransformationMatrix(), T_w_s2_unfolded, 1e-9, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(T_w_s2.toRotationExpression().toRotationMatrix(), R_w_b * s1.calcRotationToParentMatrix() * s2.calcRotationToParentMatrix(), 1e-9, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(m.getAtTime(0.0, 2, {}).getAngularVelocity(s2Frame, worldFrame).evaluate(), omega_w_wb, 1e-9, SM_SOURCE_FILE_POS);
+
+  // Changing an inactive variable's value (e.g. by loading it) must reach the folded links without another updateConstantLinks.
+  const Eigen::VectorXd valuesBefore = m.getConstantLinkValues();
+  s1.getTranslationVariable().setMinimalComponents(Eigen::Vector3d(4, 5, 6));
+  EXPECT_FALSE(valuesBefore.isApprox(m.getConstantLinkValues()));
+  sm::eigen::assertNear(getT_w_s2().toEuclideanExpression().evaluate(), t_w_b + R_w_b * (Eigen::Vector3d(4, 5, 6) + s1.calcRotationToParentMatrix() * s2.getTranslationToParent()), 1e-9, SM_SOURCE_FILE_POS);
+}
@@ -1,20 +1,33 @@
 #include <aslam/calibration/model/PoseTrajectory.h>
 
+#include <chrono>
 #include <exception>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
 
+#include <aslam/backend/ErrorTermReceiver.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+#include <aslam/backend/Vector2RotationQuaternionExpressionAdapter.hpp>
 #include <gtest/gtest.h>
 #include <sm/eigen/gtest.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
 #include <sm/value_store/ValueStore.hpp>
 #include <sm/source_file_pos.hpp>
 
 #include <aslam/calibration/calibrator/AbstractCalibrator.h>
 #include <aslam/calibration/calibrator/CalibratorI.h>
 #include <aslam/calibration/calibrator/SimpleModuleStorage.h>
+#include <aslam/calibration/model/CalibrationVariable.h>
 #include <aslam/calibration/model/FrameGraphModel.h>
+#include <aslam/calibration/model/fragments/So3R3Trajectory.h>
 #include <aslam/calibration/model/sensors/PoseSensor.h>
 #include <aslam/calibration/test/MockCalibrator.h>
 #include <aslam/calibration/test/MockMotionCaptureSource.h>
 #include <aslam/calibration/test/Tools.h>
+#include <aslam/calibration/tools/SplineWriter.h>
+#include <aslam/calibration/tools/UnitQuaternionRotationExpression.h>
 
 using sm::value_store::ValueStoreRef;
 
@@ -74,4 +87,421 @@ TEST(PoseTrajectory, frameLinkProperties)
   sm::eigen::assertNear(-t_w_b,
                         mAt.getAcceleration(bodyFrame, worldFrame).evaluate(),
                         1e-3, SM_SOURCE_FILE_POS);
+
+  So3R3TrajectorySamples samples;
+  traj.getCurrentTrajectory().sample({Timestamp(0.5).getNumerator(), midTime.getNumerator()}, samples);
+  ASSERT_EQ(2, samples.positions.cols());
+  sm::eigen::assertNear(R_w_b, sm::kinematics::quat2r(samples.orientations.col(1)), 1e-9, SM_SOURCE_FILE_POS);
+  // The translation gets sampled from its per segment Taylor expansion, which rounds differently than the spline's evaluator.
+  sm::eigen::assertNear(relKin.p.evaluate(), samples.positions.col(1), 1e-12, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(relKin.v.evaluate(), samples.velocities.col(1), 1e-10, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(relKin.a.evaluate(), samples.accelerations.col(1), 1e-8, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(relKin.omega.evaluate(), samples.angularVelocities.col(1), 1e-12, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(relKin.alpha.evaluate(), samples.angularAccelerations.col(1), 1e-12, SM_SOURCE_FILE_POS);
+  auto relKin0 = traj.calcRelativeKinematics(Timestamp(0.5), {}, 2);
+  sm::eigen::assertNear(relKin0.p.evaluate(), samples.positions.col(0), 1e-12, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(relKin0.omega.evaluate(), samples.angularVelocities.col(0), 1e-12, SM_SOURCE_FILE_POS);
+}
+
+TEST(PoseTrajectory, boundedTimeKinematicsMatchSamples)
+{
+  FrameGraphModel m(ValueStoreRef::fromString(
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "b{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay{used=true,lowerBound=-0.01,upperBound=0.01}}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001}}"
+    ));
+  PoseSensor psA(m, "a"), psB(m, "b");
+  PoseTrajectory traj(m, "traj");
+  m.addModulesAndInit(psA, psB, traj);
+
+  Timestamp endTime = 2 * M_PI;
+  MockCalibrator c(m, Interval{0.0, endTime});
+  for (auto& p : MmcsCircle.getPoses(endTime)) {
+    psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+  }
+  c.initStates();
+
+  auto & delay = static_cast<CalibrationVariable &>(psB.getDelayVariable()).getDesignVariable();
+  delay.setActive(true);
+
+  // The knots are 0.05s apart. Hence, the delay bounds let the time reach across the knot at 1s.
+  const Timestamp t = 1.004;
+  auto relKin = traj.calcRelativeKinematics(psB.getBoundedTimestampExpression(c, t), {}, 2);
+  for (const double d : {0.0, 0.008}) {
+    const double delta = d - static_cast<double>(psB.getDelay());
+    delay.update(&delta, 1);
+    So3R3TrajectorySamples samples;
+    traj.getCurrentTrajectory().sample({(t - psB.getDelay()).getNumerator()}, samples);
+    sm::eigen::assertNear(relKin.p.evaluate(), samples.positions.col(0), 1e-12, SM_SOURCE_FILE_POS);
+    sm::eigen::assertNear(relKin.v.evaluate(), samples.velocities.col(0), 1e-10, SM_SOURCE_FILE_POS);
+    sm::eigen::assertNear(relKin.a.evaluate(), samples.accelerations.col(0), 1e-8, SM_SOURCE_FILE_POS);
+
+    // The delay shifts the time backwards.
+    aslam::backend::JacobianContainer jc(3);
+    relKin.p.evaluateJacobians(jc);
+    bool hasDelayJacobian = false;
+    for(auto it = jc.begin(); it != jc.end(); ++it){
+      if(it->first == &delay){
+        sm::eigen::assertNear(-samples.velocities.col(0), Eigen::MatrixXd(it->second), 1e-9, SM_SOURCE_FILE_POS);
+        hasDelayJacobian = true;
+      }
+    }
+    EXPECT_TRUE(hasDelayJacobian);
+  }
+}
+
+std::map<const aslam::backend::DesignVariable*, Eigen::MatrixXd> getJacobians(const aslam::backend::RotationExpression & R){
+  aslam::backend::JacobianContainer jc(3);
+  R.evaluateJacobians(jc);
+  std::map<const aslam::backend::DesignVariable*, Eigen::MatrixXd> jacobians;
+  for(auto it = jc.begin(); it != jc.end(); ++it){
+    jacobians[it->first] = it->second;
+  }
+  return jacobians;
+}
+
+TEST(PoseTrajectory, directRotationExpressionMatchesAdapter)
+{
+  FrameGraphModel m(ValueStoreRef::fromString(
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001}}"
+    ));
+  PoseSensor psA(m, "a");
+  PoseTrajectory traj(m, "traj");
+  m.addModulesAndInit(psA, traj);
+
+  Timestamp endTime = 2 * M_PI;
+  MockCalibrator c(m, Interval{0.0, endTime});
+  for (auto& p : MmcsCircle.getPoses(endTime)) {
+    psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+  }
+  c.initStates();
+  EXPECT_TRUE(traj.isUsingDirectRotationExpression());
+  ASSERT_TRUE(dynamic_cast<const Order4So3R3Trajectory *>(&traj.getCurrentTrajectory())) << "order 4 splines should be of fixed order";
+
+  const auto & rotationSpline = dynamic_cast<const Order4So3R3Trajectory &>(traj.getCurrentTrajectory()).getRotationSpline();
+  const int numTimes = 100;
+  for(int i = 0; i < numTimes; i++){
+    const Timestamp t(2 * M_PI * i / numTimes);
+    const auto q = rotationSpline.getExpressionFactoryAt<0>(t).getValueExpression();
+    const auto direct = toUnitQuaternionRotationExpression(q);
+    const auto adapted = aslam::backend::Vector2RotationQuaternionExpressionAdapter::adapt(q);
+
+    sm::eigen::assertNear(adapted.toRotationMatrix(), direct.toRotationMatrix(), 1e-12, SM_SOURCE_FILE_POS);
+    const auto directJacobians = getJacobians(direct), adaptedJacobians = getJacobians(adapted);
+    ASSERT_EQ(adaptedJacobians.size(), directJacobians.size());
+    for(auto & p : adaptedJacobians){
+      ASSERT_EQ(1u, directJacobians.count(p.first));
+      sm::eigen::assertNear(p.second, directJacobians.at(p.first), 1e-9, SM_SOURCE_FILE_POS);
+    }
+  }
+
+  // Micro-benchmark: per evaluation cost of the rotation matrix and its Jacobians, recorded in the test's XML output.
+  auto benchmark = [&](const std::string & name, std::function<aslam::backend::RotationExpression(const aslam::backend::VectorExpression<4> &)> toRotation){
+    const int numRepetitions = 20;
+    const auto start = std::chrono::steady_clock::now();
+    Eigen::Matrix3d sum = Eigen::Matrix3d::Zero();
+    for(int r = 0; r < numRepetitions; r++){
+      for(int i = 0; i < numTimes; i++){
+        const auto R = toRotation(rotationSpline.getExpressionFactoryAt<0>(Timestamp(2 * M_PI * i / numTimes)).getValueExpression());
+        sum += R.toRotationMatrix();
+        aslam::backend::JacobianContainer jc(3);
+        R.evaluateJacobians(jc);
+      }
+    }
+    const double nsPerEvaluation = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / double(numRepetitions * numTimes);
+    ::testing::Test::RecordProperty(name + "NanosecondsPerEvaluation", std::to_string(int(nsPerEvaluation)));
+    return sum;
+  };
+  const Eigen::Matrix3d adaptedSum = benchmark("adapter", [](const aslam::backend::VectorExpression<4> & q){ return aslam::backend::Vector2RotationQuaternionExpressionAdapter::adapt(q); });
+  const Eigen::Matrix3d directSum = benchmark("direct", [](const aslam::backend::VectorExpression<4> & q){ return toUnitQuaternionRotationExpression(q); });
+  sm::eigen::assertNear(adaptedSum, directSum, 1e-9, SM_SOURCE_FILE_POS);
+}
+
+TEST(PoseTrajectory, adaptiveKnotsVersusUniformKnots)
+{
+  struct Result {
+    size_t numDesignVariables;
+    double maxPositionError;
+    double fitSeconds;
+    std::vector<sm::timing::NsecTime> segmentKnots;
+  };
+  // A circle with increasing speed. It is slow in the beginning and aggressive in the end.
+  MockMotionCaptureSource accelerating([](Timestamp now, MotionCaptureSource::PoseStamped & p){
+    const double deltaTime = now - MockMotionCaptureSource::StartTime;
+    const double angleRad = deltaTime * deltaTime / 2;
+    p.q = sm::kinematics::axisAngle2quat({0, 0, -(angleRad + M_PI / 2)});
+    p.p = Eigen::Vector3d::UnitX() * cos(angleRad) + Eigen::Vector3d::UnitY() * sin(angleRad);
+  });
+  const Timestamp endTime = 2 * M_PI;
+  auto fit = [&](const std::string & knotPlacement){
+    FrameGraphModel m(ValueStoreRef::fromString(
+        "frames=body:world,"
+        "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+        "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=50,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001,"
+        "knotPlacement=" + knotPlacement + ",adaptiveKnots{positionTolerance=0.001,rotationTolerance=0.001}}}"
+      ));
+    PoseSensor psA(m, "a");
+    PoseTrajectory traj(m, "traj");
+    m.addModulesAndInit(psA, traj);
+
+    MockCalibrator c(m, Interval{0.0, endTime});
+    for (auto& p : accelerating.getPoses(endTime)) {
+      psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+    }
+    const auto start = std::chrono::steady_clock::now();
+    c.initStates();
+
+    Result r;
+    r.fitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto & trajectory = traj.getCurrentTrajectory();
+    r.numDesignVariables = trajectory.numDesignVariables();
+    const auto knots = dynamic_cast<const Order4So3R3Trajectory &>(trajectory).getTranslationSpline().getKnotsVector();
+    r.segmentKnots.assign(knots.begin() + 3, knots.end() - 3);
+    r.maxPositionError = 0;
+    for (auto& p : accelerating.getPoses(endTime)) {
+      if(p.time > Timestamp(0.5) && p.time < endTime - Timestamp(0.5)){
+        So3R3TrajectorySamples samples;
+        trajectory.sample({p.time.getNumerator()}, samples);
+        r.maxPositionError = std::max(r.maxPositionError, (samples.positions.col(0) - p.p).norm());
+      }
+    }
+    ::testing::Test::RecordProperty(knotPlacement + "NumDesignVariables", std::to_string(r.numDesignVariables));
+    ::testing::Test::RecordProperty(knotPlacement + "MaxPositionErrorMicrometers", std::to_string(int(r.maxPositionError * 1e6)));
+    ::testing::Test::RecordProperty(knotPlacement + "FitMicroseconds", std::to_string(int(r.fitSeconds * 1e6)));
+    return r;
+  };
+
+  const Result uniform = fit("uniform"), adaptive = fit("adaptive");
+  // The solve time of every later batch grows with the number of spline design variables, which is what the adaptive knots save.
+  EXPECT_LT(adaptive.numDesignVariables, uniform.numDesignVariables);
+  // knotsPerSecond is the budget of segments for the whole batch.
+  EXPECT_LE(adaptive.segmentKnots.size() - 1, uniform.segmentKnots.size() - 1);
+  EXPECT_EQ(Timestamp(0.0).getNumerator(), adaptive.segmentKnots.front());
+  EXPECT_EQ(endTime.getNumerator(), adaptive.segmentKnots.back());
+  // The knots get dense where the motion is aggressive.
+  const sm::timing::NsecTime firstLength = adaptive.segmentKnots[1] - adaptive.segmentKnots[0], lastLength = adaptive.segmentKnots.back() - adaptive.segmentKnots[adaptive.segmentKnots.size() - 2];
+  EXPECT_GT(firstLength, 3 * lastLength);
+  EXPECT_LT(adaptive.maxPositionError, 1e-2);
+  EXPECT_LT(uniform.maxPositionError, 1e-2);
+}
+
+TEST(PoseTrajectory, fixedOrderSplinesForOrdersFourAndSix)
+{
+  for(int order : {4, 5, 6}){
+    FrameGraphModel m(ValueStoreRef::fromString(
+        "frames=body:world,"
+        "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+        "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=" + std::to_string(order) + ",rotFittingLambda=0.0001,transSplineOrder=" + std::to_string(order) + ",transFittingLambda=0.001}}"
+      ));
+    PoseSensor psA(m, "a");
+    PoseTrajectory traj(m, "traj");
+    m.addModulesAndInit(psA, traj);
+
+    Timestamp endTime = 2 * M_PI, midTime = M_PI;
+    MockCalibrator c(m, Interval{0.0, endTime});
+    for (auto& p : MmcsCircle.getPoses(endTime)) {
+      psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+    }
+    c.initStates();
+
+    const So3R3Trajectory & trajectory = traj.getCurrentTrajectory();
+    EXPECT_EQ(order == 4, dynamic_cast<const Order4So3R3Trajectory *>(&trajectory) != nullptr) << "order=" << order;
+    EXPECT_EQ(order == 6, dynamic_cast<const Order6So3R3Trajectory *>(&trajectory) != nullptr) << "order=" << order;
+    EXPECT_EQ(order == 5, dynamic_cast<const DynamicOrderSo3R3Trajectory *>(&trajectory) != nullptr) << "order=" << order;
+    trajectory.visitSplines([&](const auto & rotationSpline, const auto & translationSpline){
+      EXPECT_EQ(order, rotationSpline.getSplineOrder());
+      EXPECT_EQ(order, translationSpline.getSplineOrder());
+    });
+
+    auto relKin = traj.calcRelativeKinematics(midTime, {}, 2);
+    sm::eigen::assertNear(-Eigen::Vector3d::UnitX(), relKin.p.evaluate(), 1e-3, SM_SOURCE_FILE_POS);
+    sm::eigen::assertNear(Eigen::Vector3d::UnitZ(), relKin.omega.evaluate(), 1e-3, SM_SOURCE_FILE_POS);
+  }
+}
+
+TEST(PoseTrajectory, chunkedFittingMatchesGlobalFitting)
+{
+  auto fit = [](int numThreads, const std::string & fitting, So3R3TrajectorySamples & samples){
+    FrameGraphModel m(ValueStoreRef::fromString(
+        "numThreads=" + std::to_string(numThreads) + ","
+        "frames=body:world,"
+        "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+        "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001,"
+        "fitting{" + fitting + "}}}"
+      ));
+    PoseSensor psA(m, "a");
+    PoseTrajectory traj(m, "traj");
+    m.addModulesAndInit(psA, traj);
+
+    Timestamp endTime = 2 * M_PI;
+    MockCalibrator c(m, Interval{0.0, endTime});
+    for (auto& p : MmcsCircle.getPoses(endTime)) {
+      psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+    }
+    c.initStates();
+    traj.getCurrentTrajectory().sample(getSampleTimes(dynamic_cast<const Order4So3R3Trajectory &>(traj.getCurrentTrajectory()).getTranslationSpline(), 0.01), samples);
+  };
+
+  So3R3TrajectorySamples global, sequential, chunked;
+  fit(1, "chunkSegments=0", sequential);
+  fit(2, "chunkSegments=0", global);
+  fit(3, "chunkSegments=20,overlapSegments=8", chunked);
+
+  ASSERT_EQ(global.times, sequential.times);
+  ASSERT_EQ(global.times, chunked.times);
+  sm::eigen::assertNear(sequential.positions, global.positions, 1e-12, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(sequential.orientations, global.orientations, 1e-12, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(global.positions, chunked.positions, 1e-4, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(global.velocities, chunked.velocities, 1e-3, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(global.orientations, chunked.orientations, 1e-4, SM_SOURCE_FILE_POS);
+}
+
+TEST(PoseTrajectory, chunkedFittingBridgesDataGaps)
+{
+  // No measurements between 2s and 3.5s, which is longer than a chunk including its overlap.
+  const Timestamp gapStart = 2.0, gapEnd = 3.5;
+  auto fit = [&](const std::string & fitting, So3R3TrajectorySamples & samples){
+    FrameGraphModel m(ValueStoreRef::fromString(
+        "frames=body:world,"
+        "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+        "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001,"
+        "fitting{" + fitting + "}}}"
+      ));
+    PoseSensor psA(m, "a");
+    PoseTrajectory traj(m, "traj");
+    m.addModulesAndInit(psA, traj);
+
+    Timestamp endTime = 2 * M_PI;
+    MockCalibrator c(m, Interval{0.0, endTime});
+    for (auto& p : MmcsCircle.getPoses(endTime)) {
+      if(p.time < gapStart || p.time > gapEnd){
+        psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+      }
+    }
+    c.initStates();
+    traj.getCurrentTrajectory().sample(getSampleTimes(dynamic_cast<const Order4So3R3Trajectory &>(traj.getCurrentTrajectory()).getTranslationSpline(), 0.01), samples);
+  };
+
+  So3R3TrajectorySamples global, chunked;
+  fit("chunkSegments=0", global);
+  fit("chunkSegments=10,overlapSegments=4", chunked);
+
+  ASSERT_EQ(global.times, chunked.times);
+  sm::eigen::assertNear(global.positions, chunked.positions, 1e-2, SM_SOURCE_FILE_POS);
+  sm::eigen::assertNear(global.orientations, chunked.orientations, 1e-2, SM_SOURCE_FILE_POS);
+  // The chunks within the gap must not keep their initial control vertices (the first measurement at (1, 0, 0)).
+  for(size_t i = 0; i < chunked.times.size(); i++){
+    const double t = Timestamp::fromNumerator(chunked.times[i]);
+    if(t > double(gapStart) && t < double(gapEnd)){
+      EXPECT_LT((chunked.positions.col(i) - Eigen::Vector3d(cos(t), sin(t), 0)).norm(), 0.2) << "t=" << t;
+    }
+  }
+}
+
+TEST(PoseTrajectory, euclideanSamplingMatchesSplineEvaluators)
+{
+  FrameGraphModel m(ValueStoreRef::fromString(
+      "numThreads=3,"
+      "frames=body:world,"
+      "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001}}"
+    ));
+  PoseSensor psA(m, "a");
+  PoseTrajectory traj(m, "traj");
+  m.addModulesAndInit(psA, traj);
+
+  Timestamp endTime = 2 * M_PI;
+  MockCalibrator c(m, Interval{0.0, endTime});
+  for (auto& p : MmcsCircle.getPoses(endTime)) {
+    psA.addMeasurement(p.time, p.q, p.p, c.getCurrentStorage());
+  }
+  c.initStates();
+
+  const auto & translationSpline = dynamic_cast<const Order4So3R3Trajectory &>(traj.getCurrentTrajectory()).getTranslationSpline();
+  // Includes samples on knots and on both ends.
+  const auto times = getSampleTimes(translationSpline, 0.005);
+  std::vector<Eigen::MatrixXd> expected, sequential, parallel;
+  sampleSpline<2>(translationSpline, times, expected);
+  sampleEuclideanSpline<2>(translationSpline, times, sequential);
+  sampleEuclideanSpline<2>(translationSpline, times, parallel, c.getThreadPool());
+  for(int d = 0; d <= 2; d++){
+    sm::eigen::assertNear(expected[d], sequential[d], 1e-8, SM_SOURCE_FILE_POS);
+    EXPECT_EQ(sequential[d], parallel[d]) << "d=" << d;
+  }
+}
+
+TEST(PoseTrajectory, tangentialConstraintPerSegmentVersusSampled)
+{
+  class ErrorTermCollector : public aslam::backend::ErrorTermReceiver {
+   public:
+    void addErrorTerm(const boost::shared_ptr<aslam::backend::ErrorTerm> & et) override {
+      errorTerms.push_back(et);
+    }
+    std::vector<boost::shared_ptr<aslam::backend::ErrorTerm>> errorTerms;
+  };
+
+  struct Result {
+    size_t numErrorTerms;
+    size_t numSegments;
+    double cost;
+    double buildSeconds;
+    double evaluationSeconds;
+  };
+  // A long run of a robot driving in circles with its x-axis at a constant yaw of 0.3 to the velocity. The constraint's integrand is therefore constant.
+  const Timestamp endTime = 20 * M_PI;
+  const Eigen::Vector4d yawOffset = sm::kinematics::axisAngle2quat(Eigen::Vector3d(0, 0, 0.3));
+  auto run = [&](const std::string & name, const std::string & tangentialConstraint){
+    FrameGraphModel m(ValueStoreRef::fromString(
+        "frames=body:world,"
+        "a{referenceFrame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+        "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=20,rotSplineOrder=4,rotFittingLambda=0.0001,transSplineOrder=4,transFittingLambda=0.001},"
+        "tangentialConstraint{used=true,variance=0.01," + tangentialConstraint + "}}"
+      ));
+    PoseSensor psA(m, "a");
+    PoseTrajectory traj(m, "traj");
+    m.addModulesAndInit(psA, traj);
+
+    MockCalibrator c(m, Interval{0.0, endTime});
+    for (auto& p : MmcsCircle.getPoses(endTime)) {
+      psA.addMeasurement(p.time, sm::kinematics::quatMultiply(p.q, yawOffset), p.p, c.getCurrentStorage());
+    }
+    c.initStates();
+
+    Result r;
+    traj.getCurrentTrajectory().visitSplines([&](const auto & rotationSpline, const auto & /* translationSpline */){
+      r.numSegments = rotationSpline.getAbsoluteNumberOfSegments();
+    });
+
+    ErrorTermCollector collector;
+    auto start = std::chrono::steady_clock::now();
+    traj.addTangentialConstraintErrorTerms(c, collector, false);
+    r.buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.numErrorTerms = collector.errorTerms.size();
+
+    start = std::chrono::steady_clock::now();
+    r.cost = 0;
+    for(auto & e : collector.errorTerms){
+      r.cost += e->evaluateError();
+      aslam::backend::JacobianContainer jc(e->dimension());
+      e->getWeightedJacobians(jc, false);
+    }
+    r.evaluationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    ::testing::Test::RecordProperty(name + "NumErrorTerms", std::to_string(r.numErrorTerms));
+    ::testing::Test::RecordProperty(name + "BuildMicroseconds", std::to_string(int(r.buildSeconds * 1e6)));
+    ::testing::Test::RecordProperty(name + "EvaluationMicroseconds", std::to_string(int(r.evaluationSeconds * 1e6)));
+    return r;
+  };
+
+  const Result sampled = run("sampled", "perSegment=false"), perSegment = run("perSegment", "perSegment=true,pointsPerSegment=2"), perSegmentDense = run("perSegmentDense", "perSegment=true,pointsPerSegment=5");
+  EXPECT_EQ(perSegment.numSegments, perSegment.numErrorTerms);
+  EXPECT_EQ(perSegmentDense.numSegments, perSegmentDense.numErrorTerms);
+  EXPECT_GT(sampled.numErrorTerms, perSegment.numErrorTerms * 3 / 2);
+  // The costs approximate the same integral. Every sample's weight is scaled to the actual sample density.
+  EXPECT_GT(sampled.cost, 1000.);
+  EXPECT_NEAR(sampled.cost, perSegment.cost, 0.01 * sampled.cost);
+  EXPECT_NEAR(sampled.cost, perSegmentDense.cost, 0.01 * sampled.cost);
 }
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <aslam/backend/EuclideanPoint.hpp>
+#include <aslam/backend/JacobianContainer.hpp>
+#include <sm/eigen/gtest.hpp>
+
+#include <aslam/calibration/tools/SplineSegmentBracket.h>
+
+using namespace aslam::calibration;
+
+namespace {
+/// Cox-de Boor recursion for the i-th basis function.
+double evalBasis(const std::vector<double> & knots, int i, int order, double t){
+  if(order == 1){
+    return knots[i] <= t && t < knots[i + 1] ? 1 : 0;
+  }
+  double v = 0;
+  if(knots[i + order - 1] > knots[i]) v += (t - knots[i]) / (knots[i + order - 1] - knots[i]) * evalBasis(knots, i, order - 1, t);
+  if(knots[i + order] > knots[i + 1]) v += (knots[i + order] - t) / (knots[i + order] - knots[i + 1]) * evalBasis(knots, i + 1, order - 1, t);
+  return v;
+}
+
+struct NonUniformSpline {
+  const int order = 4;
+  std::vector<sm::timing::NsecTime> knots;
+  std::vector<double> knotSeconds;
+  std::vector<aslam::backend::EuclideanPoint> points;
+  std::vector<aslam::backend::DesignVariable*> controlVertices;
+
+  NonUniformSpline() {
+    double t = 0;
+    for(int i = 0; i < 14; i++){
+      knots.push_back(sm::timing::secToNsec(t));
+      knotSeconds.push_back(t);
+      t += 0.1 + 0.05 * (i % 3);
+    }
+    for(size_t i = 0; i + order < knots.size(); i++){
+      points.emplace_back(Eigen::Vector3d(i, i * i, 1));
+    }
+    for(auto & p : points){
+      p.setActive(true);
+      controlVertices.push_back(&p);
+    }
+  }
+
+  int indexOf(const aslam::backend::DesignVariable * dv) const {
+    return std::find(controlVertices.begin(), controlVertices.end(), dv) - controlVertices.begin();
+  }
+};
+}
+
+TEST(SplineSegmentBracket, basisWeightsMatchCoxDeBoor) {
+  NonUniformSpline s;
+  const Timestamp lBound = Timestamp::Numerator(s.knots[5] + 1000), uBound = Timestamp::Numerator(s.knots[7] + 5000);
+  SplineSegmentBracket bracket(s.knots, s.order, s.controlVertices, lBound, uBound);
+  EXPECT_EQ(3, bracket.getNumSpans());
+  EXPECT_EQ(size_t(bracket.getNumSpans() + s.order - 1), bracket.getControlVertices().size());
+
+  for(const double x : {0.01, 0.3, 0.7, 1.0}){
+    const Timestamp t = Timestamp::Numerator(lBound.getNumerator() + sm::timing::NsecTime(x * (uBound - lBound).getNumerator()));
+    const int span = bracket.getSpan(t);
+    const Eigen::VectorXd weights = bracket.getBasisWeights(span, t, 0);
+    for(int r = 0; r < s.order; r++){
+      EXPECT_NEAR(evalBasis(s.knotSeconds, s.indexOf(bracket.getControlVertex(span, r)), s.order, sm::timing::nsecToSec(t.getNumerator())), weights[r], 1e-9) << x << ", " << r;
+    }
+    // The first derivative versus backward differences (the time gets clamped above uBound).
+    const Timestamp tBefore = Timestamp::Numerator(t.getNumerator() - 1000);
+    sm::eigen::assertNear(bracket.getBasisWeights(span, t, 1), (weights - bracket.getBasisWeights(span, tBefore, 0)) / 1e-6, 1e-4, SM_SOURCE_FILE_POS);
+  }
+}
+
+TEST(SplineSegmentBracket, expressionEvaluatesTheSpline) {
+  NonUniformSpline s;
+  const Timestamp lBound = Timestamp::Numerator(s.knots[5] + 1000), uBound = Timestamp::Numerator(s.knots[7] + 5000);
+  auto bracket = std::make_shared<const SplineSegmentBracket>(s.knots, s.order, s.controlVertices, lBound, uBound);
+
+  const Timestamp t = Timestamp::Numerator(s.knots[6] + 1000000);
+  const auto p = createEuclideanSplineExpression(bracket, aslam::backend::GenericScalarExpression<Timestamp>(t), 0);
+  Eigen::Vector3d expected = Eigen::Vector3d::Zero();
+  for(size_t i = 0; i < s.points.size(); i++){
+    expected += evalBasis(s.knotSeconds, i, s.order, sm::timing::nsecToSec(t.getNumerator())) * s.points[i].toEuclidean();
+  }
+  sm::eigen::assertNear(expected, p.evaluate(), 1e-9, SM_SOURCE_FILE_POS);
+
+  aslam::backend::JacobianContainer jc(3);
+  p.evaluateJacobians(jc);
+  int numControlVertices = 0;
+  for(auto it = jc.begin(); it != jc.end(); ++it){
+    const double weight = evalBasis(s.knotSeconds, s.indexOf(it->first), s.order, sm::timing::nsecToSec(t.getNumerator()));
+    sm::eigen::assertNear(weight * Eigen::Matrix3d::Identity(), Eigen::MatrixXd(it->second), 1e-9, SM_SOURCE_FILE_POS);
+    numControlVertices++;
+  }
+  EXPECT_EQ(s.order, numControlVertices);
+}
@@ -0,0 +1,79 @@
+#include <aslam/calibration/tools/ThreadPool.h>
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using aslam::calibration::TaskGroup;
+using aslam::calibration::ThreadPool;
+
+TEST(ThreadPool, testParallel) {
+  std::stringstream s;
+  std::mutex m;
+  std::condition_variable allStarted;
+
+  int N = 3;
+  int numStarted = 0;
+  ThreadPool p(N);
+  TaskGroup g;
+  for(int i = 0 ; i < N; i++)
+    p.run(g, [&](){
+      std::unique_lock<std::mutex> mlock(m);
+      s << "s";
+      numStarted++;
+      allStarted.notify_all();
+      // Only returns early if the tasks don't run concurrently.
+      allStarted.wait_for(mlock, std::chrono::seconds(10), [&](){ return numStarted == N; });
+      s << "e";
+    });
+
+  p.wait(g);
+
+  ASSERT_EQ(std::string(N, 's') + std::string(N, 'e'), s.str());
+  EXPECT_EQ(size_t(N), p.getStatistics().tasksExecuted);
+}
+
+TEST(ThreadPool, testParallelFor) {
+  for(size_t numThreads : {0, 1, 4}){
+    ThreadPool p(numThreads);
+    std::vector<int> v(10000, 0);
+    p.parallelFor(0, v.size(), [&](size_t i){ v[i] += i % 7; });
+    long expected = 0;
+    for(size_t i = 0; i < v.size(); i++){
+      expected += i % 7;
+    }
+    EXPECT_EQ(expected, std::accumulate(v.begin(), v.end(), 0l)) << "numThreads=" << numThreads;
+  }
+}
+
+TEST(ThreadPool, testNestedForkJoin) {
+  ThreadPool p(2);
+  std::atomic<int> count(0);
+  p.parallelFor(0, 8, [&](size_t){
+    p.parallelFor(0, 100, [&](size_t){ count++; }, 10);
+  }, 1);
+  EXPECT_EQ(800, count.load());
+  EXPECT_EQ(8u + 80u, p.getStatistics().tasksExecuted);
+  p.resetStatistics();
+  EXPECT_EQ(0u, p.getStatistics().tasksExecuted);
+}
+
+TEST(ThreadPool, testExceptionIsRethrown) {
+  for(size_t numThreads : {1, 3}){
+    ThreadPool p(numThreads);
+    std::atomic<int> count(0);
+    EXPECT_THROW(p.parallelFor(0, 10, [&](size_t i){
+      count++;
+      if(i == 5){
+        throw std::runtime_error("test");
+      }
+    }, 1), std::runtime_error);
+    EXPECT_EQ(10, count.load()); // the other tasks still run
+  }
+}
@@ -1,6 +1,7 @@
 #include <aslam/calibration/tools/Tree.h>
 
 #include <gtest/gtest.h>
+#include <set>
 #include <sstream>
 
 typedef aslam::calibration::Tree<std::string, std::string> IntTree;
@@ -105,3 +106,38 @@ TEST(Tree, walkPath) {
   EXPECT_EQ((PLS{ij, !aj}), payloads);
   payloads.clear();
 }
+
+TEST(Tree, getRootAndForEachNode) {
+  IntTree tree;
+  tree.add(i, j, ij);
+  tree.add(j, k, jk);
+  tree.add(a, j, aj);
+  tree.add(b, k, bk);
+  tree.init();
+
+  EXPECT_EQ(k, tree.getRoot());
+  std::set<std::string> nodes;
+  tree.forEachNode([&](const std::string & n){ EXPECT_TRUE(nodes.insert(n).second); });
+  EXPECT_EQ((std::set<std::string>{a, b, i, j, k}), nodes);
+}
+
+TEST(Tree, indexAndDepth) {
+  IntTree tree;
+  tree.add(i, j, ij);
+  tree.add(j, k, jk);
+  tree.add(a, j, aj);
+  tree.add(b, k, bk);
+  tree.init();
+
+  EXPECT_EQ(5u, tree.getNumNodes());
+  for(auto & n : {a, b, i, j, k}){
+    EXPECT_EQ(n, tree.getNode(tree.getIndex(n)));
+  }
+  EXPECT_EQ(0u, tree.getDepth(tree.getIndex(k)));
+  EXPECT_EQ(1u, tree.getDepth(tree.getIndex(j)));
+  EXPECT_EQ(2u, tree.getDepth(tree.getIndex(a)));
+  EXPECT_EQ(IntTree::NoIndex, tree.getParent(tree.getIndex(k)));
+  EXPECT_EQ(tree.getIndex(j), tree.getParent(tree.getIndex(i)));
+  EXPECT_EQ(ij, tree.getToParentPayload(tree.getIndex(i)));
+  EXPECT_EQ(tree.getIndex(k), tree.getClosestCommonAncestor(tree.getIndex(a), tree.getIndex(b)));
+}
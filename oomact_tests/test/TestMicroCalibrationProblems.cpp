@@ -1,9 +1,14 @@
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <random>
+#include <string>
 
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 
 #include <sm/boost/null_deleter.hpp>
+#include <sm/kinematics/quaternion_algebra.hpp>
 #include <eigen-checks/gtest.h>
 
 #include "aslam/calibration/calibrator/CalibratorI.h"
@@ -230,3 +235,95 @@ TEST(TestCalibration, testEstimateMotionCaptureSensorPose) {
 
   EXPECT_NEAR(0, mcSensorB.getTranslationToParent()[1], 0.0001);
 }
+
+struct SelectionResult {
+  double seconds;
+  Eigen::Vector3d translationB;
+  double yawB;
+  Eigen::MatrixXd translationCovarianceB;
+  size_t numMeasurementsB;
+  size_t numErrorTerms;
+};
+
+/// Calibrates sensor b as in testEstimateTwoPoseSensors, but with noisy measurements of b and the given measurement selection config for b.
+SelectionResult estimateTwoPoseSensorsWithSelection(const std::string & measurementSelection) {
+  const double sigma = 0.01;
+  auto vs = ValueStoreRef::fromString(
+      "Gravity{used=false}"
+      "frames=body:world,"
+      "a{frame=body,targetFrame=world,rotation/used=false,translation/used=false,delay/used=false}"
+      "b{frame=body,targetFrame=world,rotation{used=true,yaw=0.1,pitch=0.,roll=0.},translation{used=true,x=0,y=5,z=0},delay/used=false,"
+        "covPosition/sigma=" + std::to_string(sigma) + ",covOrientation/sigma=" + std::to_string(sigma) + "," + measurementSelection + "}"
+      "traj{frame=body,referenceFrame=world,McSensor=a,initWithPoseMeasurements=true,splines{knotsPerSecond=5,rotSplineOrder=4,rotFittingLambda=0.001,transSplineOrder=4,transFittingLambda=0.001}}"
+    );
+
+  FrameGraphModel m(vs);
+  PoseSensor mcSensorA(m, "a", vs);
+  PoseSensor mcSensorB(m, "b", vs);
+  PoseTrajectory traj(m, "traj", vs);
+  m.addModulesAndInit(mcSensorA, mcSensorB, traj);
+
+  auto vsCalib = ValueStoreRef::fromString(
+      "acceptConstantErrorTerms=true\n"
+      "timeBaseSensor=a\n"
+      "estimator/computeCovariances=true\n"
+    );
+  auto c = createBatchCalibrator(vsCalib, std::shared_ptr<Model>(&m, sm::null_deleter()));
+
+  SelectionResult r;
+  r.numMeasurementsB = 0;
+
+  // The same noise for every configuration.
+  std::mt19937 generator(0);
+  std::normal_distribution<double> noise(0, sigma);
+  auto randomVector = [&](){
+    return Eigen::Vector3d(noise(generator), noise(generator), noise(generator));
+  };
+  for (auto& p : MmcsRotatingStraightLine.getPoses(0, 1.0)) {
+    mcSensorA.addMeasurement(p.time, p.q, p.p, c->getCurrentStorage());
+    c->addMeasurementTimestamp(p.time, mcSensorA);
+    const Eigen::Vector4d q = sm::kinematics::quatMultiply(p.q, sm::kinematics::axisAngle2quat(randomVector()));
+    mcSensorB.addMeasurement(p.time, q, p.p + randomVector(), c->getCurrentStorage());
+    r.numMeasurementsB++;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  c->calibrate();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  r.seconds = elapsed.count();
+  r.translationB = mcSensorB.getTranslationToParent();
+  r.yawB = sm::kinematics::quat2AxisAngle(mcSensorB.getRotationQuaternionToParent())[2];
+  r.translationCovarianceB = c->getMarginalCovariance(mcSensorB.getTranslationVariable());
+  r.numErrorTerms = c->getNumErrorTerms();
+  return r;
+}
+
+TEST(TestCalibration, testEstimateTwoPoseSensorsWithMeasurementSelection) {
+  const SelectionResult all = estimateTwoPoseSensorsWithSelection("measurementSelection/used=false");
+  const SelectionResult selected = estimateTwoPoseSensorsWithSelection("measurementSelection{used=true,maxMeasurements=20,windowDuration=0.05}");
+
+  LOG(INFO) << "Calibration with all measurements took " << all.seconds << "s, with measurement selection " << selected.seconds << "s.";
+
+  // Both estimates must be consistent with their marginal covariances.
+  for (const SelectionResult * r : {&all, &selected}) {
+    ASSERT_EQ(3, r->translationCovarianceB.rows());
+    for (int i = 0; i < 3; i++) {
+      EXPECT_LT(std::abs(r->translationB[i]), 4 * std::sqrt(r->translationCovarianceB(i, i))) << i;
+    }
+    EXPECT_NEAR(0, r->yawB, 0.01);
+  }
+  // Every measurement of b gets one error term. Only b's error terms differ between the two runs.
+  ASSERT_EQ(all.numMeasurementsB, selected.numMeasurementsB);
+  ASSERT_GE(all.numErrorTerms, all.numMeasurementsB);
+  const size_t numKeptB = selected.numErrorTerms + all.numMeasurementsB - all.numErrorTerms;
+  // The segment coverage counts against the budget of 20 measurements. The budget turns into a number of windows of average size.
+  // The kept windows (0.05s at 100Hz, i.e. at most five measurements) may be larger than average, which the bound tolerates for one window.
+  EXPECT_LE(numKeptB, 20u + 5u);
+  EXPECT_GE(numKeptB, 5u);
+
+  // The variances must grow, but less than keeping every fifth measurement would let them.
+  const double varianceRatio = selected.translationCovarianceB.trace() / all.translationCovarianceB.trace();
+  EXPECT_GE(varianceRatio, 1.);
+  EXPECT_LT(varianceRatio, 5.);
+}